@@ -88,9 +88,19 @@ SOURCES += \
     $$PWD/src/voiebuttoir.cpp \
     $$PWD/src/voietraverseejonction.cpp \
     $$PWD/src/simview.cpp \
+    $$PWD/src/simengine.cpp \
+    $$PWD/src/filecommandes.cpp \
+    $$PWD/src/trace.cpp \
+    $$PWD/src/collision.cpp \
+    $$PWD/src/itineraires.cpp \
+    $$PWD/src/etatsaiguillages.cpp \
+    $$PWD/src/journalmessages.cpp \
+    $$PWD/src/journalevenements.cpp \
     $$PWD/src/commandetrain.cpp \
     $$PWD/src/loco.cpp \
     $$PWD/src/contact.cpp \
+    $$PWD/src/buscontacts.cpp \
+    $$PWD/src/statistiquescontacts.cpp \
     $$PWD/src/segment.cpp \
     $$PWD/src/trainsimsettings.cpp \
     $$PWD/src/maquettemanager.cpp \
@@ -109,11 +119,21 @@ HEADERS += \
     $$PWD/src/voiebuttoir.h \
     $$PWD/src/voietraverseejonction.h \
     $$PWD/src/simview.h \
+    $$PWD/src/simengine.h \
+    $$PWD/src/filecommandes.h \
+    $$PWD/src/trace.h \
+    $$PWD/src/collision.h \
+    $$PWD/src/itineraires.h \
+    $$PWD/src/etatsaiguillages.h \
+    $$PWD/src/journalmessages.h \
+    $$PWD/src/journalevenements.h \
     $$PWD/src/connect.h \
     $$PWD/src/commandetrain.h \
     $$PWD/src/general.h \
     $$PWD/src/loco.h \
     $$PWD/src/contact.h \
+    $$PWD/src/buscontacts.h \
+    $$PWD/src/statistiquescontacts.h \
     $$PWD/src/segment.h \
     $$PWD/src/trainsimsettings.h \
     $$PWD/src/maquettemanager.h \
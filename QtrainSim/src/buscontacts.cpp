@@ -0,0 +1,169 @@
+#include <QElapsedTimer>
+
+#include "buscontacts.h"
+#include "statistiquescontacts.h"
+#include "journalevenements.h"
+
+BusContacts::BusContacts()
+{
+    observateur = nullptr;
+    horloge.start();
+}
+
+BusContacts* BusContacts::getInstance()
+{
+    static BusContacts instance;
+    return &instance;
+}
+
+void BusContacts::signaler(int numContact, int numLoco)
+{
+    //l'instant d'activation est relevé avant le mutex : son attente fait partie de la latence.
+    qint64 instant = horloge.nsecsElapsed();
+
+    if(observateur != nullptr)
+        observateur->contactActive(numContact, numLoco);
+    JournalEvenements::getInstance()->enregistrer(JournalEvenements::CONTACT, numLoco, numContact);
+
+    QMutexLocker locker(&mutex);
+
+    EtatContact &etat = contacts[numContact];
+    etat.sequence++;
+    etat.derniereLoco = numLoco;
+    etat.sequenceParLoco[numLoco] = etat.sequence;
+
+    //seuls les threads dont le prédicat devient vrai sont réveillés.
+    foreach(Attente* a, attentes)
+    {
+        if(a->obtenue != 0)
+            continue;
+        for(int i = 0; i < a->numContacts.size(); i++)
+        {
+            if(a->numContacts.at(i) == numContact)
+            {
+                if(evaluer(*a))
+                {
+                    a->instantActivation = instant;
+                    a->condition.wakeOne();
+                }
+                break;
+            }
+        }
+    }
+}
+
+void BusContacts::setObservateur(ObservateurContacts *o)
+{
+    observateur = o;
+}
+
+quint64 BusContacts::getSequence(int numContact)
+{
+    QMutexLocker locker(&mutex);
+    return contacts.value(numContact).sequence;
+}
+
+int BusContacts::getDerniereLoco(int numContact)
+{
+    QMutexLocker locker(&mutex);
+    return contacts.value(numContact).derniereLoco;
+}
+
+quint64 BusContacts::attendre(int numContact, quint64 sequence, int numLoco)
+{
+    QMutexLocker locker(&mutex);
+
+    Attente a;
+    a.numContacts.append(numContact);
+    a.apres.append(sequence);
+    a.numLoco = numLoco;
+
+    bloquer(a, -1);
+
+    return a.obtenue;
+}
+
+bool BusContacts::attendrePlusieurs(const QVector<int> &numContacts, int timeoutMs, int *contactActive)
+{
+    //aucune activation ne pourrait satisfaire l'attente.
+    if(numContacts.isEmpty())
+        return false;
+
+    QMutexLocker locker(&mutex);
+
+    //les séquences de départ sont relevées sous le mutex : aucune activation ne peut échapper.
+    Attente a;
+    a.numLoco = TOUTES_LOCOS;
+    foreach(int numContact, numContacts)
+    {
+        a.numContacts.append(numContact);
+        a.apres.append(contacts.value(numContact).sequence);
+    }
+
+    bool satisfaite = bloquer(a, timeoutMs);
+
+    if(satisfaite && contactActive != nullptr)
+        *contactActive = a.contactObtenu;
+
+    return satisfaite;
+}
+
+bool BusContacts::bloquer(Attente &a, int timeoutMs)
+{
+    a.contactObtenu = 0;
+    a.obtenue = 0;
+
+    if(evaluer(a))
+    {
+        StatistiquesContacts::getInstance()->enregistrerImmediate(a.contactObtenu);
+        return true;
+    }
+
+    if(timeoutMs == 0)
+        return false;
+
+    QElapsedTimer chrono;
+    chrono.start();
+
+    attentes.append(&a);
+    while(a.obtenue == 0)
+    {
+        if(timeoutMs < 0)
+        {
+            a.condition.wait(&mutex);
+        }
+        else
+        {
+            qint64 restant = timeoutMs - chrono.elapsed();
+            if(restant <= 0)
+                break;
+            a.condition.wait(&mutex, (unsigned long) restant);
+        }
+    }
+    attentes.removeOne(&a);
+
+    if(a.obtenue == 0)
+        return false;
+
+    StatistiquesContacts::getInstance()->enregistrerLatence(a.contactObtenu, horloge.nsecsElapsed() - a.instantActivation);
+    return true;
+}
+
+bool BusContacts::evaluer(Attente &a) const
+{
+    for(int i = 0; i < a.numContacts.size(); i++)
+    {
+        QHash<int, EtatContact>::const_iterator it = contacts.constFind(a.numContacts.at(i));
+        if(it == contacts.constEnd())
+            continue;
+
+        quint64 derniere = (a.numLoco == TOUTES_LOCOS) ? it->sequence : it->sequenceParLoco.value(a.numLoco, 0);
+        if(derniere > a.apres.at(i))
+        {
+            a.contactObtenu = a.numContacts.at(i);
+            a.obtenue = derniere;
+            return true;
+        }
+    }
+    return false;
+}
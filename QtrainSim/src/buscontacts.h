@@ -0,0 +1,139 @@
+#ifndef BUSCONTACTS_H
+#define BUSCONTACTS_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QElapsedTimer>
+
+/**
+  Observateur des activations de contacts, appelé par le bus dans le thread
+  ayant provoqué l'activation, avant le réveil des threads en attente.
+  */
+class ObservateurContacts
+{
+public:
+    virtual ~ObservateurContacts() {}
+
+    /** reçoit l'activation d'un contact.
+      * \param numContact le numéro du contact activé.
+      * \param numLoco le numéro de la loco ayant activé le contact.
+      */
+    virtual void contactActive(int numContact, int numLoco) = 0;
+};
+
+/**
+  Bus d'événements des contacts.
+  Chaque activation d'un contact reçoit un numéro de séquence strictement croissant
+  (propre au contact) et mémorise la loco qui l'a provoquée. Les threads en attente
+  décrivent l'activation attendue par un prédicat (séquence minimale, loco éventuelle) :
+  une activation survenue avant l'appel n'est ainsi jamais perdue, et un réveil
+  intempestif n'est jamais pris pour une activation.
+  */
+class BusContacts
+{
+public:
+    //! valeur indiquant qu'une activation par n'importe quelle loco convient.
+    static const int TOUTES_LOCOS = -1;
+
+    /** retourne l'unique instance du bus.
+      * \return l'instance du bus.
+      */
+    static BusContacts* getInstance();
+
+    /** signale l'activation d'un contact et réveille les threads dont le prédicat est satisfait.
+      * \param numContact le numéro du contact activé.
+      * \param numLoco le numéro de la loco ayant activé le contact.
+      */
+    void signaler(int numContact, int numLoco);
+
+    /** retourne le numéro de séquence de la dernière activation d'un contact.
+      * \param numContact le numéro du contact.
+      * \return le numéro de séquence, 0 si le contact n'a jamais été activé.
+      */
+    quint64 getSequence(int numContact);
+
+    /** retourne le numéro de la dernière loco ayant activé un contact.
+      * \param numContact le numéro du contact.
+      * \return le numéro de la loco, TOUTES_LOCOS si le contact n'a jamais été activé.
+      */
+    int getDerniereLoco(int numContact);
+
+    /** Méthode bloquante, attendant une activation du contact postérieure à une séquence donnée.
+      * Retourne immédiatement si une telle activation a déjà eu lieu.
+      * \param numContact le numéro du contact.
+      * \param sequence la séquence à dépasser.
+      * \param numLoco la loco dont on attend le passage, TOUTES_LOCOS pour n'importe laquelle.
+      * \return le numéro de séquence de l'activation obtenue.
+      */
+    quint64 attendre(int numContact, quint64 sequence, int numLoco = TOUTES_LOCOS);
+
+    /** Méthode bloquante, attendant la prochaine activation de l'un des contacts spécifiés.
+      * Une seule structure d'attente est utilisée, quel que soit le nombre de contacts.
+      * \param numContacts les numéros des contacts surveillés.
+      * \param timeoutMs le délai maximal d'attente en millisecondes, négatif pour une attente illimitée.
+      * \param contactActive reçoit le numéro du contact activé, s'il n'est pas nul.
+      * \return vrai si un contact a été activé, faux si le délai a expiré ou si la liste est vide.
+      */
+    bool attendrePlusieurs(const QVector<int> &numContacts, int timeoutMs, int *contactActive = nullptr);
+
+    /** installe l'observateur des activations (enregistrement ou rejeu d'une trace).
+      * Doit être appelé avant le démarrage de la simulation.
+      * \param o l'observateur, nullptr pour n'en installer aucun.
+      */
+    void setObservateur(ObservateurContacts* o);
+
+private:
+    BusContacts();
+
+    struct EtatContact
+    {
+        EtatContact() : sequence(0), derniereLoco(TOUTES_LOCOS) {}
+        quint64 sequence;
+        int derniereLoco;
+        //! séquence de la dernière activation du contact par chaque loco.
+        QHash<int, quint64> sequenceParLoco;
+    };
+
+    struct Attente
+    {
+        //! les contacts surveillés, et pour chacun la séquence à dépasser.
+        QVarLengthArray<int, 8> numContacts;
+        QVarLengthArray<quint64, 8> apres;
+        int numLoco;
+        int contactObtenu;
+        quint64 obtenue;
+        //! instant de l'activation ayant satisfait l'attente, selon l'horloge du bus.
+        qint64 instantActivation;
+        QWaitCondition condition;
+    };
+
+    /** évalue le prédicat d'une attente et renseigne l'activation obtenue le cas échéant.
+      * Le mutex doit être verrouillé.
+      * \param a l'attente à évaluer.
+      * \return vrai si l'attente est satisfaite.
+      */
+    bool evaluer(Attente &a) const;
+
+    /** bloque jusqu'à ce que l'attente soit satisfaite ou que le délai expire.
+      * La latence de réveil est transmise aux statistiques des contacts.
+      * Le mutex doit être verrouillé.
+      * \param a l'attente.
+      * \param timeoutMs le délai maximal en millisecondes, négatif pour une attente illimitée.
+      * \return vrai si l'attente est satisfaite.
+      */
+    bool bloquer(Attente &a, int timeoutMs);
+
+    //! horloge monotone servant à mesurer les latences de réveil.
+    QElapsedTimer horloge;
+
+    ObservateurContacts* observateur;
+    QMutex mutex;
+    QHash<int, EtatContact> contacts;
+    QList<Attente*> attentes;
+};
+
+#endif // BUSCONTACTS_H
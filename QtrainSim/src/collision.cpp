@@ -0,0 +1,134 @@
+#include <math.h>
+
+#include "collision.h"
+
+/** Projette le rectangle r sur l'axe (ax, ay) et retourne le demi-intervalle obtenu,
+  * centré sur la projection du centre.
+  */
+static qreal demiProjection(const RectangleOriente &r, qreal ax, qreal ay)
+{
+    qreal pu = r.ux * ax + r.uy * ay;
+    qreal pv = -r.uy * ax + r.ux * ay;
+    return r.demiLongueur * fabs(pu) + r.demiLargeur * fabs(pv);
+}
+
+/** indique si l'axe (ax, ay) sépare les deux rectangles.
+  */
+static bool axeSeparateur(const RectangleOriente &a, const RectangleOriente &b, qreal ax, qreal ay)
+{
+    qreal distance = fabs((b.centre.x() - a.centre.x()) * ax + (b.centre.y() - a.centre.y()) * ay);
+    return distance >= demiProjection(a, ax, ay) + demiProjection(b, ax, ay);
+}
+
+bool rectanglesSeChevauchent(const RectangleOriente &a, const RectangleOriente &b)
+{
+    //test rapide des cercles englobants.
+    qreal dx = b.centre.x() - a.centre.x();
+    qreal dy = b.centre.y() - a.centre.y();
+    qreal rayonA = sqrt(a.demiLongueur * a.demiLongueur + a.demiLargeur * a.demiLargeur);
+    qreal rayonB = sqrt(b.demiLongueur * b.demiLongueur + b.demiLargeur * b.demiLargeur);
+    if(dx * dx + dy * dy >= (rayonA + rayonB) * (rayonA + rayonB))
+        return false;
+
+    //deux rectangles : seuls leurs 4 axes propres sont à tester.
+    if(axeSeparateur(a, b, a.ux, a.uy))
+        return false;
+    if(axeSeparateur(a, b, -a.uy, a.ux))
+        return false;
+    if(axeSeparateur(a, b, b.ux, b.uy))
+        return false;
+    if(axeSeparateur(a, b, -b.uy, b.ux))
+        return false;
+
+    return true;
+}
+
+GrilleCollision::GrilleCollision(qreal tailleCellule)
+{
+    this->tailleCellule = tailleCellule;
+}
+
+quint64 GrilleCollision::cle(qint32 i, qint32 j)
+{
+    return (quint64(quint32(i)) << 32) | quint64(quint32(j));
+}
+
+void GrilleCollision::vider()
+{
+    //on conserve les cellules allouées, qui seront probablement réutilisées au pas suivant.
+    QMutableHashIterator<quint64, QVector<int> > it(cellules);
+    while(it.hasNext())
+    {
+        it.next();
+        if(it.value().isEmpty())
+            it.remove();
+        else
+            it.value().clear();
+    }
+}
+
+void GrilleCollision::inserer(int indice, const QPointF &centre)
+{
+    qint32 i = qint32(floor(centre.x() / tailleCellule));
+    qint32 j = qint32(floor(centre.y() / tailleCellule));
+    cellules[cle(i, j)].append(indice);
+}
+
+void GrilleCollision::pairesCandidates(QVector<QPair<int, int> > &paires) const
+{
+    //demi-voisinage : chaque paire de cellules voisines n'est visitée qu'une fois.
+    static const int voisins[4][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}};
+
+    paires.clear();
+
+    QHashIterator<quint64, QVector<int> > it(cellules);
+    while(it.hasNext())
+    {
+        it.next();
+        const QVector<int> &cellule = it.value();
+        if(cellule.isEmpty())
+            continue;
+
+        qint32 i = qint32(quint32(it.key() >> 32));
+        qint32 j = qint32(quint32(it.key() & 0xFFFFFFFF));
+
+        for(int a = 0; a < cellule.size(); a++)
+            for(int b = a + 1; b < cellule.size(); b++)
+                paires.append(qMakePair(cellule.at(a), cellule.at(b)));
+
+        for(int n = 0; n < 4; n++)
+        {
+            QHash<quint64, QVector<int> >::const_iterator voisine = cellules.constFind(cle(i + voisins[n][0], j + voisins[n][1]));
+            if(voisine == cellules.constEnd())
+                continue;
+
+            foreach(int a, cellule)
+                foreach(int b, voisine.value())
+                    paires.append(qMakePair(a, b));
+        }
+    }
+}
+
+void detecterChevauchements(GrilleCollision &grille, const QVector<RectangleOriente> &rectangles,
+                            const QVector<bool> &presents, QVector<QPair<int, int> > &paires)
+{
+    //première passe : seuls les rectangles rangés dans des cellules voisines de la
+    //grille sont comparés entre eux.
+    grille.vider();
+    for(int i = 0; i < rectangles.size(); i++)
+    {
+        if(presents.isEmpty() || presents.at(i))
+            grille.inserer(i, rectangles.at(i).centre);
+    }
+
+    grille.pairesCandidates(paires);
+
+    //seconde passe : test exact ; les paires retenues sont tassées en tête du tableau.
+    int retenues = 0;
+    for(int p = 0; p < paires.size(); p++)
+    {
+        if(rectanglesSeChevauchent(rectangles.at(paires.at(p).first), rectangles.at(paires.at(p).second)))
+            paires[retenues++] = paires.at(p);
+    }
+    paires.resize(retenues);
+}
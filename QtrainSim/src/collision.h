@@ -0,0 +1,84 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <QPointF>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+
+#include "general.h"
+
+//! rayon du cercle englobant une loco, centré sur sa position.
+#define RAYON_ENGLOBANT_LOCO 61.85
+
+/**
+  Rectangle orienté décrivant l'emprise d'une loco sur la maquette.
+  L'axe (ux, uy) est l'axe longitudinal de la loco, l'axe transversal lui est perpendiculaire.
+  */
+struct RectangleOriente
+{
+    QPointF centre;
+    qreal ux;
+    qreal uy;
+    qreal demiLongueur;
+    qreal demiLargeur;
+};
+
+/** Teste le chevauchement de deux rectangles orientés (théorème de l'axe séparateur).
+  * Un simple contact entre deux bords n'est pas considéré comme un chevauchement.
+  * \param a le premier rectangle
+  * \param b le second rectangle
+  * \return vrai si les deux rectangles se chevauchent.
+  */
+bool rectanglesSeChevauchent(const RectangleOriente &a, const RectangleOriente &b);
+
+/**
+  Grille uniforme servant de première passe à la détection des collisions.
+  Chaque élément est rangé dans la cellule contenant son centre. La taille des
+  cellules étant au moins le double du rayon englobant, deux éléments qui se
+  touchent sont forcément dans la même cellule ou dans des cellules voisines.
+  */
+class GrilleCollision
+{
+public:
+    /** Constructeur de classe
+      * \param tailleCellule la taille d'une cellule, au moins deux fois le rayon englobant des éléments.
+      */
+    explicit GrilleCollision(qreal tailleCellule = 2.0 * RAYON_ENGLOBANT_LOCO);
+
+    /** vide la grille, en vue d'un nouveau remplissage.
+      */
+    void vider();
+
+    /** range un élément dans la grille.
+      * \param indice l'indice de l'élément.
+      * \param centre la position du centre de l'élément.
+      */
+    void inserer(int indice, const QPointF &centre);
+
+    /** retourne les paires d'éléments suffisamment proches pour pouvoir se toucher.
+      * Chaque paire n'apparait qu'une fois.
+      * \param paires le tableau à remplir (vidé au préalable).
+      */
+    void pairesCandidates(QVector<QPair<int, int> > &paires) const;
+
+private:
+    qreal tailleCellule;
+    QHash<quint64, QVector<int> > cellules;
+
+    /** retourne la clé de la cellule de coordonnées (i, j).
+      */
+    static quint64 cle(qint32 i, qint32 j);
+};
+
+/** Détecte les paires de rectangles qui se chevauchent : première passe par la grille,
+  * puis test exact (rectanglesSeChevauchent) des seules paires candidates.
+  * \param grille la grille de première passe, vidée puis remplie avec les rectangles présents.
+  * \param rectangles les rectangles, désignés par leur indice.
+  * \param presents indique pour chaque rectangle s'il participe à la détection ; vide, tous y participent.
+  * \param paires le tableau à remplir avec les paires qui se chevauchent (vidé au préalable).
+  */
+void detecterChevauchements(GrilleCollision &grille, const QVector<RectangleOriente> &rectangles,
+                            const QVector<bool> &presents, QVector<QPair<int, int> > &paires);
+
+#endif // COLLISION_H
@@ -2,14 +2,21 @@
 #include <iostream>
 #include <QApplication>
 #include <QThread>
+#include <QTimer>
 
 #include "commandetrain.h"
 #include "mainwindow.h"
+#include "simengine.h"
+#include "buscontacts.h"
+#include "statistiquescontacts.h"
+#include "journalmessages.h"
+#include "journalevenements.h"
+#include "trainsimsettings.h"
 
 
 
-static MainWindow *mainwindow;
-static SimView* simView;
+static MainWindow *mainwindow = nullptr;
+static SimEngine* simEngine;
 
 
 
@@ -36,21 +43,60 @@ CommandeTrain* CommandeTrain::getInstance()
 
 void CommandeTrain::init_maquette(void)
 {
-    mainwindow=new MainWindow();
-    mainwindow->show();
+    TrainSimSettings* settings = TrainSimSettings::getInstance();
 
-    simView = mainwindow->getSimView();
+    simEngine = new SimEngine(this);
+    simEngine->setLimiteTempsReel(!settings->getSansRendu() || settings->getTempsReel());
+    simEngine->setPasMaximum(settings->getDureeSimulation() * 1000.0 / PAS_SIMULATION);
 
-    CONNECT(this, SIGNAL(setLoco(int,int,int,int)), simView, SLOT(setLoco(int,int,int,int)));
-    CONNECT(this, SIGNAL(askLoco(int,int)), simView, SLOT(askLoco(int,int)));
-    CONNECT(this, SIGNAL(setVitesseLoco(int,int)), simView, SLOT(setVitesseLoco(int,int)));
-    CONNECT(this, SIGNAL(reverseLoco(int)), simView, SLOT(reverseLoco(int)));
-    CONNECT(this, SIGNAL(setVitesseProgressiveLoco(int,int)), simView, SLOT(setVitesseProgressiveLoco(int,int)));
-    CONNECT(this, SIGNAL(setVoieVariable(int,int)), simView, SLOT(setVoieVariable(int,int)));
-    CONNECT(this, SIGNAL(addLoco(int)),mainwindow,SLOT(addLoco(int)));
-    CONNECT(this, SIGNAL(selectMaquette(QString)),mainwindow,SLOT(selectionMaquette(QString)));
-    CONNECT(this, SIGNAL(afficheMessage(QString)),mainwindow,SLOT(afficherMessage(QString)));
-    CONNECT(this, SIGNAL(afficheMessageLoco(int,QString)),mainwindow,SLOT(afficherMessageLoco(int,QString)));
+    if (!settings->getFichierEnregistrement().isEmpty() && !simEngine->enregistrerTrace(settings->getFichierEnregistrement()))
+        std::cerr << "Impossible de créer la trace " << settings->getFichierEnregistrement().toStdString() << std::endl;
+
+    if (!settings->getFichierEvenements().isEmpty() && !JournalEvenements::getInstance()->ouvrir(settings->getFichierEvenements()))
+        std::cerr << "Impossible d'ouvrir le journal des événements " << settings->getFichierEvenements().toStdString() << std::endl;
+
+    if (!settings->getFichierRejeu().isEmpty())
+    {
+        QString erreur;
+        if (!simEngine->rejouerTrace(settings->getFichierRejeu(), erreur))
+        {
+            std::cerr << erreur.toStdString() << std::endl;
+            exit(1);
+        }
+    }
+
+    CONNECT(this, SIGNAL(selectMaquette(QString)), simEngine, SLOT(selectionMaquette(QString)));
+
+    if (settings->getSansRendu())
+    {
+        //pas de fenêtre : les messages vont sur la sortie standard, et la fin de
+        //la simulation (durée écoulée ou collision) termine l'application.
+        CONNECT(simEngine, SIGNAL(erreur(QString)), this, SLOT(ecrireMessage(QString)));
+        CONNECT(simEngine, SIGNAL(collision(Loco*,Loco*)), this, SLOT(collisionSansRendu(Loco*,Loco*)));
+        if (simEngine->estEnRejeu())
+            CONNECT(simEngine, SIGNAL(simulationTerminee()), this, SLOT(finRejeu()));
+        else
+            CONNECT(simEngine, SIGNAL(simulationTerminee()), qApp, SLOT(quit()));
+        //le chargement de la maquette par le client arrête la simulation : personne ne
+        //pouvant la relancer, elle redémarre dès que la maquette est construite.
+        CONNECT(simEngine, SIGNAL(maquetteConstruite()), simEngine, SLOT(demarrer()));
+        simEngine->demarrer();
+    }
+    else
+    {
+        mainwindow=new MainWindow(simEngine);
+        mainwindow->show();
+    }
+
+    //les messages des clients sont affichés par lots, une fois par trame.
+    QTimer* timerJournal = new QTimer(this);
+    CONNECT(timerJournal, SIGNAL(timeout()), this, SLOT(viderJournal()));
+    timerJournal->start(1000 / FRAME_RATE);
+    CONNECT(qApp, SIGNAL(aboutToQuit()), this, SLOT(viderJournal()));
+
+    CONNECT(qApp, SIGNAL(aboutToQuit()), this, SLOT(ecrireStatistiques()));
+    CONNECT(qApp, SIGNAL(aboutToQuit()), simEngine, SLOT(terminerTrace()));
+    CONNECT(qApp, SIGNAL(aboutToQuit()), this, SLOT(terminerJournalEvenements()));
 
     QTimer::singleShot(10, this, SLOT(timerTrigger()));
 }
@@ -119,17 +165,28 @@ void CommandeTrain::mettre_maquette_en_service(void)
 
 void CommandeTrain::ajouter_loco(int no_loco)
 {
-    emit addLoco(no_loco);
+    Commande c = {Commande::AJOUTER_LOCO, no_loco, 0, 0, 0};
+    simEngine->deposerCommande(c);
 }
 
 void CommandeTrain::diriger_aiguillage(int no_aiguillage, int direction, int /*temps_alim*/)
 {
-    emit setVoieVariable(no_aiguillage, direction);
+    Commande c = {Commande::VOIE_VARIABLE, no_aiguillage, direction, 0, 0};
+    simEngine->deposerCommande(c);
+}
+
+int CommandeTrain::etat_aiguillage(int no_aiguillage, unsigned long long *version)
+{
+    quint64 v;
+    int etat = simEngine->getEtatVoieVariable(no_aiguillage, &v);
+    if (version != nullptr)
+        *version = v;
+    return etat;
 }
 
 void CommandeTrain::attendre_contact(int no_contact)
 {
-    Contact *c=simView->getContact(no_contact);
+    Contact *c=simEngine->getContact(no_contact);
     if (c == nullptr)
     {
         QMessageBox::warning(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(no_contact));
@@ -138,14 +195,112 @@ void CommandeTrain::attendre_contact(int no_contact)
         c->attendContact();
 }
 
+unsigned long long CommandeTrain::sequence_contact(int no_contact)
+{
+    return BusContacts::getInstance()->getSequence(no_contact);
+}
+
+unsigned long long CommandeTrain::attendre_contact_apres(int no_contact, unsigned long long sequence)
+{
+    Contact *c=simEngine->getContact(no_contact);
+    if (c == nullptr)
+    {
+        QMessageBox::warning(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(no_contact));
+        return sequence;
+    }
+    return c->attendActivation(sequence);
+}
+
+unsigned long long CommandeTrain::attendre_contact_loco(int no_contact, int no_loco, unsigned long long sequence)
+{
+    Contact *c=simEngine->getContact(no_contact);
+    if (c == nullptr)
+    {
+        QMessageBox::warning(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(no_contact));
+        return sequence;
+    }
+    return c->attendActivation(sequence, no_loco);
+}
+
+int CommandeTrain::attendre_contacts(const int *liste, int n, int timeout_ms, int *which)
+{
+    //sans contact à surveiller, l'attente ne pourrait jamais être satisfaite.
+    if (liste == nullptr || n <= 0)
+        return 0;
+
+    QVector<int> numContacts;
+    for (int i = 0; i < n; i++)
+    {
+        if (simEngine->getContact(liste[i]) == nullptr)
+        {
+            QMessageBox::warning(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(liste[i]));
+            return 0;
+        }
+        numContacts.append(liste[i]);
+    }
+    return BusContacts::getInstance()->attendrePlusieurs(numContacts, timeout_ms, which) ? 1 : 0;
+}
+
+int CommandeTrain::voies_segment(int contact_a, int contact_b, int *voies, int taille)
+{
+    QVector<int> idVoies = simEngine->getVoiesSegment(contact_a, contact_b);
+    if (idVoies.isEmpty())
+        return -1;
+
+    for (int i = 0; i < idVoies.size() && i < taille; i++)
+        voies[i] = idVoies.at(i);
+    return idVoies.size();
+}
+
+int CommandeTrain::calculer_itineraire(const int *etapes, int n)
+{
+    QVector<int> listeEtapes;
+    for (int i = 0; i < n; i++)
+        listeEtapes.append(etapes[i]);
+
+    QString erreur;
+    int numero = simEngine->calculerItineraire(listeEtapes, erreur);
+    if (numero < 0)
+        JournalMessages::getInstance()->ajouter(JournalMessages::SOURCE_GENERALE, QString("Itinéraire impossible : %1").arg(erreur));
+    return numero;
+}
+
+int CommandeTrain::contacts_itineraire(int itineraire, int *contacts, int taille)
+{
+    Itineraire it;
+    if (!simEngine->getItineraire(itineraire, it))
+        return -1;
+
+    for (int i = 0; i < it.contacts.size() && i < taille; i++)
+        contacts[i] = it.contacts.at(i);
+    return it.contacts.size();
+}
+
+int CommandeTrain::aiguillages_itineraire(int itineraire, int indice, int *aiguillages, int *directions, int taille)
+{
+    Itineraire it;
+    if (!simEngine->getItineraire(itineraire, it) || indice < 0 || indice >= it.aiguillages.size())
+        return -1;
+
+    const QVector<QPair<int, int> > &reglages = it.aiguillages.at(indice);
+    for (int i = 0; i < reglages.size() && i < taille; i++)
+    {
+        aiguillages[i] = reglages.at(i).first;
+        directions[i] = reglages.at(i).second;
+    }
+    return reglages.size();
+}
+
 void CommandeTrain::arreter_loco(int no_loco)
 {
-    emit setVitesseLoco(no_loco, 0);
+    Commande c = {Commande::VITESSE_LOCO, no_loco, 0, 0, 0};
+    simEngine->deposerCommande(c);
 }
 
 void CommandeTrain::mettre_vitesse_progressive(int no_loco, int vitesse_future)
 {
-    emit setVitesseProgressiveLoco(no_loco, vitesse_future);
+    Commande c = {Commande::VITESSE_PROGRESSIVE_LOCO, no_loco, vitesse_future, 0, 0};
+    simEngine->deposerCommande(c);
 }
 
 void CommandeTrain::mettre_fonction_loco(int /*no_loco*/, char /*etat*/)
@@ -155,12 +310,14 @@ void CommandeTrain::mettre_fonction_loco(int /*no_loco*/, char /*etat*/)
 
 void CommandeTrain::inverser_sens_loco(int no_loco)
 {
-    emit reverseLoco(no_loco);
+    Commande c = {Commande::INVERSER_LOCO, no_loco, 0, 0, 0};
+    simEngine->deposerCommande(c);
 }
 
 void CommandeTrain::mettre_vitesse_loco(int no_loco, int vitesse)
 {
-    emit setVitesseLoco(no_loco, vitesse);
+    Commande c = {Commande::VITESSE_LOCO, no_loco, vitesse, 0, 0};
+    simEngine->deposerCommande(c);
 }
 
 void CommandeTrain::demander_loco(int contact_a, int contact_b, int */*no_loco*/, int */*vitesse*/)
@@ -170,32 +327,43 @@ void CommandeTrain::demander_loco(int contact_a, int contact_b, int */*no_loco*/
 
 void CommandeTrain::assigner_loco(int contact_a,int contact_b,int no_loco,int vitesse)
 {
-    emit addLoco(no_loco);
-    emit setLoco(contact_a, contact_b, no_loco, vitesse);
+    Commande ajout = {Commande::AJOUTER_LOCO, no_loco, 0, 0, 0};
+    Commande placement = {Commande::PLACER_LOCO, no_loco, vitesse, contact_a, contact_b};
+    simEngine->deposerCommande(ajout);
+    simEngine->deposerCommande(placement);
 }
 
 void CommandeTrain::selection_maquette(QString maquette)
 {
     emit selectMaquette(maquette);
-    mainwindow->semWaitMaquette.acquire();
-    mainwindow->maquetteFinie.acquire();
+    simEngine->maquetteChargee.acquire();
 }
 
 void CommandeTrain::afficher_message(const char *message)
 {
-    QString mess=QString("%1").arg(message);
-    emit afficheMessage(mess);
+    JournalMessages::getInstance()->ajouter(JournalMessages::SOURCE_GENERALE, QString(message));
 }
 
 
 void CommandeTrain::afficher_message_loco(int numLoco,const char *message)
 {
-    QString mess=QString("%1").arg(message);
-    emit afficheMessageLoco(numLoco,mess);
+    JournalMessages::getInstance()->ajouter(numLoco, QString(message));
+}
+
+void CommandeTrain::afficher_statistiques_contacts()
+{
+    JournalMessages::getInstance()->ajouter(JournalMessages::SOURCE_GENERALE, StatistiquesContacts::getInstance()->texte());
 }
 
 void CommandeTrain::commandSent(QString command)
 {
+    //commandes propres au simulateur, non transmises au programme client.
+    if(command.trimmed() == COMMANDE_STATISTIQUES)
+    {
+        afficher_statistiques_contacts();
+        return;
+    }
+
     this->command = command;
     VarCond->wakeAll();
 }
@@ -211,3 +379,74 @@ QString CommandeTrain::getCommand()
     mutex->unlock();
     return tmp;
 }
+
+void CommandeTrain::ecrireMessage(QString message)
+{
+    std::cout << message.toStdString() << std::endl;
+}
+
+void CommandeTrain::journaliser_section(int numLoco, int numSection, int evenement, int entree)
+{
+    static const JournalEvenements::Type types[] = {JournalEvenements::SECTION_DEMANDE,
+                                                    JournalEvenements::SECTION_ATTENTE,
+                                                    JournalEvenements::SECTION_ACCES,
+                                                    JournalEvenements::SECTION_SORTIE};
+    if (evenement < SECTION_DEMANDE || evenement > SECTION_SORTIE)
+        return;
+    JournalEvenements::getInstance()->enregistrer(types[evenement], numLoco, numSection, entree);
+}
+
+void CommandeTrain::terminerJournalEvenements()
+{
+    JournalEvenements::getInstance()->fermer();
+}
+
+void CommandeTrain::viderJournal()
+{
+    QVector<LigneJournal> lignes;
+    JournalMessages::getInstance()->extraire(lignes);
+    if (lignes.isEmpty())
+        return;
+
+    if (mainwindow != nullptr)
+    {
+        mainwindow->afficherJournal(lignes);
+        return;
+    }
+
+    //sans affichage, le lot est écrit d'un bloc sur la sortie standard.
+    QString texte;
+    foreach (const LigneJournal &l, lignes)
+    {
+        if (l.source != JournalMessages::SOURCE_GENERALE)
+            texte += QString("Loco %1 : ").arg(l.source);
+        texte += l.texte;
+        texte += '\n';
+    }
+    std::cout << texte.toStdString() << std::flush;
+}
+
+void CommandeTrain::ecrireStatistiques()
+{
+    if(!StatistiquesContacts::getInstance()->ecrireFichier(FICHIER_STATISTIQUES))
+        std::cerr << "Impossible d'écrire le fichier " << FICHIER_STATISTIQUES << std::endl;
+}
+
+void CommandeTrain::collisionSansRendu(Loco *l1, Loco *l2)
+{
+    std::cout << "Collision entre les locos " << l1->getNumLoco() << " et " << l2->getNumLoco()
+              << " au pas " << simEngine->getNumeroPas() << std::endl;
+    if (simEngine->estEnRejeu())
+    {
+        bool conforme;
+        std::cout << simEngine->rapportRejeu(conforme).toStdString() << std::endl;
+    }
+    qApp->exit(1);
+}
+
+void CommandeTrain::finRejeu()
+{
+    bool conforme;
+    std::cout << simEngine->rapportRejeu(conforme).toStdString() << std::endl;
+    qApp->exit(conforme ? 0 : 2);
+}
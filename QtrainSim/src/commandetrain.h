@@ -8,6 +8,8 @@
 
 #include "general.h"
 
+class Loco;
+
 /**
   Toutes les methodes de cette classe doivent être reentrantes!!!!!!!
   */
@@ -69,10 +71,21 @@ public:
      * \param no_aiguillage  No de l'aiguillage a diriger.
      * \param direction      Nouvelle direction. (DEVIE ou TOUT_DROIT)
      * \param temps_alim     Temps l'alimentation minimal du bobinage de l'aiguillage.
-     * Remarque : temps_alim n'a pas d'effet dans le simulateur.
+     * Remarque : temps_alim n'a pas d'effet dans le simulateur. La commande est toujours
+     * transmise au moteur, qui ne l'exécute pas si l'aiguillage est déjà dans la direction
+     * demandée au moment où il l'applique.
      */
     void diriger_aiguillage(int no_aiguillage, int direction, int);
 
+    /**
+     * Retourne la direction d'un aiguillage, fixée par la dernière commande exécutée par le
+     * moteur. Une commande transmise mais pas encore appliquée n'y figure pas.
+     * \param no_aiguillage  No de l'aiguillage.
+     * \param version        Reçoit, s'il n'est pas nul, le nombre de changements de direction.
+     * \return la direction, DIRECTION_INCONNUE si aucune commande de l'aiguillage n'a été exécutée.
+     */
+    int etat_aiguillage(int no_aiguillage, unsigned long long *version);
+
     /**
      * Méthode bloquante, permettant d'attendre l'activation du contact voulu.
      * Remarque : le contact peut être activé par n'importe quelle locomotive.
@@ -80,6 +93,81 @@ public:
      */
     void attendre_contact(int no_contact);
 
+    /**
+     * Retourne le numéro de séquence de la dernière activation d'un contact.
+     * \param no_contact  Numéro du contact.
+     * \return le numéro de séquence, 0 si le contact n'a jamais été activé.
+     */
+    unsigned long long sequence_contact(int no_contact);
+
+    /**
+     * Méthode bloquante, permettant d'attendre une activation du contact voulu
+     * postérieure à une séquence donnée. Retourne immédiatement si elle a déjà eu lieu.
+     * \param no_contact  Numéro du contact dont on attend l'activation.
+     * \param sequence    Séquence à dépasser.
+     * \return le numéro de séquence de l'activation obtenue.
+     */
+    unsigned long long attendre_contact_apres(int no_contact, unsigned long long sequence);
+
+    /**
+     * Méthode bloquante, permettant d'attendre une activation du contact voulu
+     * par une locomotive donnée, postérieure à une séquence donnée.
+     * \param no_contact  Numéro du contact dont on attend l'activation.
+     * \param no_loco     Numéro de la locomotive attendue.
+     * \param sequence    Séquence à dépasser.
+     * \return le numéro de séquence de l'activation obtenue.
+     */
+    unsigned long long attendre_contact_loco(int no_contact, int no_loco, unsigned long long sequence);
+
+    /**
+     * Méthode bloquante, permettant d'attendre la prochaine activation de l'un des contacts voulus.
+     * \param liste       Tableau des numéros de contacts surveillés.
+     * \param n           Nombre de contacts dans le tableau.
+     * \param timeout_ms  Délai maximal d'attente en millisecondes, négatif pour une attente illimitée.
+     * \param which       Reçoit le numéro du contact activé (peut être nul).
+     * \return 1 si un contact a été activé, 0 si le délai a expiré ou si aucun contact n'est
+     * surveillé (liste nulle ou n <= 0).
+     */
+    int attendre_contacts(const int *liste, int n, int timeout_ms, int *which);
+
+    /**
+     * Donne les voies du segment reliant deux contacts voisins.
+     * \param contact_a  Numéro du premier contact.
+     * \param contact_b  Numéro du second contact.
+     * \param voies      Reçoit les numéros des voies du segment.
+     * \param taille     Nombre de cases du tableau voies.
+     * \return le nombre de voies du segment, -1 si les contacts ne sont pas voisins.
+     */
+    int voies_segment(int contact_a, int contact_b, int *voies, int taille);
+
+    /**
+     * Calcule l'itinéraire passant successivement par des contacts, ou le retrouve dans le cache.
+     * \param etapes  Contacts à visiter, dans l'ordre.
+     * \param n       Nombre de contacts dans le tableau.
+     * \return le numéro de l'itinéraire, -1 s'il n'existe pas.
+     */
+    int calculer_itineraire(const int *etapes, int n);
+
+    /**
+     * Donne les contacts franchis successivement par un itinéraire.
+     * \param itineraire  Numéro de l'itinéraire.
+     * \param contacts    Reçoit les numéros des contacts.
+     * \param taille      Nombre de cases du tableau contacts.
+     * \return le nombre de contacts, -1 si l'itinéraire n'existe pas.
+     */
+    int contacts_itineraire(int itineraire, int *contacts, int taille);
+
+    /**
+     * Donne les aiguillages à diriger après le franchissement d'un contact de l'itinéraire.
+     * \param itineraire   Numéro de l'itinéraire.
+     * \param indice       Indice du contact dans l'itinéraire.
+     * \param aiguillages  Reçoit les numéros des aiguillages.
+     * \param directions   Reçoit leur direction.
+     * \param taille       Nombre de cases des tableaux.
+     * \return le nombre d'aiguillages, -1 si l'itinéraire ou l'indice n'existe pas.
+     */
+    int aiguillages_itineraire(int itineraire, int indice, int *aiguillages, int *directions, int taille);
+
     /**
      * Arrete une locomotive (met sa vitesse à  VITESSE_NULLE).
      * \param no_loco  Numéro de la loco à  stopper.
@@ -152,10 +240,28 @@ public:
       */
     void selection_maquette(QString maquette);
 
+    /** Dépose un message dans le journal ; il est affiché dans la console générale à la
+      * trame suivante.
+      */
     void afficher_message(const char *message);
 
+    /** Dépose un message dans le journal ; il est affiché dans la console de la loco à la
+      * trame suivante.
+      */
     void afficher_message_loco(int numLoco,const char *message);
 
+    /** Affiche dans la console les latences de réveil des threads attendant les contacts.
+      */
+    void afficher_statistiques_contacts();
+
+    /** Enregistre un événement d'une section partagée dans le journal des événements.
+      * \param numLoco le numéro de la loco.
+      * \param numSection le numéro de la section.
+      * \param evenement SECTION_DEMANDE, SECTION_ATTENTE, SECTION_ACCES ou SECTION_SORTIE.
+      * \param entree le point d'entrée de la loco pour SECTION_DEMANDE.
+      */
+    void journaliser_section(int numLoco, int numSection, int evenement, int entree);
+
     QString getCommand();
 
 public slots:
@@ -164,18 +270,39 @@ public slots:
 protected slots:
     void timerTrigger();
 
+    /** Ecrit un message sur la sortie standard (simulation sans affichage).
+      * \param message le message à écrire.
+      */
+    void ecrireMessage(QString message);
+
+    /** Retire les messages du journal et les affiche dans les consoles, ou les écrit
+      * sur la sortie standard en simulation sans affichage. Appelée à chaque trame.
+      */
+    void viderJournal();
+
+    /** Ferme le journal des événements (fermeture du simulateur).
+      */
+    void terminerJournalEvenements();
+
+    /** Ecrit les latences de réveil des contacts dans FICHIER_STATISTIQUES (fermeture du simulateur).
+      */
+    void ecrireStatistiques();
+
+    /** Termine la simulation sans affichage suite à une collision.
+      * \param l1 la première loco
+      * \param l2 la seconde loco
+      */
+    void collisionSansRendu(Loco* l1, Loco* l2);
+
+    /** Termine le rejeu d'une trace en affichant son rapport. Le code de retour
+      * de l'application est 0 si le rejeu est identique à la trace, 2 sinon.
+      */
+    void finRejeu();
+
 signals:
-    void addLoco(int no_loco);
-    void setLoco(int contactA, int contactB, int numLoco, int vitesseLoco);
     void askLoco(int contactA, int contactB);
-    void setVitesseLoco(int numLoco, int vitesseLoco);
-    void reverseLoco(int numLoco);
-    void setVitesseProgressiveLoco(int numLoco, int vitesseLoco);
     void stopLoco(int numLoco);
-    void setVoieVariable(int numVoieVariable, int direction);
     void selectMaquette(QString maquette);
-    void afficheMessage(QString message);
-    void afficheMessageLoco(int numLoco,QString message);
 
 private:
     QString command;
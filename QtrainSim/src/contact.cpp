@@ -12,10 +12,12 @@ Contact::Contact(int numContact, int numVoiePorteuse, QObject *parent) :
 {
     this->numContact = numContact;
     this->numVoiePorteuse = numVoiePorteuse;
-    mutex = new QMutex();
-    VarCond = new QWaitCondition();
     setZValue(ZVAL_CONTACT);
-    waitingOn=false;
+    setAngle(0.0);
+
+    //attendActivation est appelée par les threads clients : le contact est redessiné
+    //dans le thread de l'affichage.
+    CONNECT(this, SIGNAL(attentesModifiees()), this, SLOT(rafraichir()));
 }
 
 int Contact::getNumContact()
@@ -26,18 +28,28 @@ int Contact::getNumContact()
 
 void Contact::attendContact()
 {
-    mutex->lock();
-    waitingOn=true;
-    update();
-    VarCond->wait(mutex);
-    waitingOn=false;
+    attendActivation(BusContacts::getInstance()->getSequence(numContact));
+}
+
+quint64 Contact::attendActivation(quint64 sequence, int numLoco)
+{
+    //seul le passage de zéro à une attente, et inversement, change l'affichage.
+    if(nbreAttentes.fetchAndAddOrdered(1) == 0)
+        emit attentesModifiees();
+    quint64 obtenue = BusContacts::getInstance()->attendre(numContact, sequence, numLoco);
+    if(nbreAttentes.fetchAndAddOrdered(-1) == 1)
+        emit attentesModifiees();
+    return obtenue;
+}
+
+void Contact::rafraichir()
+{
     update();
-    mutex->unlock();
 }
 
-void Contact::active()
+void Contact::active(int numLoco)
 {
-    VarCond->wakeAll();
+    BusContacts::getInstance()->signaler(numContact, numLoco);
 }
 
 int Contact::getNumVoiePorteuse()
@@ -47,18 +59,35 @@ int Contact::getNumVoiePorteuse()
 
 void Contact::setAngle(qreal angle)
 {
+    prepareGeometryChange();
     this->angle = angle;
+
+    qreal theangle=angle;
+    while (theangle>PI)
+         theangle-=PI;
+    while (theangle<0.0)
+         theangle+=PI;
+
+    rectNumero = QRectF(TRANSLATION_NUM_CONTACT * cos(theangle) - 3.0 * TAILLE_CONTACT,
+                        TRANSLATION_NUM_CONTACT * sin(theangle) - 3.0 * TAILLE_CONTACT,
+                        6.0 * TAILLE_CONTACT,
+                        6.0 * TAILLE_CONTACT);
+
+    //le trait vers le numéro s'arrête à mi-chemin, il est donc contenu dans l'union.
+    rectEnglobant = QRectF(- TAILLE_CONTACT, - TAILLE_CONTACT, 2.0 * TAILLE_CONTACT, 2.0 * TAILLE_CONTACT)
+            .united(rectNumero)
+            .adjusted(-1.0, -1.0, 1.0, 1.0);
 }
 
 QRectF Contact::boundingRect() const
 {
-    return QRectF(- 100.0, - 100.0, 200.0, 200.0);
+    return rectEnglobant;
 }
 
-#include <QGraphicsScene>
-
 void Contact::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
 {
+    bool waitingOn = nbreAttentes.load() > 0;
+
     if (waitingOn)
     {
         painter->setPen(COULEUR_CONTACT_WAITING);
@@ -76,41 +105,18 @@ void Contact::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*
         QString t;
         t.setNum(numContact);
 
+        //la fonte n'est construite qu'une fois.
+        static const QFont fonte = FONTE_CONTACT;
+        painter->setFont(fonte);
+
         if (waitingOn)
-        {
             painter->setPen(COULEUR_CONTACT_WAITING);
-            painter->setFont(FONTE_CONTACT);
-        }
         else
-        {
             painter->setPen(COULEUR_FONTE_CONTACT);
-            painter->setFont(FONTE_CONTACT);
-        }
-        qreal theangle=angle;
-        while (theangle>PI)
-             theangle-=PI;
-        while (theangle<0.0)
-             theangle+=PI;
-
-        QRectF r=QRectF(TRANSLATION_NUM_CONTACT * cos(theangle) - 3.0 * TAILLE_CONTACT,
-                        TRANSLATION_NUM_CONTACT * sin(theangle) - 3.0 * TAILLE_CONTACT,
-                        6.0 * TAILLE_CONTACT,
-                        6.0 * TAILLE_CONTACT);
-/*
-        r.translate(this->scenePos());
-        if (this->scene()->items(r,Qt::IntersectsItemShape,Qt::AscendingOrder).size()>=2) {
-            theangle+=PI;
-            r=QRectF(TRANSLATION_NUM_CONTACT * cos(theangle) - 3.0 * TAILLE_CONTACT,
-                                    TRANSLATION_NUM_CONTACT * sin(theangle) - 3.0 * TAILLE_CONTACT,
-                                    6.0 * TAILLE_CONTACT,
-                                    6.0 * TAILLE_CONTACT);
-        }
-        else
-            r.translate(-this->scenePos());
-  */
-        painter->drawText(r,
+
+        painter->drawText(rectNumero,
                           t,
                           QTextOption(Qt::AlignHCenter|Qt::AlignVCenter));
-        painter->drawLine(QPointF(0.0,0.0), QPointF(TRANSLATION_NUM_CONTACT * cos(theangle) / 2.0, TRANSLATION_NUM_CONTACT * sin(theangle) / 2.0));
+        painter->drawLine(QPointF(0.0,0.0), rectNumero.center() / 2.0);
     }
 }
@@ -3,13 +3,14 @@
 
 #include <QObject>
 #include <QAbstractGraphicsShapeItem>
-#include <QMutex>
-#include <QWaitCondition>
+#include <QAtomicInt>
 #include <QPainter>
 #include <QDebug>
 #include <math.h>
 
 #include "general.h"
+#include "buscontacts.h"
+#include "connect.h"
 
 class Contact : public QObject, public QAbstractGraphicsShapeItem
 {
@@ -22,14 +23,23 @@ public:
       */
     explicit Contact(int numContact, int numVoiePorteuse, QObject *parent = 0);
 
-    /** Méthode bloquante, permettant d'attendre sur l'activation du contact.
+    /** Méthode bloquante, permettant d'attendre la prochaine activation du contact.
       */
     void attendContact();
 
+    /** Méthode bloquante, permettant d'attendre une activation du contact postérieure
+      * à une séquence donnée, éventuellement par une loco précise.
+      * \param sequence la séquence à dépasser.
+      * \param numLoco la loco attendue, BusContacts::TOUTES_LOCOS pour n'importe laquelle.
+      * \return le numéro de séquence de l'activation obtenue.
+      */
+    quint64 attendActivation(quint64 sequence, int numLoco = BusContacts::TOUTES_LOCOS);
+
     /** Méthode appelée quand une loco passe sur le contact.
-      * Libère les threads en attente.
+      * Publie l'activation sur le bus des contacts, ce qui libère les threads en attente.
+      * \param numLoco le numéro de la loco passant sur le contact.
       */
-    void active();
+    void active(int numLoco);
 
     /** retourne le numéro de la voie porteuse.
       * \return le numéro de la voie porteuse.
@@ -37,11 +47,12 @@ public:
     int getNumVoiePorteuse();
 
     /** Permet de spécifier selon quel angle le numéro du contact doit être décalé.
+      * Recalcule l'emplacement du numéro et le rectangle englobant.
       * \param angle l'angle en radians.
       */
     void setAngle(qreal angle);
 
-    /** retourne le rectangle englobant le contact. Nécessaire à l'affichage.
+    /** retourne le rectangle englobant le contact et son numéro. Nécessaire à l'affichage.
       * \return le rectangle englobant le contact.
       */
     QRectF boundingRect() const;
@@ -56,16 +67,26 @@ public:
       */
     int getNumContact();
 signals:
+    /** émis depuis le thread client lorsque le nombre d'attentes sur le contact change.
+      */
+    void attentesModifiees();
 
 public slots:
 
+private slots:
+    /** redessine le contact, dans le thread de l'affichage.
+      */
+    void rafraichir();
+
 private:
     int numVoiePorteuse;
     int numContact;
-    QWaitCondition* VarCond;
-    QMutex* mutex;
     qreal angle;
-    bool waitingOn;
+    //! emplacement du numéro du contact, calculé par setAngle.
+    QRectF rectNumero;
+    //! rectangle englobant, calculé par setAngle.
+    QRectF rectEnglobant;
+    QAtomicInt nbreAttentes;
 };
 
 #endif // CONTACT_H
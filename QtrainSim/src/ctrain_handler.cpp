@@ -49,6 +49,16 @@ void diriger_aiguillage(int no_aiguillage, int direction, int temps_alim) {
     CMD_TRAIN->diriger_aiguillage(no_aiguillage,direction,temps_alim);
 }
 
+/*
+ * Retourne la direction d'un aiguillage, fixee par la derniere commande executee
+ * par le moteur. Une commande transmise mais pas encore appliquee n'y figure pas.
+ *   no_aiguillage : No de l'aiguillage.
+ *   version       : Recoit, s'il n'est pas nul, le nombre de changements de direction.
+ */
+int etat_aiguillage(int no_aiguillage, unsigned long long *version) {
+    return CMD_TRAIN->etat_aiguillage(no_aiguillage, version);
+}
+
 /*
  * Attend l'activation du contact donne.
  *   no_contact : No du contact dont on attend l'activation.
@@ -57,6 +67,103 @@ void attendre_contact(int no_contact) {
     CMD_TRAIN->attendre_contact(no_contact);
 }
 
+/*
+ * Retourne le numero de sequence de la derniere activation du contact donne.
+ *   no_contact : No du contact.
+ */
+unsigned long long sequence_contact(int no_contact) {
+    return CMD_TRAIN->sequence_contact(no_contact);
+}
+
+/*
+ * Attend une activation du contact donne posterieure a la sequence donnee.
+ *   no_contact : No du contact dont on attend l'activation.
+ *   sequence   : Sequence a depasser.
+ */
+unsigned long long attendre_contact_apres(int no_contact, unsigned long long sequence) {
+    return CMD_TRAIN->attendre_contact_apres(no_contact, sequence);
+}
+
+/*
+ * Attend une activation du contact donne par une loco donnee, posterieure a la sequence donnee.
+ *   no_contact : No du contact dont on attend l'activation.
+ *   no_loco    : No de la loco attendue.
+ *   sequence   : Sequence a depasser.
+ */
+unsigned long long attendre_contact_loco(int no_contact, int no_loco, unsigned long long sequence) {
+    return CMD_TRAIN->attendre_contact_loco(no_contact, no_loco, sequence);
+}
+
+/*
+ * Attend la prochaine activation de l'un des contacts donnes.
+ *   liste      : Tableau des No de contacts surveilles.
+ *   n          : Nombre de contacts dans le tableau.
+ *   timeout_ms : Delai maximal d'attente en millisecondes, negatif pour une attente illimitee.
+ *   which      : Recoit le No du contact active (peut etre NULL).
+ */
+int attendre_contacts(const int *liste, int n, int timeout_ms, int *which) {
+    return CMD_TRAIN->attendre_contacts(liste, n, timeout_ms, which);
+}
+
+/*
+ * Donne les voies du segment reliant deux contacts voisins.
+ *   contact_a, contact_b : No des contacts delimitant le segment.
+ *   voies                : Recoit les No des voies du segment.
+ *   taille               : Nombre de cases du tableau voies.
+ */
+int voies_segment(int contact_a, int contact_b, int *voies, int taille) {
+    return CMD_TRAIN->voies_segment(contact_a, contact_b, voies, taille);
+}
+
+/*
+ * Calcule l'itineraire passant successivement par les contacts donnes.
+ *   etapes : Contacts a visiter, dans l'ordre.
+ *   n      : Nombre de contacts dans le tableau.
+ */
+int calculer_itineraire(const int *etapes, int n) {
+    return CMD_TRAIN->calculer_itineraire(etapes, n);
+}
+
+/*
+ * Donne les contacts franchis successivement par un itineraire.
+ *   itineraire : No de l'itineraire.
+ *   contacts   : Recoit les No des contacts.
+ *   taille     : Nombre de cases du tableau contacts.
+ */
+int contacts_itineraire(int itineraire, int *contacts, int taille) {
+    return CMD_TRAIN->contacts_itineraire(itineraire, contacts, taille);
+}
+
+/*
+ * Donne les aiguillages a diriger apres le franchissement d'un contact de l'itineraire.
+ *   itineraire  : No de l'itineraire.
+ *   indice      : Indice du contact dans l'itineraire.
+ *   aiguillages : Recoit les No des aiguillages.
+ *   directions  : Recoit leur direction.
+ *   taille      : Nombre de cases des tableaux.
+ */
+int aiguillages_itineraire(int itineraire, int indice, int *aiguillages, int *directions, int taille) {
+    return CMD_TRAIN->aiguillages_itineraire(itineraire, indice, aiguillages, directions, taille);
+}
+
+/*
+ * Affiche les latences de reveil des threads attendant les contacts.
+ */
+void afficher_statistiques_contacts(void) {
+    CMD_TRAIN->afficher_statistiques_contacts();
+}
+
+/*
+ * Enregistre un evenement d'une section partagee dans le journal des evenements.
+ *   no_loco    : No de la loco.
+ *   no_section : No de la section partagee.
+ *   evenement  : SECTION_DEMANDE, SECTION_ATTENTE, SECTION_ACCES ou SECTION_SORTIE.
+ *   entree     : Point d'entree de la loco pour SECTION_DEMANDE, 0 sinon.
+ */
+void journaliser_section(int no_loco, int no_section, int evenement, int entree) {
+    CMD_TRAIN->journaliser_section(no_loco, no_section, evenement, entree);
+}
+
 /*
  * Arrete une locomotive (met sa vitesse a VITESSE_NULLE).
  *   no_loco : No de la loco a arreter.
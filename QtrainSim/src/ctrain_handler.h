@@ -45,11 +45,19 @@ extern "C" {
 // Direction des aiguillages
 #define DEVIE 0
 #define TOUT_DROIT 1
+// Direction d'un aiguillage jamais commande (etat_aiguillage)
+#define DIRECTION_INCONNUE -2
 
 // Etat des phares
 #define ETEINT 0
 #define ALLUME 1
 
+// Evenements des sections partagees (journaliser_section)
+#define SECTION_DEMANDE 0
+#define SECTION_ATTENTE 1
+#define SECTION_ACCES 2
+#define SECTION_SORTIE 3
+
 /*
  * Initialise la communication avec la maquette/simulateur.
  * A appeler au debut du programme client.
@@ -71,15 +79,139 @@ void mettre_maquette_en_service(void);
  *   no_aiguillage : No de l'aiguillage a diriger.
  *   direction     : Nouvelle direction. (DEVIE ou TOUT_DROIT)
  *   temps_alim    : Temps l'alimentation minimal du bobinage de l'aiguillage.
+ * Sans effet si l'aiguillage est deja dans la direction demandee.
  */
 void diriger_aiguillage(int no_aiguillage, int direction, int temps_alim);
 
+/*
+ * Retourne la direction d'un aiguillage, fixee par la derniere commande executee.
+ * diriger_aiguillage n'execute pas une commande vers cette direction : les commandes
+ * repetees a chaque tour ne coutent rien.
+ *   no_aiguillage : No de l'aiguillage.
+ *   version       : Recoit, s'il n'est pas nul, le nombre de changements de direction
+ *                   de l'aiguillage. Deux lectures de meme version garantissent que
+ *                   l'aiguillage n'a pas change entre-temps.
+ *   return        : DEVIE, TOUT_DROIT, ou DIRECTION_INCONNUE si l'aiguillage n'a jamais
+ *                   ete commande depuis le chargement de la maquette.
+ */
+int etat_aiguillage(int no_aiguillage, unsigned long long *version);
+
 /*
  * Attend l'activation du contact donne.
  *   no_contact : No du contact dont on attend l'activation.
  */
 void attendre_contact(int no_contact);
 
+/*
+ * Retourne le numero de sequence de la derniere activation du contact donne.
+ * Les numeros de sequence d'un contact sont strictement croissants.
+ *   no_contact : No du contact.
+ *   return     : le numero de sequence, 0 si le contact n'a jamais ete active.
+ */
+unsigned long long sequence_contact(int no_contact);
+
+/*
+ * Attend une activation du contact donne posterieure a la sequence donnee.
+ * Retourne immediatement si une telle activation a deja eu lieu : une activation
+ * survenue entre deux appels n'est donc jamais perdue.
+ *   no_contact : No du contact dont on attend l'activation.
+ *   sequence   : Sequence a depasser (typiquement la valeur retournee par l'appel precedent).
+ *   return     : le numero de sequence de l'activation obtenue.
+ */
+unsigned long long attendre_contact_apres(int no_contact, unsigned long long sequence);
+
+/*
+ * Attend une activation du contact donne par une loco donnee, posterieure a la sequence donnee.
+ *   no_contact : No du contact dont on attend l'activation.
+ *   no_loco    : No de la loco attendue.
+ *   sequence   : Sequence a depasser.
+ *   return     : le numero de sequence de l'activation obtenue.
+ * Remarque : sur la maquette reelle, la loco passant sur un contact ne peut pas etre
+ *            identifiee : toute activation est acceptee.
+ */
+unsigned long long attendre_contact_loco(int no_contact, int no_loco, unsigned long long sequence);
+
+/*
+ * Attend la prochaine activation de l'un des contacts donnes.
+ *   liste      : Tableau des No de contacts surveilles.
+ *   n          : Nombre de contacts dans le tableau.
+ *   timeout_ms : Delai maximal d'attente en millisecondes, negatif pour une attente illimitee.
+ *   which      : Recoit le No du contact active (peut etre NULL).
+ *   return     : 1 si un contact a ete active, 0 si le delai a expire.
+ * Retourne 0 immediatement si liste est NULL ou si n <= 0, quel que soit timeout_ms.
+ */
+int attendre_contacts(const int *liste, int n, int timeout_ms, int *which);
+
+/*
+ * Donne les voies du segment reliant deux contacts voisins, afin de determiner
+ * quelles portions de parcours se partagent des voies (aiguillages, croisements).
+ *   contact_a, contact_b : No des contacts delimitant le segment.
+ *   voies                : Recoit les No des voies du segment, contacts compris.
+ *   taille               : Nombre de cases du tableau voies.
+ *   return               : Nombre de voies du segment (les taille premieres sont
+ *                          ecrites), -1 si les contacts ne sont pas voisins ou si
+ *                          la topologie n'est pas connue (maquette reelle).
+ */
+int voies_segment(int contact_a, int contact_b, int *voies, int taille);
+
+/*
+ * Calcule l'itineraire passant successivement par les contacts donnes, en cherchant
+ * le chemin le plus court sur le graphe des voies, et en deduit la direction de chaque
+ * aiguillage traverse. Le resultat est mis en cache : un nouvel appel avec les memes
+ * contacts le retourne sans nouveau calcul.
+ *   etapes : Contacts a visiter, dans l'ordre ; le premier est le contact de depart.
+ *            Si le dernier est egal au premier, l'itineraire est une boucle.
+ *   n      : Nombre de contacts dans le tableau.
+ *   return : No de l'itineraire, -1 s'il n'existe pas ou si la topologie n'est pas
+ *            connue (maquette reelle).
+ */
+int calculer_itineraire(const int *etapes, int n);
+
+/*
+ * Donne les contacts franchis successivement par un itineraire, contacts
+ * intermediaires compris.
+ *   itineraire : No de l'itineraire.
+ *   contacts   : Recoit les No des contacts.
+ *   taille     : Nombre de cases du tableau contacts.
+ *   return     : Nombre de contacts de l'itineraire (les taille premiers sont ecrits),
+ *                -1 si l'itineraire n'existe pas.
+ */
+int contacts_itineraire(int itineraire, int *contacts, int taille);
+
+/*
+ * Donne les aiguillages a diriger apres le franchissement d'un contact de
+ * l'itineraire, pour atteindre le contact suivant.
+ *   itineraire  : No de l'itineraire.
+ *   indice      : Indice du contact dans le tableau donne par contacts_itineraire.
+ *   aiguillages : Recoit les No des aiguillages.
+ *   directions  : Recoit leur direction (DEVIE ou TOUT_DROIT).
+ *   taille      : Nombre de cases des tableaux aiguillages et directions.
+ *   return      : Nombre d'aiguillages (les taille premiers sont ecrits), -1 si
+ *                 l'itineraire ou l'indice n'existe pas.
+ */
+int aiguillages_itineraire(int itineraire, int indice, int *aiguillages, int *directions, int taille);
+
+/*
+ * Affiche les latences de reveil des threads attendant les contacts : delai entre
+ * l'activation d'un contact et le retour de l'attente correspondante.
+ * Ces latences sont aussi ecrites dans le fichier "latences_contacts.json" a la
+ * fin du programme.
+ */
+void afficher_statistiques_contacts(void);
+
+/*
+ * Enregistre un evenement d'une section partagee dans le journal des evenements du
+ * simulateur (option --evenements), pour en mesurer les attentes et l'occupation.
+ * Sans effet si le journal n'est pas ouvert, et toujours sans effet sur la maquette
+ * reelle : libmarklin n'enregistre aucun evenement.
+ *   no_loco    : No de la loco.
+ *   no_section : No de la section partagee.
+ *   evenement  : SECTION_DEMANDE, SECTION_ATTENTE (la loco est mise en attente),
+ *                SECTION_ACCES ou SECTION_SORTIE.
+ *   entree     : Point d'entree de la loco pour SECTION_DEMANDE, 0 sinon.
+ */
+void journaliser_section(int no_loco, int no_section, int evenement, int entree);
+
 /*
  * Arrete une locomotive (met sa vitesse a VITESSE_NULLE).
  *   no_loco : No de la loco a arreter.
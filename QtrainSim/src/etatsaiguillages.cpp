@@ -0,0 +1,43 @@
+#include "etatsaiguillages.h"
+
+//! nombre de bits réservés à l'état dans une entrée.
+static const int BITS_ETAT = 2;
+static const quint64 MASQUE_ETAT = (1 << BITS_ETAT) - 1;
+
+EtatsAiguillages::EtatsAiguillages()
+{
+    for(int i = 0; i <= MAX_AIGUILLAGES; i++)
+        entrees[i].store(0, std::memory_order_relaxed);
+}
+
+void EtatsAiguillages::appliquer(int numVoieVariable, int etat)
+{
+    //voie hors table ou état non représentable : rien à enregistrer.
+    if(numVoieVariable < 0 || numVoieVariable > MAX_AIGUILLAGES || etat < -1 || etat > 1)
+        return;
+
+    //seul le moteur écrit : une lecture suivie d'une écriture suffit.
+    std::atomic<quint64> &entree = entrees[numVoieVariable];
+    quint64 code = (quint64) (etat + 2);
+    quint64 ancienne = entree.load(std::memory_order_relaxed);
+
+    if((ancienne & MASQUE_ETAT) != code)
+        entree.store((((ancienne >> BITS_ETAT) + 1) << BITS_ETAT) | code, std::memory_order_release);
+}
+
+int EtatsAiguillages::getEtat(int numVoieVariable, quint64 *version) const
+{
+    quint64 entree = 0;
+    if(numVoieVariable >= 0 && numVoieVariable <= MAX_AIGUILLAGES)
+        entree = entrees[numVoieVariable].load(std::memory_order_acquire);
+
+    if(version != nullptr)
+        *version = entree >> BITS_ETAT;
+    return (entree & MASQUE_ETAT) == 0 ? DIRECTION_INCONNUE : (int) (entree & MASQUE_ETAT) - 2;
+}
+
+void EtatsAiguillages::vider()
+{
+    for(int i = 0; i <= MAX_AIGUILLAGES; i++)
+        entrees[i].fetch_and(~MASQUE_ETAT, std::memory_order_acq_rel);
+}
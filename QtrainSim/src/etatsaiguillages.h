@@ -0,0 +1,46 @@
+#ifndef ETATSAIGUILLAGES_H
+#define ETATSAIGUILLAGES_H
+
+#include <atomic>
+
+#include <QtGlobal>
+
+#include "general.h"
+
+/**
+  Table des états des voies variables, écrite par le moteur et lue par les threads clients.
+  Chaque entrée tient l'état appliqué de la voie et sa version, incrémentée à chaque
+  changement d'état. Les deux sont réunis dans un seul mot atomique : la table est lue
+  sans verrou. Seul le thread du moteur la modifie, au fil des commandes appliquées :
+  c'est là qu'une commande inutile est écartée, contre l'état effectif de la voie.
+  */
+class EtatsAiguillages
+{
+public:
+    EtatsAiguillages();
+
+    /** enregistre l'état effectif d'une voie variable, après l'application d'une commande
+      * ou un clic de l'utilisateur. Appelée par le thread du moteur seulement.
+      * \param numVoieVariable le numéro de la voie variable.
+      * \param etat le nouvel état.
+      */
+    void appliquer(int numVoieVariable, int etat);
+
+    /** retourne l'état d'une voie variable.
+      * \param numVoieVariable le numéro de la voie variable.
+      * \param version reçoit, s'il n'est pas nul, le nombre de changements d'état de la voie.
+      * \return l'état de la voie, DIRECTION_INCONNUE s'il n'a jamais été appliqué.
+      */
+    int getEtat(int numVoieVariable, quint64 *version) const;
+
+    /** oublie l'état de toutes les voies variables, avant le chargement d'une nouvelle maquette.
+      * Les versions sont conservées : elles ne décroissent jamais.
+      */
+    void vider();
+
+private:
+    //! version dans les bits de poids fort, état + 2 dans les deux bits de poids faible (0 : inconnu).
+    std::atomic<quint64> entrees[MAX_AIGUILLAGES + 1];
+};
+
+#endif // ETATSAIGUILLAGES_H
@@ -0,0 +1,58 @@
+#include <QThread>
+
+#include "filecommandes.h"
+
+FileCommandes::FileCommandes()
+    : ecriture(0), lecture(0)
+{
+    //la case i attend la commande de position i.
+    for(int i = 0; i < CAPACITE; i++)
+        cases[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+void FileCommandes::deposer(const Commande &commande)
+{
+    quint64 position = ecriture.load(std::memory_order_relaxed);
+    Case* c;
+
+    for(;;)
+    {
+        c = &cases[position & (CAPACITE - 1)];
+        qint64 ecart = (qint64) (c->sequence.load(std::memory_order_acquire) - position);
+
+        if(ecart == 0)
+        {
+            //case libre : on tente de la réserver.
+            if(ecriture.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(ecart < 0)
+        {
+            //file pleine : on laisse le moteur la vider.
+            QThread::yieldCurrentThread();
+            position = ecriture.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            //un autre producteur a réservé cette case entre-temps.
+            position = ecriture.load(std::memory_order_relaxed);
+        }
+    }
+
+    c->commande = commande;
+    c->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool FileCommandes::retirer(Commande &commande)
+{
+    Case* c = &cases[lecture & (CAPACITE - 1)];
+
+    if(c->sequence.load(std::memory_order_acquire) != lecture + 1)
+        return false;
+
+    commande = c->commande;
+    //la case est rendue aux producteurs pour le tour suivant.
+    c->sequence.store(lecture + CAPACITE, std::memory_order_release);
+    lecture++;
+    return true;
+}
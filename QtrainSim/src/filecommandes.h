@@ -0,0 +1,75 @@
+#ifndef FILECOMMANDES_H
+#define FILECOMMANDES_H
+
+#include <atomic>
+
+#include <QtGlobal>
+
+/**
+  Commande émise par le programme client à destination du moteur de simulation.
+  Enregistrement de taille fixe : son dépôt dans la file n'alloue aucune mémoire.
+  */
+struct Commande
+{
+    enum Type
+    {
+        AJOUTER_LOCO,
+        PLACER_LOCO,
+        VITESSE_LOCO,
+        VITESSE_PROGRESSIVE_LOCO,
+        INVERSER_LOCO,
+        VOIE_VARIABLE
+    };
+
+    Type type;
+    //! numéro de la loco ou de la voie variable concernée.
+    int numero;
+    //! vitesse de la loco, ou direction de la voie variable.
+    int valeur;
+    //! contacts entre lesquels placer la loco (PLACER_LOCO).
+    int contactA;
+    int contactB;
+};
+
+/**
+  File circulaire sans verrou, à plusieurs producteurs et un seul consommateur.
+  Les threads clients déposent leurs commandes, le moteur de simulation les retire
+  au début de chaque pas, dans l'ordre exact de leur dépôt.
+  Chaque case porte un numéro de séquence indiquant si elle est libre pour le
+  prochain producteur ou remplie pour le consommateur.
+  */
+class FileCommandes
+{
+public:
+    //! nombre de cases de la file (puissance de deux).
+    static const int CAPACITE = 1024;
+
+    FileCommandes();
+
+    /** dépose une commande. Peut être appelée simultanément par plusieurs threads.
+      * Si la file est pleine, le thread cède le processeur jusqu'à ce qu'une case se libère.
+      * \param commande la commande à déposer.
+      */
+    void deposer(const Commande &commande);
+
+    /** retire la plus ancienne commande déposée. Ne doit être appelée que par le consommateur.
+      * \param commande reçoit la commande retirée.
+      * \return vrai si une commande a été retirée, faux si la file est vide.
+      */
+    bool retirer(Commande &commande);
+
+private:
+    struct Case
+    {
+        std::atomic<quint64> sequence;
+        Commande commande;
+    };
+
+    Case cases[CAPACITE];
+    //! prochaine position d'écriture, partagée par les producteurs.
+    alignas(64) std::atomic<quint64> ecriture;
+    //! prochaine position de lecture, propre au consommateur.
+    alignas(64) quint64 lecture;
+};
+
+#endif // FILECOMMANDES_H
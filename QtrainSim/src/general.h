@@ -42,11 +42,37 @@
 #define ZVAL_EXPLOSION 4
 #define ZVAL_LOCO 3.0
 
+//! côté, en pixels, des tuiles dans lesquelles les voies fixes sont pré-rendues.
+#define TAILLE_TUILE_FOND 512
+//! nombre de tuiles conservées, de quoi couvrir plusieurs fois un grand écran.
+#define NBRE_MAX_TUILES_FOND 64
+
 //! indication du nombre d'images à calculer par seconde.
 //! en cas de fort ralentissement, baisser cette valeur.
 //! Valeurs conseillées : 30-60.
 #define FRAME_RATE 60
 
+//! durée simulée d'un pas de simulation, en millièmes de secondes.
+#define PAS_SIMULATION (1000.0 / FRAME_RATE)
+
+//! nombre de pas effectués à la suite lorsque la simulation n'est pas
+//! limitée au temps réel (mode sans affichage).
+#define PAS_PAR_LOT 64
+
+//! journal des messages des programmes clients : nombre de lignes en attente d'affichage,
+//! débit maximal de chaque source (lignes par seconde) et rafale tolérée au-delà.
+#define CAPACITE_JOURNAL 4096
+#define DEBIT_JOURNAL 200
+#define RAFALE_JOURNAL 400
+
+//! nombre de lignes conservées par chaque console.
+#define LIGNES_MAX_CONSOLE 2000
+
+//! nombre maximal de pas rattrapés en un déclenchement du timer lorsque la simulation
+//! limitée au temps réel a pris du retard. Au-delà, le retard est abandonné : la
+//! simulation ralentit plutôt que de s'emballer.
+#define PAS_MAX_PAR_TRAME 8
+
 //! permet d'ajuster la vitesse des locos. Ne pas changer.
 #define FACTEUR_VITESSE 0.05
 
@@ -82,14 +108,31 @@
 //! Direction des aiguillages
 #define DEVIE 0
 #define TOUT_DROIT 1
+//! Direction d'un aiguillage jamais commandé
+#define DIRECTION_INCONNUE -2
 
 //! Etat des phares
 #define ETEINT 0
 #define ALLUME 1
 
+//! Evénements des sections partagées (journaliser_section)
+#define SECTION_DEMANDE 0
+#define SECTION_ATTENTE 1
+#define SECTION_ACCES 2
+#define SECTION_SORTIE 3
+
 
 #define DATADIR QCoreApplication::applicationDirPath()+"/data"
 
 #define MAQUETTE_DIR DATADIR+"/Maquettes"
 
+//! Extension du cache binaire écrit à côté du fichier d'une maquette
+#define EXTENSION_CACHE_MAQUETTE ".cache"
+
+//! Commande de la console affichant les latences de réveil des contacts
+#define COMMANDE_STATISTIQUES ":stats"
+
+//! Fichier des latences de réveil des contacts, écrit à la fermeture
+#define FICHIER_STATISTIQUES "latences_contacts.json"
+
 #endif // GENERAL_H
@@ -0,0 +1,214 @@
+#include <QQueue>
+
+#include "itineraires.h"
+#include "voievariable.h"
+
+Itineraires::Itineraires()
+{
+}
+
+QVector<int> Itineraires::sortiesPossibles(Voie *v, int ordreEntree)
+{
+    QVector<int> sorties;
+    VoieVariable* vv = dynamic_cast<VoieVariable*>(v);
+
+    if(vv != nullptr)
+    {
+        //seules les sorties accessibles dans l'un des états de la voie.
+        sorties.append(vv->getOrdreSortie(ordreEntree, TOUT_DROIT));
+        int devie = vv->getOrdreSortie(ordreEntree, DEVIE);
+        if(devie != sorties.first())
+            sorties.append(devie);
+    }
+    else
+    {
+        int ordres[Voie::MAX_SORTIES_EXPLORATION];
+        int nbreSorties = v->getSortiesExploration(ordreEntree, ordres);
+        for(int i = 0; i < nbreSorties; i++)
+            sorties.append(ordres[i]);
+    }
+    return sorties;
+}
+
+bool Itineraires::chercherChemin(const QVector<Sortie> &departs, Voie *arrivee, QVector<Sortie> &chemin)
+{
+    //chaque sortie visitée retient celle qui y a mené.
+    QHash<Sortie, Sortie> precedentes;
+    QQueue<Sortie> file;
+    const Sortie aucune(nullptr, -1);
+
+    foreach(const Sortie &s, departs)
+    {
+        if(!precedentes.contains(s))
+        {
+            precedentes.insert(s, aucune);
+            file.enqueue(s);
+        }
+    }
+
+    while(!file.isEmpty())
+    {
+        Sortie s = file.dequeue();
+        Voie* suivante = s.first->getVoieVoisineDOrdre(s.second);
+        if(suivante == nullptr)
+            continue;
+
+        if(suivante == arrivee)
+        {
+            chemin.clear();
+            for(Sortie c = s; c.first != nullptr; c = precedentes.value(c))
+                chemin.prepend(c);
+            return true;
+        }
+
+        int ordreEntree = suivante->ordreDe(s.first);
+        foreach(int ordreSortie, sortiesPossibles(suivante, ordreEntree))
+        {
+            Sortie t(suivante, ordreSortie);
+            if(!precedentes.contains(t))
+            {
+                precedentes.insert(t, s);
+                file.enqueue(t);
+            }
+        }
+    }
+    return false;
+}
+
+int Itineraires::calculer(const QMap<int, Voie*> &voies, const QMap<int, Contact*> &contacts, const QVector<int> &etapes, QString &erreur)
+{
+    QMutexLocker verrou(&mutex);
+
+    if(index.contains(etapes))
+        return index.value(etapes);
+
+    if(etapes.size() < 2)
+    {
+        erreur = "Un itinéraire doit comporter au moins deux contacts.";
+        return -1;
+    }
+
+    foreach(int numContact, etapes)
+    {
+        if(!contacts.contains(numContact))
+        {
+            erreur = QString("Le contact %1 n'existe pas.").arg(numContact);
+            return -1;
+        }
+    }
+
+    Itineraire it;
+    it.boucle = (etapes.first() == etapes.last());
+
+    Voie* depart = voies.value(contacts.value(etapes.first())->getNumVoiePorteuse());
+    //au départ, la loco peut partir par n'importe quelle extrémité.
+    QVector<Sortie> departs;
+    for(int i = 0; i < depart->getNbreLiaisons(); i++)
+        departs.append(Sortie(depart, i));
+
+    int ordreEntree = -1;
+    int premiereSortie = -1;
+    it.contacts.append(etapes.first());
+    it.aiguillages.append(QVector<QPair<int, int> >());
+
+    for(int e = 1; e < etapes.size(); e++)
+    {
+        Voie* arrivee = voies.value(contacts.value(etapes.at(e))->getNumVoiePorteuse());
+        QVector<Sortie> chemin;
+        if(!chercherChemin(departs, arrivee, chemin))
+        {
+            erreur = QString("Le contact %1 n'est pas accessible depuis le contact %2.").arg(etapes.at(e)).arg(etapes.at(e - 1));
+            return -1;
+        }
+        if(premiereSortie < 0)
+            premiereSortie = chemin.first().second;
+
+        for(int i = 0; i < chemin.size(); i++)
+        {
+            Voie* v = chemin.at(i).first;
+            int ordreSortie = chemin.at(i).second;
+
+            //un contact intermédiaire commence un nouveau tronçon.
+            if(i > 0 && v->getContact() != nullptr)
+            {
+                it.contacts.append(v->getContact()->getNumContact());
+                it.aiguillages.append(QVector<QPair<int, int> >());
+            }
+
+            VoieVariable* vv = dynamic_cast<VoieVariable*>(v);
+            if(vv != nullptr && ordreEntree >= 0)
+            {
+                //de préférence l'état reliant aussi les deux extrémités en sens inverse (aiguillage pris en talon).
+                int etat = -1;
+                foreach(int candidat, QVector<int>() << TOUT_DROIT << DEVIE)
+                {
+                    if(vv->getOrdreSortie(ordreEntree, candidat) != ordreSortie)
+                        continue;
+                    if(etat < 0 || vv->getOrdreSortie(ordreSortie, candidat) == ordreEntree)
+                        etat = candidat;
+                }
+
+                QVector<QPair<int, int> > &aiguillages = it.aiguillages.last();
+                for(int a = 0; a < aiguillages.size(); a++)
+                {
+                    if(aiguillages.at(a).first == vv->getNumVoieVariable() && aiguillages.at(a).second != etat)
+                    {
+                        erreur = QString("L'aiguillage %1 doit prendre deux directions entre les contacts %2 et %3.")
+                                .arg(vv->getNumVoieVariable()).arg(etapes.at(e - 1)).arg(etapes.at(e));
+                        return -1;
+                    }
+                }
+                aiguillages.append(qMakePair(vv->getNumVoieVariable(), etat));
+            }
+
+            Voie* suivante = v->getVoieVoisineDOrdre(ordreSortie);
+            ordreEntree = suivante->ordreDe(v);
+        }
+
+        //l'étape suivante repart de l'arrivée, sans demi-tour.
+        departs.clear();
+        foreach(int ordreSortie, sortiesPossibles(arrivee, ordreEntree))
+            departs.append(Sortie(arrivee, ordreSortie));
+
+        if(e < etapes.size() - 1 || !it.boucle)
+        {
+            it.contacts.append(etapes.at(e));
+            it.aiguillages.append(QVector<QPair<int, int> >());
+        }
+    }
+
+    if(it.boucle)
+    {
+        //la boucle doit repartir du contact de départ dans le sens initial.
+        bool memeSens = false;
+        foreach(const Sortie &s, departs)
+            memeSens = memeSens || s.second == premiereSortie;
+        if(!memeSens)
+        {
+            erreur = QString("L'itinéraire revient au contact %1 dans le sens opposé à celui du départ.").arg(etapes.first());
+            return -1;
+        }
+    }
+
+    itineraires.append(it);
+    index.insert(etapes, itineraires.size() - 1);
+    return itineraires.size() - 1;
+}
+
+bool Itineraires::getItineraire(int numero, Itineraire &itineraire) const
+{
+    QMutexLocker verrou(&mutex);
+
+    if(numero < 0 || numero >= itineraires.size())
+        return false;
+    itineraire = itineraires.at(numero);
+    return true;
+}
+
+void Itineraires::vider()
+{
+    QMutexLocker verrou(&mutex);
+
+    itineraires.clear();
+    index.clear();
+}
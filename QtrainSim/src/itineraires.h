@@ -0,0 +1,85 @@
+#ifndef ITINERAIRES_H
+#define ITINERAIRES_H
+
+#include <QMap>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include "voie.h"
+#include "contact.h"
+
+/**
+  Itinéraire calculé d'après une suite de contacts à visiter.
+  */
+struct Itineraire
+{
+    //! contacts franchis successivement, contacts intermédiaires compris ; le premier est le contact de départ.
+    QVector<int> contacts;
+    //! pour chaque contact franchi, les aiguillages à diriger pour atteindre le suivant : paires (numéro, direction).
+    QVector<QVector<QPair<int, int> > > aiguillages;
+    //! vrai si l'itinéraire revient à son contact de départ, dans le même sens.
+    bool boucle;
+};
+
+/**
+  Calcul des itinéraires sur le graphe des voies.
+  Entre deux contacts à visiter, le chemin le plus court (en nombre de voies) est
+  cherché en largeur, sans demi-tour, en parcourant les voies variables dans chacun
+  de leurs états ; l'état de chaque voie variable traversée en est déduit.
+  Les itinéraires sont mis en cache par suite de contacts : seul le premier calcul
+  parcourt le graphe. Les méthodes peuvent être appelées depuis les threads clients.
+  */
+class Itineraires
+{
+public:
+    Itineraires();
+
+    /** calcule l'itinéraire passant successivement par des contacts, ou le retrouve dans le cache.
+      * \param voies les voies de la maquette.
+      * \param contacts les contacts de la maquette.
+      * \param etapes les contacts à visiter ; le premier est le contact de départ. Si le
+      *        dernier est égal au premier, l'itinéraire est une boucle.
+      * \param erreur reçoit la description de l'erreur le cas échéant.
+      * \return le numéro de l'itinéraire, -1 s'il n'existe pas.
+      */
+    int calculer(const QMap<int, Voie*> &voies, const QMap<int, Contact*> &contacts, const QVector<int> &etapes, QString &erreur);
+
+    /** retourne un itinéraire calculé.
+      * \param numero le numéro de l'itinéraire.
+      * \param itineraire reçoit l'itinéraire.
+      * \return faux si le numéro n'est pas valide.
+      */
+    bool getItineraire(int numero, Itineraire &itineraire) const;
+
+    /** oublie tous les itinéraires, avant le chargement d'une nouvelle maquette.
+      */
+    void vider();
+
+private:
+    //! sortie d'une voie : la voie et l'ordre de l'extrémité par laquelle on la quitte.
+    typedef QPair<Voie*, int> Sortie;
+
+    /** cherche le chemin le plus court menant à une voie, depuis des sorties possibles.
+      * \param departs les sorties par lesquelles le chemin peut commencer.
+      * \param arrivee la voie à atteindre.
+      * \param chemin reçoit les sorties successives du chemin, de la première à celle menant à l'arrivée.
+      * \return faux si l'arrivée n'est pas accessible.
+      */
+    static bool chercherChemin(const QVector<Sortie> &departs, Voie* arrivee, QVector<Sortie> &chemin);
+
+    /** retourne les sorties possibles d'une voie pour une extrémité d'entrée, tous états confondus.
+      * \param v la voie.
+      * \param ordreEntree l'ordre de l'extrémité d'entrée.
+      * \return les ordres des extrémités de sortie.
+      */
+    static QVector<int> sortiesPossibles(Voie* v, int ordreEntree);
+
+    mutable QMutex mutex;
+    QVector<Itineraire> itineraires;
+    QHash<QVector<int>, int> index;
+};
+
+#endif // ITINERAIRES_H
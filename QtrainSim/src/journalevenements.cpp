@@ -0,0 +1,61 @@
+#include <QDateTime>
+#include <QMutexLocker>
+
+#include "journalevenements.h"
+
+JournalEvenements::JournalEvenements()
+{
+    ouvert = false;
+}
+
+JournalEvenements::~JournalEvenements()
+{
+    fermer();
+}
+
+JournalEvenements* JournalEvenements::getInstance()
+{
+    static JournalEvenements instance;
+    return &instance;
+}
+
+bool JournalEvenements::ouvrir(const QString &nomFichier)
+{
+    fichier.setFileName(nomFichier);
+    if(!fichier.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+
+    flux.setDevice(&fichier);
+    flux.setVersion(QDataStream::Qt_5_0);
+    flux.setByteOrder(QDataStream::LittleEndian);
+    if(fichier.size() == 0)
+        flux << MAGIE << VERSION;
+
+    horloge.start();
+    ouvert = true;
+
+    quint32 debut = (quint32) (QDateTime::currentMSecsSinceEpoch() / 1000);
+    enregistrer(DEBUT, -1, (qint16) (debut >> 16), (qint16) (debut & 0xFFFF));
+    return true;
+}
+
+void JournalEvenements::enregistrer(Type type, int numLoco, int objet, int valeur)
+{
+    if(!ouvert)
+        return;
+
+    QMutexLocker verrou(&mutex);
+    if(!ouvert)
+        return;
+    flux << (qint64) horloge.nsecsElapsed() << (quint8) type
+         << (qint16) numLoco << (qint16) objet << (qint16) valeur;
+}
+
+void JournalEvenements::fermer()
+{
+    QMutexLocker verrou(&mutex);
+    if(!ouvert)
+        return;
+    ouvert = false;
+    fichier.close();
+}
@@ -0,0 +1,92 @@
+#ifndef JOURNALEVENEMENTS_H
+#define JOURNALEVENEMENTS_H
+
+#include <atomic>
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+
+/**
+  Journal binaire des événements d'une simulation, destiné à l'analyse après coup
+  (débit, attentes et occupation des sections partagées) par l'outil lireevenements.
+
+  Le fichier commence par MAGIE et VERSION, puis chaque exécution y ajoute ses
+  événements à la suite : un événement DEBUT, puis des enregistrements de taille fixe
+  (TAILLE_EVENEMENT octets, petit-boutiste) :
+    qint64 instant : nanosecondes écoulées depuis le DEBUT de l'exécution (horloge monotone) ;
+    quint8 type    : Type ;
+    qint16 loco    : numéro de la loco concernée, -1 si aucune ;
+    qint16 objet   : contact, aiguillage (AIGUILLAGE, DERAILLEMENT), section, autre loco
+                     (COLLISION), ou 1 pour une VITESSE progressive ;
+    qint16 valeur  : vitesse, direction, point d'entrée (SECTION_DEMANDE), sinon 0.
+  Les commandes (VITESSE, AIGUILLAGE) sont datées de leur application par le moteur ;
+  celles des aiguillages ne portent pas de loco.
+  L'événement DEBUT porte dans objet et valeur les 32 bits de l'heure de début, en
+  secondes depuis 1970 (objet : poids forts).
+
+  enregistrer peut être appelée par n'importe quel thread.
+
+  Les événements des sections partagées proviennent des programmes clients, par
+  journaliser_section. Sur la maquette réelle, libmarklin n'a pas de journal :
+  journaliser_section y est sans effet et aucun événement n'est enregistré.
+  */
+class JournalEvenements
+{
+public:
+    //! "QTEV" : identifie un journal d'événements.
+    static const quint32 MAGIE = 0x51544556;
+    static const quint16 VERSION = 1;
+    static const int TAILLE_EVENEMENT = 15;
+
+    enum Type
+    {
+        DEBUT = 0,
+        CONTACT = 1,
+        VITESSE = 2,
+        AIGUILLAGE = 3,
+        SECTION_DEMANDE = 4,
+        SECTION_ATTENTE = 5,
+        SECTION_ACCES = 6,
+        SECTION_SORTIE = 7,
+        COLLISION = 8,
+        DERAILLEMENT = 9
+    };
+
+    static JournalEvenements* getInstance();
+
+    /** ouvre le journal en ajout, l'entête n'étant écrite que si le fichier est vide,
+      * et y enregistre le début de l'exécution. À appeler avant le lancement des threads.
+      * \param nomFichier le nom du fichier.
+      * \return vrai si le fichier a pu être ouvert.
+      */
+    bool ouvrir(const QString &nomFichier);
+
+    /** enregistre un événement. Sans effet si le journal n'est pas ouvert.
+      * \param type le type de l'événement.
+      * \param numLoco le numéro de la loco, -1 si aucune.
+      * \param objet l'objet de l'événement.
+      * \param valeur la valeur associée.
+      */
+    void enregistrer(Type type, int numLoco, int objet, int valeur = 0);
+
+    /** ferme le journal.
+      */
+    void fermer();
+
+protected:
+    JournalEvenements();
+    ~JournalEvenements();
+
+private:
+    QMutex mutex;
+    QFile fichier;
+    QDataStream flux;
+    QElapsedTimer horloge;
+    //! consulté sans le mutex par tous les threads, remis à faux par fermer.
+    std::atomic<bool> ouvert;
+};
+
+#endif // JOURNALEVENEMENTS_H
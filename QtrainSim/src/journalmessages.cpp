@@ -0,0 +1,113 @@
+#include <QMutexLocker>
+
+#include "journalmessages.h"
+
+JournalMessages::JournalMessages()
+{
+    anneau.resize(CAPACITE_JOURNAL);
+    debut = 0;
+    nbre = 0;
+    nbrePerdues = 0;
+    horloge.start();
+}
+
+JournalMessages* JournalMessages::getInstance()
+{
+    static JournalMessages instance;
+    return &instance;
+}
+
+void JournalMessages::ajouter(int source, const QString &texte)
+{
+    QMutexLocker verrou(&mutex);
+    if(autoriser(source))
+        empiler(source, texte);
+}
+
+void JournalMessages::ecrire(const char *texte, qint64 taille)
+{
+    QMutexLocker verrou(&mutex);
+    ligneEnCours.append(texte, taille);
+
+    int fin;
+    while((fin = ligneEnCours.indexOf('\n')) >= 0)
+    {
+        if(autoriser(SOURCE_GENERALE))
+            empiler(SOURCE_GENERALE, QString::fromLocal8Bit(ligneEnCours.constData(), fin));
+        ligneEnCours.remove(0, fin + 1);
+    }
+}
+
+void JournalMessages::extraire(QVector<LigneJournal> &lignes)
+{
+    QMutexLocker verrou(&mutex);
+
+    lignes.clear();
+    lignes.reserve(nbre);
+    for(int i = 0; i < nbre; i++)
+    {
+        LigneJournal &l = anneau[(debut + i) % CAPACITE_JOURNAL];
+        lignes.append(l);
+        l.texte.clear();
+    }
+    debut = 0;
+    nbre = 0;
+
+    QMutableMapIterator<int, Debit> i(debits);
+    while(i.hasNext())
+    {
+        i.next();
+        if(i.value().ignorees > 0)
+        {
+            LigneJournal l = {i.key(), QString("... %1 messages ignorés (plus de %2 par seconde)")
+                              .arg(i.value().ignorees).arg(DEBIT_JOURNAL)};
+            lignes.append(l);
+            i.value().ignorees = 0;
+        }
+    }
+
+    if(nbrePerdues > 0)
+    {
+        LigneJournal l = {SOURCE_GENERALE, QString("... %1 messages perdus, journal plein").arg(nbrePerdues)};
+        lignes.append(l);
+        nbrePerdues = 0;
+    }
+}
+
+bool JournalMessages::autoriser(int source)
+{
+    qint64 maintenant = horloge.elapsed();
+
+    if(!debits.contains(source))
+    {
+        Debit d = {RAFALE_JOURNAL, maintenant, 0};
+        debits.insert(source, d);
+    }
+
+    Debit &d = debits[source];
+    d.jetons = qMin((qreal) RAFALE_JOURNAL, d.jetons + (maintenant - d.dernier) * DEBIT_JOURNAL / 1000.0);
+    d.dernier = maintenant;
+
+    if(d.jetons < 1.0)
+    {
+        d.ignorees++;
+        return false;
+    }
+    d.jetons -= 1.0;
+    return true;
+}
+
+void JournalMessages::empiler(int source, const QString &texte)
+{
+    if(nbre == CAPACITE_JOURNAL)
+    {
+        debut = (debut + 1) % CAPACITE_JOURNAL;
+        nbre--;
+        nbrePerdues++;
+    }
+
+    LigneJournal &l = anneau[(debut + nbre) % CAPACITE_JOURNAL];
+    l.source = source;
+    l.texte = texte;
+    nbre++;
+}
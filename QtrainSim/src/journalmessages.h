@@ -0,0 +1,94 @@
+#ifndef JOURNALMESSAGES_H
+#define JOURNALMESSAGES_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "general.h"
+
+/**
+  Ligne du journal des messages, avec sa source.
+  */
+struct LigneJournal
+{
+    //! numéro de la loco, ou JournalMessages::SOURCE_GENERALE.
+    int source;
+    QString texte;
+};
+
+/**
+  Journal des messages affichés par les programmes clients (afficher_message,
+  afficher_message_loco, sortie standard redirigée).
+  Les threads clients déposent leurs lignes dans un anneau de taille fixe, sans attendre
+  l'affichage ; l'interface les retire par lots, au plus une fois par trame. Chaque source
+  est limitée à DEBIT_JOURNAL lignes par seconde : les lignes en excès sont ignorées et
+  seul leur nombre est signalé. Lorsque l'anneau est plein, les plus anciennes lignes
+  sont perdues.
+  */
+class JournalMessages
+{
+public:
+    //! source des messages de la console générale.
+    static const int SOURCE_GENERALE = -1;
+
+    static JournalMessages* getInstance();
+
+    /** ajoute une ligne au journal. Peut être appelée par n'importe quel thread.
+      * \param source le numéro de la loco, ou SOURCE_GENERALE.
+      * \param texte la ligne.
+      */
+    void ajouter(int source, const QString &texte);
+
+    /** ajoute au journal le texte écrit sur la sortie standard. Les lignes complètes
+      * sont ajoutées à la console générale, la dernière ligne est conservée jusqu'à son
+      * retour à la ligne.
+      * \param texte le texte écrit.
+      * \param taille le nombre de caractères écrits.
+      */
+    void ecrire(const char *texte, qint64 taille);
+
+    /** retire toutes les lignes du journal, dans l'ordre de leur dépôt, suivies du
+      * nombre de lignes ignorées ou perdues depuis le dernier retrait.
+      * \param lignes reçoit les lignes.
+      */
+    void extraire(QVector<LigneJournal> &lignes);
+
+protected:
+    JournalMessages();
+
+private:
+    /** débit d'une source : seau à jetons, rempli de DEBIT_JOURNAL jetons par seconde
+      * jusqu'à RAFALE_JOURNAL.
+      */
+    struct Debit
+    {
+        qreal jetons;
+        qint64 dernier;
+        int ignorees;
+    };
+
+    /** consomme un jeton de la source. Le mutex doit être pris.
+      * \return faux si la source a dépassé son débit : la ligne est ignorée.
+      */
+    bool autoriser(int source);
+
+    /** dépose une ligne dans l'anneau. Le mutex doit être pris.
+      */
+    void empiler(int source, const QString &texte);
+
+    QMutex mutex;
+    QVector<LigneJournal> anneau;
+    int debut;
+    int nbre;
+    int nbrePerdues;
+    QMap<int, Debit> debits;
+    QElapsedTimer horloge;
+    //! texte écrit sur la sortie standard depuis le dernier retour à la ligne.
+    QByteArray ligneEnCours;
+};
+
+#endif // JOURNALMESSAGES_H
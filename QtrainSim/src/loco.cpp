@@ -1,5 +1,8 @@
 #include "loco.h"
+#include "voievariable.h"
 #include "trainsimsettings.h"
+#include "journalevenements.h"
+#include "journalmessages.h"
 
 panneauNumLoco::panneauNumLoco(int numLoco, QObject *parent) :
     QObject(parent)
@@ -24,7 +27,8 @@ void panneauNumLoco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
     QString t;
     t.setNum(numLoco);
 
-    painter->setFont(QFont("Verdana", 22, 99));
+    static const QFont fonte("Verdana", 22, 99);
+    painter->setFont(fonte);
 
     painter->drawText(QRectF(-LARGEUR_LOCO * 0.45, - LARGEUR_LOCO * 0.45, LARGEUR_LOCO * 0.9, LARGEUR_LOCO * 0.9), t, QTextOption(Qt::AlignHCenter | Qt::AlignVCenter));
 }
@@ -50,16 +54,24 @@ Loco::Loco(int numLoco, QObject *parent) :
     this->vitesseFuture = 0;
     this->active = true;
     this->direction = DIRECTION_LOCO_GAUCHE;
-    this->angleCumule = 0.0;
     this->alerteProximite = false;
     this->inverser = false;
     this->deraille = false;
-    this->timer = new QTimer(this);
+    this->numero = numLoco;
+    this->orientation = 0.0;
+    this->inertieEnCours = false;
+    this->tempsInertie = 0.0;
+    this->voieActuelle = nullptr;
+    this->voieSuivante = nullptr;
+    this->ordreEntree = 0;
+    this->ordreSortie = -1;
+    this->abscisse = 0.0;
+    this->longueurParcours = 0.0;
+    this->segmentActuel = nullptr;
+    this->controller = nullptr;
     this->mutex = new QMutex();
     this->VarCond = new QWaitCondition();
     setZValue(ZVAL_LOCO);
-
-    CONNECT(timer, SIGNAL(timeout()), this, SLOT(adapterVitesse()));
 }
 
 void Loco::setVitesse(int v)
@@ -67,7 +79,8 @@ void Loco::setVitesse(int v)
     if(TrainSimSettings::getInstance()->getInertie())
     {
         this->vitesseFuture = v;
-        this->timer->start(INERTIE_LOCO);
+        this->inertieEnCours = true;
+        this->tempsInertie = 0.0;
     }
     else
     {
@@ -82,7 +95,10 @@ int Loco::getVitesse()
 
 void Loco::setDirection(int d)
 {
+    if(d == direction)
+        return;
     this->direction = d;
+    update();
 }
 
 int Loco::getDirection()
@@ -93,6 +109,7 @@ int Loco::getDirection()
 void Loco::setCouleur(int r, int g, int b)
 {
     couleur = QColor(r,g,b);
+    update();
 }
 
 QColor Loco::getCouleur()
@@ -102,10 +119,14 @@ QColor Loco::getCouleur()
 
 QRectF Loco::boundingRect() const
 {
+    //les feux dépassent de LONGUEUR_FEUX à l'avant, sans déborder de la largeur de la loco ;
+    //seuls les cercles de l'alerte de proximité s'étendent au-delà.
+    qreal demiHauteur = alerteProximite ? LONGUEUR_LOCO / 2.0 : LARGEUR_LOCO / 2.0;
+
     return QRectF(- (LONGUEUR_LOCO / 2.0 + LONGUEUR_FEUX),
-                  - (LONGUEUR_LOCO / 2.0 + LONGUEUR_FEUX),
+                  - demiHauteur,
                   LONGUEUR_LOCO + 2.0 * LONGUEUR_FEUX,
-                  LONGUEUR_LOCO + 2.0 * LONGUEUR_FEUX);
+                  2.0 * demiHauteur).adjusted(-1.0, -1.0, 1.0, 1.0);
 }
 
 void Loco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
@@ -163,7 +184,11 @@ void Loco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/,
 
 void Loco::setVoie(Voie *v)
 {
+    if(this->voieActuelle != nullptr)
+        this->voieActuelle->sortieLoco();
     this->voieActuelle = v;
+    if(this->voieActuelle != nullptr)
+        this->voieActuelle->entreeLoco();
 }
 
 Voie* Loco::getVoie()
@@ -171,9 +196,28 @@ Voie* Loco::getVoie()
     return this->voieActuelle;
 }
 
-void Loco::setVoieSuivante(Voie *v)
+void Loco::placer(Voie *v, Voie *vers)
 {
-    this->voieSuivante = v;
+    setVoie(v);
+
+    ordreSortie = v->ordreDe(vers);
+
+    //on cherche l'extrémité depuis laquelle la voie mène vers la sortie demandée.
+    ordreEntree = (ordreSortie + 1) % v->getNbreLiaisons();
+    for(int i = 0; i < v->getNbreLiaisons(); i++)
+    {
+        if(i != ordreSortie && v->getOrdreSuivant(i) == ordreSortie)
+        {
+            ordreEntree = i;
+            break;
+        }
+    }
+
+    voieSuivante = vers;
+    longueurParcours = v->getLongueurParcours(ordreEntree, ordreSortie);
+    abscisse = (ordreSortie == 0) ? longueurParcours : 0.0;
+
+    majPose();
 }
 
 Voie* Loco::getVoieSuivante()
@@ -191,20 +235,16 @@ bool Loco::getActive()
     return active;
 }
 
-#include <iostream>
-#include "mainwindow.h"
-
 void Loco::avanceDUneVoie()
 {
     Voie* viensDe = voieActuelle;
 
-    voieActuelle = voieSuivante;
-
-    voieSuivante = voieActuelle->getVoieSuivante(viensDe);
-
-    setPos(voieActuelle->getPosAbsLiaison(viensDe));
+    setVoie(voieSuivante);
 
-    corrigerAngle(voieActuelle->getNouvelAngle(viensDe));
+    ordreEntree = voieActuelle->ordreDe(viensDe);
+    ordreSortie = voieActuelle->getOrdreSuivant(ordreEntree);
+    voieSuivante = ordreSortie < 0 ? nullptr : voieActuelle->getVoieVoisineDOrdre(ordreSortie);
+    longueurParcours = voieActuelle->getLongueurParcours(ordreEntree, ordreSortie);
 
     if(voieActuelle->getContact() != nullptr)
     {
@@ -212,85 +252,63 @@ void Loco::avanceDUneVoie()
         Contact* ctc2 = nullptr;
         viensDe = voieActuelle;
         Voie* v1 = voieSuivante;
-        Voie* v2 = v1->getVoieSuivante(viensDe);
 
-        while (ctc2 == nullptr)
+        while (ctc2 == nullptr && v1 != nullptr)
         {
             ctc2 = v1->getContact();
+            Voie* v2 = v1->getVoieSuivante(viensDe);
             viensDe = v1;
             v1 = v2;
-            v2 = v1->getVoieSuivante(viensDe);
         }
 
-        nouveauSegment(ctc1, ctc2, this);
+        if(ctc2 != nullptr)
+            nouveauSegment(ctc1, ctc2, this);
 
-        voieActuelle->getContact()->active(); //pas ideal... A revoir.
+        voieActuelle->getContact()->active(numero);
+        //la ligne passe par le journal : limitée en débit, et affichée par lots dans la
+        //console de la loco, ou sur la sortie standard sans affichage.
         if (TrainSimSettings::getInstance()->getViewLocoLog())
-        {
-            this->controller->console->append(QString("# Passe le contact numéro %1").arg(voieActuelle->getContact()->getNumContact()));
-            std::cout << "Loco " << this->numLoco1->getNumLoco() << " : Passe le contact " << voieActuelle->getContact()->getNumContact() << std::endl;
-        }
+            JournalMessages::getInstance()->ajouter(numero, QString("# Passe le contact numéro %1").arg(voieActuelle->getContact()->getNumContact()));
     }
 }
 
 void Loco::avancer(qreal distance)
 {
-    qreal dist = distance;
-    qreal angle = 0.0;
-    qreal rayon = 0.0;
+    abscisse += distance;
 
-    while(true)
+    while(abscisse >= longueurParcours && ordreSortie >= 0)
     {
-        this->voieActuelle->avanceLoco(dist, angle, rayon, this->angleCumule, this->pos(), this->voieSuivante);
-
-        if(rayon == 0.0)
-        {
-            avancerDroit(distance - dist);
-        }
-        else
-        {
-            avancerCourbe(-angle, rayon);
-            angleCumule += angle;
-            if(angleCumule < 0.0)
-                angleCumule += 360.0;
-            if(angleCumule > 360.0)
-                angleCumule -= 360.0;
-        }
-
-        if(dist == 0.0)
-        {
-            break;
-        }
+        abscisse -= longueurParcours;
         avanceDUneVoie();
     }
-}
 
-void Loco::avancerDroit(qreal distance)
-{
-    qreal x =  distance * cos(angleCumule * (PI / 180.0));
-    qreal y = -distance * sin(angleCumule * (PI / 180.0));
-    voieActuelle->correctionPositionLoco(x, y);
-    moveBy(x,y);
+    //au fond d'une impasse, la loco reste immobile.
+    if(abscisse > longueurParcours)
+        abscisse = longueurParcours;
 
+    majPose();
 }
 
-void Loco::avancerCourbe(qreal angle, qreal rayon)
+void Loco::majPose()
 {
-    qreal angleAbs = angle < 0.0 ? -angle : angle;
-    qreal dist = rayon * tan(angleAbs * PI / 360.0);
-    avancerDroit(dist);
-    setRotation(rotation() + angle);
-    avancerDroit(dist);
+    qreal cap;
+    voieActuelle->getPoseParcours(ordreEntree, ordreSortie, abscisse, position, cap);
+    setOrientation(deraille ? cap + 20.0 : cap);
 }
 
-void Loco::setAngleCumule(qreal a)
+void Loco::demiTour()
 {
-    this->angleCumule = a;
-}
+    if(voieActuelle == nullptr)
+        return;
 
-qreal Loco::getAngleCumule()
-{
-    return this->angleCumule;
+    int temp = ordreEntree;
+    ordreEntree = ordreSortie;
+    ordreSortie = temp;
+    voieSuivante = ordreSortie < 0 ? nullptr : voieActuelle->getVoieVoisineDOrdre(ordreSortie);
+    longueurParcours = voieActuelle->getLongueurParcours(ordreEntree, ordreSortie);
+    abscisse = longueurParcours - abscisse;
+
+    majPose();
 }
 
 void Loco::setSegmentActuel(Segment *s)
@@ -298,8 +316,16 @@ void Loco::setSegmentActuel(Segment *s)
     this->segmentActuel = s;
 }
 
+Segment* Loco::getSegmentActuel() const
+{
+    return this->segmentActuel;
+}
+
 void Loco::setAlerteProximite(bool b)
 {
+    if(b == alerteProximite)
+        return;
+    prepareGeometryChange();
     this->alerteProximite = b;
 }
 
@@ -310,7 +336,77 @@ bool Loco::getAlerteProximite()
 
 QPolygonF Loco::getContour()
 {
-    return mapToScene(QRectF(-LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0, LONGUEUR_LOCO, LARGEUR_LOCO));
+    QPolygonF contour;
+    contour << versScene(QPointF(-LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0))
+            << versScene(QPointF( LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0))
+            << versScene(QPointF( LONGUEUR_LOCO / 2.0,  LARGEUR_LOCO / 2.0))
+            << versScene(QPointF(-LONGUEUR_LOCO / 2.0,  LARGEUR_LOCO / 2.0))
+            << versScene(QPointF(-LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0));
+    return contour;
+}
+
+RectangleOriente Loco::getRectangle() const
+{
+    RectangleOriente r;
+    qreal a = orientation * PI / 180.0;
+    r.centre = position;
+    r.ux = cos(a);
+    r.uy = sin(a);
+    r.demiLongueur = LONGUEUR_LOCO / 2.0;
+    r.demiLargeur = LARGEUR_LOCO / 2.0;
+    return r;
+}
+
+QPointF Loco::getPosition() const
+{
+    return this->position;
+}
+
+void Loco::setPosition(const QPointF &p)
+{
+    this->position = p;
+}
+
+qreal Loco::getOrientation() const
+{
+    return this->orientation;
+}
+
+void Loco::setOrientation(qreal o)
+{
+    this->orientation = o;
+}
+
+void Loco::deplacer(qreal dx, qreal dy)
+{
+    this->position += QPointF(dx, dy);
+}
+
+QPointF Loco::versScene(const QPointF &p) const
+{
+    //même transformation que QGraphicsItem : rotation puis translation.
+    qreal a = orientation * PI / 180.0;
+    return QPointF(position.x() + p.x() * cos(a) - p.y() * sin(a),
+                   position.y() + p.x() * sin(a) + p.y() * cos(a));
+}
+
+void Loco::avancerInertie(qreal dureeMs)
+{
+    if(!inertieEnCours)
+        return;
+
+    tempsInertie += dureeMs;
+
+    while(inertieEnCours && tempsInertie >= INERTIE_LOCO)
+    {
+        tempsInertie -= INERTIE_LOCO;
+        adapterVitesse();
+    }
+}
+
+int Loco::getNumLoco()
+{
+    return this->numero;
 }
 
 void Loco::inverserSens()
@@ -318,29 +414,15 @@ void Loco::inverserSens()
     if(TrainSimSettings::getInstance()->getInertie())
     {
         inverser = true;
-        this->timer->start(INERTIE_LOCO);
+        this->inertieEnCours = true;
+        this->tempsInertie = 0.0;
     }
     else
     {
-        this->setRotation(this->rotation() + 180.0);
-        Voie* viensDe = voieSuivante;
-        voieSuivante = voieActuelle->getVoieSuivante(viensDe);
-        this->angleCumule -= 180.0;
+        demiTour();
     }
 }
 
-void Loco::corrigerAngle(qreal nouvelAngle)
-{
-    QPointF avantLoco = mapToScene(LONGUEUR_LOCO / 2.0, 0.0);
-    qreal angleReel = atan2(- avantLoco.y() + pos().y(), avantLoco.x() - pos().x()) * 180.0 / PI;
-
-    setRotation(rotation() + angleReel);
-
-    setRotation( rotation() - nouvelAngle);
-
-    this->angleCumule = nouvelAngle;
-}
-
 void Loco::locoSurSegment(Segment *s)
 {
     if(s == segmentActuel)
@@ -354,9 +436,11 @@ void Loco::voieVariableModifiee(Voie *v)
 {
     if(v == voieActuelle)
     {
+        JournalEvenements::getInstance()->enregistrer(JournalEvenements::DERAILLEMENT, numero,
+                                                      static_cast<VoieVariable*>(v)->getNumVoieVariable());
         deraille = true;
         vitesse = vitesseFuture = 0;
-        setRotation(rotation()+20.0);
+        setOrientation(orientation + 20.0);
     }
 }
 
@@ -368,10 +452,7 @@ void Loco::adapterVitesse()
             vitesse--;
         if(vitesse ==0)
         {
-            this->setRotation(rotation()+180.0);
-            Voie* viensDe = voieSuivante;
-            voieSuivante = voieActuelle->getVoieSuivante(viensDe);
-            this->angleCumule -= 180.0;
+            demiTour();
             inverser = false;
         }
     }
@@ -382,6 +463,6 @@ void Loco::adapterVitesse()
         else if(vitesse - vitesseFuture > 0)
             vitesse--;
         else
-            timer->stop();
+            inertieEnCours = false;
     }
 }
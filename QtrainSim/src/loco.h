@@ -5,12 +5,12 @@
 #include <QAbstractGraphicsShapeItem>
 #include <QStaticText>
 #include <QPainter>
-#include <QTimer>
 
 #include "general.h"
 #include "voie.h"
 #include "segment.h"
 #include "connect.h"
+#include "collision.h"
 
 class panneauNumLoco : public QObject, public QAbstractGraphicsShapeItem
 {
@@ -107,10 +107,12 @@ public:
       */
     Voie* getVoie();
 
-    /** permet d'indiquer la voie vers laquelle la loco est dirigée.
-      * \param v la voie vers laquelle la loco est dirigée.
+    /** pose la loco sur une voie, dirigée vers une voie voisine.
+      * La loco est placée sur l'extrémité d'ordre 0 de la voie.
+      * \param v la voie sur laquelle poser la loco.
+      * \param vers la voie voisine vers laquelle la loco est dirigée.
       */
-    void setVoieSuivante(Voie* v);
+    void placer(Voie* v, Voie* vers);
 
     /** retourne la voie vers laquelle la loco est dirigée.
       * \return la voie vers laquelle la loco est dirigée.
@@ -127,7 +129,7 @@ public:
       */
     bool getActive();
 
-    /** effectue la transition d'une voie à l'autre et repositionne la loco (corrige les imprécisions de calcul).
+    /** effectue la transition d'une voie à l'autre, en choisissant le parcours à suivre sur la nouvelle voie.
       *
       */
     void avanceDUneVoie();
@@ -137,32 +139,16 @@ public:
       */
     void avancer(qreal distance);
 
-    /** avance la loco le long d'une droite, d'une distance determinee.
-      * \param distance la distance de laquelle il faut faire avancer la loco.
-      */
-    void avancerDroit(qreal distance);
-
-    /** avance la loco selon une courbe, définie par un angle et un rayon.
-      * \param angle l'angle de rotation
-      * \param rayon le rayon de rotation
-      */
-    void avancerCourbe(qreal angle, qreal rayon);
-
-    /** permet de mettre à jour l'angle cumule
-      * \param a la nouvelle valeur de l'angle cumule
-      */
-    void setAngleCumule(qreal a);
-
-    /** retourne l'angle cumule
-      * \return l'angle cumule
-      */
-    qreal getAngleCumule();
-
     /** permet d'indiquer sur quel segment la loco se trouve
       * \param s le segment sur lequel la loco se trouve
       */
     void setSegmentActuel(Segment* s);
 
+    /** retourne le dernier segment sur lequel la loco a été signalée.
+      * \return le segment, nullptr si la loco n'a pas encore été placée.
+      */
+    Segment* getSegmentActuel() const;
+
     /** permet de changer la valeur booléenne d'alerte de proximité.
       * \param b la nouvelle valeur booléenne d'alerte de proximité.
       */
@@ -178,6 +164,55 @@ public:
       */
     QPolygonF getContour();
 
+    /** retourne l'emprise de la loco sous forme de rectangle orienté, en coordonnées de la scene.
+      * \return le rectangle orienté occupé par la loco.
+      */
+    RectangleOriente getRectangle() const;
+
+    /** retourne la position de la loco, en coordonnées de la scene.
+      * Cette position est celle de la simulation, indépendante de l'affichage.
+      * \return la position de la loco.
+      */
+    QPointF getPosition() const;
+
+    /** permet de placer la loco.
+      * \param p la nouvelle position, en coordonnées de la scene.
+      */
+    void setPosition(const QPointF &p);
+
+    /** retourne l'orientation de la loco, en degrés (même convention que QGraphicsItem::rotation()).
+      * \return l'orientation de la loco.
+      */
+    qreal getOrientation() const;
+
+    /** permet de changer l'orientation de la loco.
+      * \param o la nouvelle orientation en degrés.
+      */
+    void setOrientation(qreal o);
+
+    /** déplace la loco d'un vecteur donné.
+      * \param dx le déplacement en X
+      * \param dy le déplacement en Y
+      */
+    void deplacer(qreal dx, qreal dy);
+
+    /** convertit un point exprimé dans le repère de la loco en coordonnées de la scene,
+      * sans passer par l'élément graphique.
+      * \param p le point dans le repère de la loco.
+      * \return le point en coordonnées de la scene.
+      */
+    QPointF versScene(const QPointF &p) const;
+
+    /** Fait progresser l'inertie de la loco d'une certaine durée simulée.
+      * \param dureeMs la durée simulée écoulée, en millisecondes.
+      */
+    void avancerInertie(qreal dureeMs);
+
+    /** retourne le numéro de la loco.
+      * \return le numéro de la loco.
+      */
+    int getNumLoco();
+
     /** Inverse le sens de la loco en conservant ou retrouvant la vitesse initiale.
       * Le comportement dépend de l'option "Inertie" :
       * avec l'inertie, le changement sera progressif.
@@ -185,11 +220,6 @@ public:
       */
     void inverserSens();
 
-    /** Permet de corriger l'angle de la loco suite à des imprécisions de calcul.
-      * \param nouvelAngle le nouvel angle.
-      */
-    void corrigerAngle(qreal nouvelAngle);
-
     LocoCtrl *controller;
 signals:
 
@@ -216,13 +246,21 @@ public slots:
       */
     void voieVariableModifiee(Voie* v);
 
-    /** Reçoit le signal qu'il faut adapter la vitesse d'un incrément / décrément.
+private:
+    /** Adapte la vitesse d'un incrément / décrément (inertie).
       */
     void adapterVitesse();
-private:
+
+    /** fait repartir la loco en sens inverse sur son parcours actuel.
+      */
+    void demiTour();
+
+    /** recalcule la position et l'orientation de la loco à partir de son parcours et de son abscisse.
+      */
+    void majPose();
+
     panneauNumLoco* numLoco1;
     panneauNumLoco* numLoco2;
-    qreal angleCumule;
     bool active;
     int vitesse;
     int vitesseFuture;
@@ -230,11 +268,19 @@ private:
     QColor couleur;
     Voie* voieActuelle;
     Voie* voieSuivante;
+    int ordreEntree;
+    int ordreSortie;
+    qreal abscisse;
+    qreal longueurParcours;
     Segment* segmentActuel;
     bool alerteProximite;
     bool inverser;
     bool deraille;
-    QTimer* timer;
+    int numero;
+    QPointF position;
+    qreal orientation;
+    bool inertieEnCours;
+    qreal tempsInertie;
     QWaitCondition* VarCond;
     QMutex* mutex;
 };
@@ -12,12 +12,45 @@ using namespace std;
 
 //Header for CommandeTrain
 #include "commandetrain.h"
+#include "trainsimsettings.h"
 
 /**
  * Programme principal
  */
 int main(int argc, char *argv[])
 {
+    /* Options de la ligne de commande :
+     *  --sans-rendu : simulation sans fenêtre, aussi vite que possible.
+     *  --duree N    : arrête la simulation après N secondes de temps simulé.
+     *  --temps-reel : limite la simulation sans rendu au rythme du temps réel.
+     *  --enregistrer F : enregistre la simulation dans la trace F.
+     *  --rejouer F  : rejoue la trace F sans rendu, aussi vite que possible.
+     *  --evenements F : ajoute les événements de la simulation au journal binaire F.
+     */
+    TrainSimSettings* settings = TrainSimSettings::getInstance();
+    for(int i = 1; i < argc; i++)
+    {
+        QString option(argv[i]);
+        if(option == "--sans-rendu")
+            settings->setSansRendu(true);
+        else if(option == "--temps-reel")
+            settings->setTempsReel(true);
+        else if(option == "--duree" && i + 1 < argc)
+            settings->setDureeSimulation(QString(argv[++i]).toDouble());
+        else if(option == "--enregistrer" && i + 1 < argc)
+            settings->setFichierEnregistrement(QString(argv[++i]));
+        else if(option == "--evenements" && i + 1 < argc)
+            settings->setFichierEvenements(QString(argv[++i]));
+        else if(option == "--rejouer" && i + 1 < argc)
+        {
+            settings->setFichierRejeu(QString(argv[++i]));
+            settings->setSansRendu(true);
+        }
+    }
+
+    //sans rendu, aucune fenêtre n'est créée : pas besoin de serveur d'affichage.
+    if(settings->getSansRendu())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
 
     QApplication app(argc,argv);
 
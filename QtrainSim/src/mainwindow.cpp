@@ -10,38 +10,53 @@
 #include <QDockWidget>
 #include <QCloseEvent>
 #include <QLineEdit>
+#include <QScrollBar>
+#include <QTextCursor>
 
 #include "commandetrain.h"
 #include "mainwindow.h"
 #include "trainsimsettings.h"
-#include "maquettemanager.h"
 
- void outcallback( const char* ptr, std::streamsize count, void* pTextBox )
+ void outcallback( const char* ptr, std::streamsize count, void* pJournal )
  {
-   (void) count;
-   static QString to;
-   static QString towrite;
-   for(int i=0;i<count;i++)
-   {
-       if (ptr[i]=='\n')
-       {
-           QTextEdit* p = static_cast< QTextEdit* >( pTextBox );
-           p->append( towrite );
-           towrite.clear();
-       }
-       else
-           towrite+=ptr[i];
-   }
+   //std::cout peut être utilisé par les threads clients : le texte passe par le journal.
+   static_cast< JournalMessages* >( pJournal )->ecrire( ptr, count );
  }
 
+/** ajoute des lignes à la fin d'une console en une seule modification du document.
+  * La console ne défile que si elle était déjà en bas.
+  */
+static void ajouterLignes(QTextEdit *console, const QStringList &lignes)
+{
+    QScrollBar *barre = console->verticalScrollBar();
+    bool enBas = barre->value() == barre->maximum();
+
+    QTextCursor curseur(console->document());
+    curseur.movePosition(QTextCursor::End);
+    curseur.beginEditBlock();
+    foreach(const QString &l, lignes)
+    {
+        if(!console->document()->isEmpty())
+            curseur.insertBlock();
+        curseur.insertText(l);
+    }
+    curseur.endEditBlock();
+
+    if(enBas)
+        barre->setValue(barre->maximum());
+}
+
 #include <QMessageBox>
 
 
 
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow(SimEngine *engine, QWidget *parent) :
     QMainWindow(parent)
 {
+    simEngine = engine;
+
     generalConsole = new QTextEdit(this);
+    generalConsole->document()->setMaximumBlockCount(LIGNES_MAX_CONSOLE);
     dockGeneralConsole = new QDockWidget("Console generale",this);
     dockGeneralConsole->setWidget(generalConsole);
     addDockWidget(Qt::BottomDockWidgetArea,dockGeneralConsole,Qt::Horizontal);
@@ -54,74 +69,7 @@ MainWindow::MainWindow(QWidget *parent) :
     CommandeTrain* ct = CommandeTrain::getInstance();
     CONNECT(this, SIGNAL(commandSent(QString)), ct, SLOT(commandSent(QString)))
 
-    myRedirector = new StdRedirector<>( std::cout, outcallback, generalConsole );
-
-    //Lecture des informations des voies.
-    QFile fichierInfosVoies(DATADIR+"/infosVoies.txt");
-    if (!fichierInfosVoies.open(QIODevice::ReadOnly))
-    {
-        QMessageBox::critical(0,"Erreur",QString("Le fichier de description des voies ne peut être trouvé. Vérifiez qu'il est bien présent dans le répertoire parent de l'exécutable.\n Le nom du fichier est: %1.\nAvez-vous effectué un \"make install\"?").arg(fichierInfosVoies.fileName()));
-        exit(0);
-    }
-    QTextStream lecture(&fichierInfosVoies);
-
-    QString ligne;
-
-    QStringList ligneDecoupee;
-
-    QList<double>* description;
-
-    ligne = lecture.readLine();
-
-    while(!ligne.startsWith("EOF"))
-    {
-        ligneDecoupee = ligne.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-
-        description = new QList<double>();
-
-        /* En l'etat, le programme gere 6 types de voies differentes :
-         * - droite : caracterisees par leur longueur.
-         * - courbe : caracterisees par leur rayon de courbure, et l'angle parcouru.
-         * - aiguillage : caracterisees par leur rayon de courbure et l'angle parcouru (pour la partie courbe)
-         *                et par leur longueur (pour la partie droite).
-         * - croisement : caracterisees par leur longueur (pour les deux parties droites) et l'angle aigu entre les deux parties droites.
-         *                Les parties droites se croisent toujours en leur milieu.
-         * - traversee-jonction : caracterisees par leur longueur (pour les deux parties droites, le rayon de courbure des parties courbes,
-         *                        et l'angle parcouru.
-         * - buttoir : caracterisees par leur longueur (utile uniquement pour le dessin.
-         *
-         * Il est possible d'ajouter des types de voies. Referez-vous a la documentation.
-         */
-        if(ligneDecoupee.at(1) == "droite")
-            description->append(1.0);
-        else if(ligneDecoupee.at(1) == "courbe")
-            description->append(2.0);
-        else if(ligneDecoupee.at(1) == "aiguillage")
-            description->append(3.0);
-        else if(ligneDecoupee.at(1) == "croisement")
-            description->append(4.0);
-        else if(ligneDecoupee.at(1) == "traversee-jonction")
-            description->append(5.0);
-        else if(ligneDecoupee.at(1) == "buttoir")
-            description->append(6.0);
-        else if(ligneDecoupee.at(1) == "aiguillageEnroule")
-            description->append(7.0);
-        else if(ligneDecoupee.at(1) == "aiguillageTriple")
-            description->append(8.0);
-
-
-        for(int i =2; i < ligneDecoupee.length(); i++)
-        {
-            description->append(ligneDecoupee.at(i).toDouble());
-        }
-
-        //chargement des informations des voies dans la QMap idoine.
-        infosVoies.insert(ligneDecoupee.at(0).toInt(), description);
-
-        ligne = lecture.readLine();
-
-    }
-
+    myRedirector = new StdRedirector<>( std::cout, outcallback, JournalMessages::getInstance() );
 
     m_state=PAUSE;
 
@@ -132,7 +80,10 @@ MainWindow::MainWindow(QWidget *parent) :
 
     setGeometry(0,0,530,580);
 
-    simView = new SimView(this);
+    simView = new SimView(simEngine, this);
+
+    CONNECT(simEngine, SIGNAL(locoAjoutee(Loco*)), this, SLOT(addLoco(Loco*)));
+    CONNECT(simEngine, SIGNAL(erreur(QString)), this, SLOT(afficherErreur(QString)));
 
     setCentralWidget(simView);
 
@@ -172,6 +123,9 @@ void MainWindow::readSettings()
     viewContactNumberAct->setChecked(TrainSimSettings::getInstance()->getViewContactNumber());
     TrainSimSettings::getInstance()->setViewLocoLog(settings.value("viewLocoLog",false).toBool());
     viewLocoLogAct->setChecked(TrainSimSettings::getInstance()->getViewLocoLog());
+    TrainSimSettings::getInstance()->setVoiesFigees(settings.value("voiesFigees",true).toBool());
+    voiesFigeesAct->setChecked(TrainSimSettings::getInstance()->getVoiesFigees());
+    simView->setVoiesFigees(TrainSimSettings::getInstance()->getVoiesFigees());
     TrainSimSettings::getInstance()->setInertie(settings.value("inertie",true).toBool());
     inertieAct->setChecked(TrainSimSettings::getInstance()->getInertie());
 
@@ -184,6 +138,7 @@ void MainWindow::writeSettings() const
     settings.setValue("viewAiguillageNb",TrainSimSettings::getInstance()->getViewAiguillageNumber());
     settings.setValue("viewContactNb",TrainSimSettings::getInstance()->getViewContactNumber());
     settings.setValue("viewLocoLog",TrainSimSettings::getInstance()->getViewLocoLog());
+    settings.setValue("voiesFigees",TrainSimSettings::getInstance()->getVoiesFigees());
     settings.setValue("inertie",TrainSimSettings::getInstance()->getInertie());
 }
 
@@ -242,7 +197,7 @@ void MainWindow::toggleSimulation()
 
     if (m_state==PAUSE)
     {
-        this->simView->animationStart();
+        this->simEngine->demarrer();
         toggleSimAct->setText(tr("&Pause"));
         toggleSimAct->setShortcut(tr("Ctrl+P"));
         toggleSimAct->setStatusTip(tr("Pause the simulation"));
@@ -252,7 +207,7 @@ void MainWindow::toggleSimulation()
     }
     else
     {
-        this->simView->animationStop();
+        this->simEngine->arreter();
         toggleSimAct->setText(tr("&Resume"));
         toggleSimAct->setShortcut(tr("Ctrl+R"));
         toggleSimAct->setStatusTip(tr("Resume the simulation"));
@@ -326,23 +281,40 @@ void MainWindow::toggleLoco(QObject *locoCtrl)
 
 #include <QMessageBox>
 
-void MainWindow::afficherMessageLoco(int numLoco,QString message)
+void MainWindow::afficherJournal(const QVector<LigneJournal> &lignes)
 {
-    for(int i=0;i<locoCtrls.size();i++)
-        if (locoCtrls.at(i)->loco==numLoco)
+    //les lignes sont regroupées par console, afin de n'en modifier chacune qu'une fois.
+    QMap<int, QStringList> parSource;
+    foreach(const LigneJournal &l, lignes)
+        parSource[l.source].append(l.texte);
+
+    QMapIterator<int, QStringList> i(parSource);
+    while(i.hasNext())
+    {
+        i.next();
+        if(i.key() == JournalMessages::SOURCE_GENERALE)
         {
-            locoCtrls.at(i)->console->append(message);
-            return;
+            ajouterLignes(generalConsole, i.value());
+            continue;
         }
-    QMessageBox::warning(this,"Numéro de loco",QString(
-                             "Attention, pour l'affichage dans la console, le\
-                             numero de loco %1 n'est pas valide").arg(numLoco));
+
+        QTextEdit *console = nullptr;
+        for(int j=0;j<locoCtrls.size();j++)
+            if (locoCtrls.at(j)->loco==i.key())
+                console = locoCtrls.at(j)->console;
+
+        if(console != nullptr)
+            ajouterLignes(console, i.value());
+        else
+            QMessageBox::warning(this,"Numéro de loco",QString(
+                                     "Attention, pour l'affichage dans la console, le\
+                                     numero de loco %1 n'est pas valide").arg(i.key()));
+    }
 }
 
-void MainWindow::addLoco(int no_loco)
+void MainWindow::addLoco(Loco *l)
 {
-    Loco* l = new Loco(no_loco);
-    simView->addLoco(l, no_loco);
+    int no_loco = l->getNumLoco();
 
     LocoCtrl *c=new LocoCtrl;
     QString dockName=QString("Loco %1").arg(no_loco);
@@ -350,6 +322,7 @@ void MainWindow::addLoco(int no_loco)
     addDockWidget(Qt::RightDockWidgetArea,c->dock,Qt::Vertical);
 
     c->console = new QTextEdit(this);
+    c->console->document()->setMaximumBlockCount(LIGNES_MAX_CONSOLE);
     c->dock->setWidget(c->console);
     c->state=LocoCtrl::RUNNING;
     c->loco=no_loco;
@@ -467,6 +440,11 @@ void MainWindow::createActions()
     viewLocoLogAct->setCheckable(true);
     CONNECT(viewLocoLogAct, SIGNAL(triggered()), this, SLOT(viewLocoLog()));
 
+    voiesFigeesAct = new QAction(tr("Cache static tracks"), this);
+    voiesFigeesAct->setStatusTip(tr("Draw the tracks without switches from a pre-rendered layer"));
+    voiesFigeesAct->setCheckable(true);
+    CONNECT(voiesFigeesAct, SIGNAL(triggered()), this, SLOT(toggleVoiesFigees()));
+
     viewInputAct = inputDock->toggleViewAction();
 
     inertieAct = new QAction(tr("Inertia"), this);
@@ -501,6 +479,7 @@ void MainWindow::createMenus()
     view->addAction(viewLocoLogAct);
     view->addAction(viewContactNumberAct);
     view->addAction(viewAiguillageNumberAct);
+    view->addAction(voiesFigeesAct);
     view->addAction(viewInputAct);
 
     QMenu *settings=menuBar()->addMenu(tr("&Settings"));
@@ -556,6 +535,12 @@ void MainWindow::viewLocoLog()
     TrainSimSettings::getInstance()->setViewLocoLog(viewLocoLogAct->isChecked());
 }
 
+void MainWindow::toggleVoiesFigees()
+{
+    TrainSimSettings::getInstance()->setVoiesFigees(voiesFigeesAct->isChecked());
+    simView->setVoiesFigees(voiesFigeesAct->isChecked());
+}
+
 void MainWindow::toggleInertie()
 {
     TrainSimSettings::getInstance()->setInertie(inertieAct->isChecked());
@@ -574,300 +559,13 @@ void MainWindow::on_actionCharger_Maquette_triggered()
 
 void MainWindow::chargerMaquette(QString filename)
 {
-    this->simView->viderMaquette();
-
-    // stockage temporaire des voies, avec les identifiants des voies a lier.
-    QMap <Voie*, QList<int>*> voiesALier;
-    // stockage temporaire des voies, indexees par identifiants.
-    QMap <int, Voie*> IDVoies;
-
-    QStringList listeTemporaire;
-    QList<qreal>* infosVoieEnTraitement;
-    int IDvoie;
-    qreal directionVoieEnTraitement;
-
-    QFile fichier(filename);
-
-    if(!fichier.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        //declaration d'erreur.
-    }
-
-    QTextStream lecture(&fichier);
-    QString ligne;
-    bool premiereInfoValide;
-    int limite;
-
-    //avance rapide pour passer une eventuelle introduction.
-
-    ligne = lecture.readLine();
-
-    listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
-
-    limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
-
-    while((listeTemporaire.length() != 1) && !premiereInfoValide)
-    {
-        if(lecture.atEnd())
-            qDebug() << "Erreur de lecture de fichier : fichier non standard. (nombre de voies mal indique)";
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
-
-        limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
-
-    }
-
-    // lecture des informations relatives aux voies, creation des voies.
-
-    VoieDroite* vd;
-    VoieCourbe* vc;
-    VoieAiguillage* va;
-    VoieAiguillageEnroule* vae;
-    VoieAiguillageTriple* vat;
-    VoieCroisement* vcr;
-    VoieTraverseeJonction* vt;
-    VoieButtoir* vb;
-
-    for(int i =0; i < limite; i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
-
-        IDvoie = listeTemporaire.at(0).toInt();
-
-        //recuperation des infos de la voie en traitement.
-        infosVoieEnTraitement = infosVoies[listeTemporaire.at(1).toInt()];
-
-        if(infosVoieEnTraitement->at(0) == 1.0)//voie Droite
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vd = new VoieDroite(infosVoieEnTraitement->at(1));
-            vd->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vd);
-            voiesALier.insert(vd, new QList<int>());
-            voiesALier[vd]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vd]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vd, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 2.0)//voie Courbe
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(4).toLower() == "gauche")
-            {
-                directionVoieEnTraitement = 1.0;
-            }
-            else if(listeTemporaire.at(4).toLower() == "droite")
-            {
-                directionVoieEnTraitement = -1.0;
-            }
-            else //en cas d'erreur dans le fichier...
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction de courbe). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vc = new VoieCourbe(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), directionVoieEnTraitement);
-            vc->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vc);
-            voiesALier.insert(vc, new QList<int>());
-            voiesALier[vc]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vc]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vc, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 3.0)//voie Aiguillage
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(5).toLower() == "gauche")
-                directionVoieEnTraitement = 1.0;
-            else if(listeTemporaire.at(5).toLower() == "droite")
-                directionVoieEnTraitement = -1.0;
-            else
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            va = new VoieAiguillage(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
-            va->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, va);
-            voiesALier.insert(va, new QList<int>());
-            voiesALier[va]->append(listeTemporaire.at(2).toInt());
-            voiesALier[va]->append(listeTemporaire.at(3).toInt());
-            voiesALier[va]->append(listeTemporaire.at(4).toInt());
-            this->simView->addVoie(va, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 4.0)//voie Croisement
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vcr = new VoieCroisement(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2));
-            vcr->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vcr);
-            voiesALier.insert(vcr, new QList<int>());
-            voiesALier[vcr]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vcr, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 5.0)//voie Traversee-Jonction
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vt= new VoieTraverseeJonction(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
-            vt->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vt);
-            voiesALier.insert(vt, new QList<int>());
-            voiesALier[vt]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vt, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 6.0)//voie Buttoir
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vb = new VoieButtoir(infosVoieEnTraitement->at(1));
-            vb->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vb);
-            voiesALier.insert(vb, new QList<int>());
-            voiesALier[vb]->append(listeTemporaire.at(2).toInt());
-            this->simView->addVoie(vb, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 7.0)//voie Aiguillage Enroule
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(5).toLower() == "gauche")
-                directionVoieEnTraitement = 1.0;
-            else if(listeTemporaire.at(5).toLower() == "droite")
-                directionVoieEnTraitement = -1.0;
-            else
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vae = new VoieAiguillageEnroule(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
-            vae->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vae);
-            voiesALier.insert(vae, new QList<int>());
-            voiesALier[vae]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vae]->append(listeTemporaire.at(4).toInt()); //ordre inversé, pour la cohérence du code...
-            voiesALier[vae]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vae, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 8.0)//voie Aiguillage Triple
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vat = new VoieAiguillageTriple(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
-            vat->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vat);
-            voiesALier.insert(vat, new QList<int>());
-            voiesALier[vat]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vat, listeTemporaire.at(0).toInt());
-        }
-    }
-    //finalisation de la creation des voies.
-
-    for(int i = 1; i <= IDVoies.size(); i++)
-    {
-        for(int j = 0; j < voiesALier[IDVoies[i]]->length(); j++)
-        {
-            IDVoies[i]->lier(IDVoies[voiesALier[IDVoies[i]]->at(j)], j);
-        }
-    }
-
-    //debut de la lecture des contacts.
-
-    limite = lecture.readLine().toInt();
-
-    Contact* c;
-
-    for(int i=0; i < limite;i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
-
-        //creation des contacts.
-        c = new Contact(listeTemporaire.at(0).toInt(), listeTemporaire.at(1).toInt());
-
-        IDVoies[listeTemporaire.at(1).toInt()]->setContact(c);
-        this->simView->addContact(c, listeTemporaire.at(0).toInt());
-    }
-
-    //debut de la lecture des aiguillages.
-
-    limite = lecture.readLine().toInt();
-
-    for(int i=0; i < limite;i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
-
-        VoieVariable *v=dynamic_cast<VoieVariable *>(IDVoies[listeTemporaire.at(1).toInt()]);
-
-        this->simView->addVoieVariable(v, listeTemporaire.at(0).toInt());
-
-        v->setNumVoieVariable(listeTemporaire.at(0).toInt());
-
-    }
-
-    //indication de la premiere voie a poser.
-
-    Voie * premiereVoie = IDVoies[lecture.readLine().toInt()];
-
-    this->simView->setPremiereVoie(premiereVoie);
-
-    this->simView->construireMaquette();
-
-    this->simView->genererSegments();
-
-    this->simView->zoomFit();
-
-    this->simView->repaint();
-
-    // On détruit la map qui contient des pointeurs sur des QList
-    QMapIterator<Voie*, QList<int>*> it(voiesALier);
-    while (it.hasNext()) {
-        it.next();
-        delete it.value();
-    }
-
-    this->maquetteFinie.release();
-}
-
-void MainWindow::afficherMessage(QString message)
-{
-    this->generalConsole->append(message);
+    simEngine->chargerMaquette(filename);
 }
 
 
-void MainWindow::selectionMaquette(QString maquette)
+void MainWindow::afficherErreur(QString message)
 {
-
-    MaquetteManager manager;
-
-    QStringList list=manager.nomMaquettes();
-    if (!list.contains(maquette))
-    {
-        QString message=QString("La maquette \"%1\" n'existe pas.\n").arg(maquette);
-        if (list.size()==0)
-        {
-            message+="Aucune maquette n'est disponible. Elles devraient se trouver dans le repertoire \""+manager.dossierMaquette()+"\". Verifiez votre installation";
-        }
-        else
-        {
-            message+="Les maquettes valides sont:";
-            foreach(QString maq,list)
-                message+=QString("\n\t%1").arg(maq);
-        }
-        QMessageBox::warning(0,"La maquette n'existe pas",message);
-        exit(1);
-    }
-    chargerMaquette(manager.fichierMaquette(maquette));
-    semWaitMaquette.release();
+    QMessageBox::critical(this,"Erreur",message);
 }
 
 void MainWindow::onReturnPressed()
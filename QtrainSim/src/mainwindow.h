@@ -7,17 +7,10 @@
 #include <QDebug>
 #include <QSignalMapper>
 #include <QTextEdit>
-#include <QSemaphore>
 #include <ios>
 
-#include "voieaiguillage.h"
-#include "voieaiguillageenroule.h"
-#include "voieaiguillagetriple.h"
-#include "voiebuttoir.h"
-#include "voiecourbe.h"
-#include "voiecroisement.h"
-#include "voiedroite.h"
-#include "voietraverseejonction.h"
+#include "simengine.h"
+#include "journalmessages.h"
 #include "simview.h"
 #include "contact.h"
 #include "connect.h"
@@ -100,18 +93,15 @@ class MainWindow : public QMainWindow
 
 public:
     /** Constructeur de classe.
-      *
+      * \param engine le moteur de simulation piloté par la fenêtre.
       */
-    explicit MainWindow(QWidget *parent = 0);
+    explicit MainWindow(SimEngine *engine, QWidget *parent = 0);
 
     /** Destructeur de classe.
       *
       */
     ~MainWindow();
 
-    QSemaphore semWaitMaquette;
-    QSemaphore maquetteFinie;
-
     /** retourne un pointeur vers le SiMView contenant la simulation.
       * \return le SimView contenant la simulation.
       */
@@ -130,6 +120,11 @@ public:
     void readSettings();
     void writeSettings() const;
 
+    /** affiche un lot de lignes du journal, chacune dans la console de sa source.
+      * \param lignes les lignes, dans l'ordre de leur dépôt.
+      */
+    void afficherJournal(const QVector<LigneJournal> &lignes);
+
     /** Charge et construit la maquette dont le nom est filename
       * \param filename le nom de la maquette à charger.
       */
@@ -155,6 +150,7 @@ public:
     QAction *viewContactNumberAct;
     QAction *viewAiguillageNumberAct;
     QAction *viewLocoLogAct;
+    QAction *voiesFigeesAct;
     QAction *viewInputAct;
     QAction *inertieAct;
     QAction *emergencyStopAct;
@@ -177,11 +173,10 @@ private slots:
 
 private:
     SimView *simView;
-    QMap <int, QList<double>*> infosVoies;
+    SimEngine *simEngine;
 
 public slots:
-    void selectionMaquette(QString maquette);
-    void addLoco(int no_loco);
+    void addLoco(Loco* l);
     void closeEvent(QCloseEvent *event);
     void toggleSimulation();
     void emergencyStop();
@@ -195,10 +190,10 @@ public slots:
     void viewContactNumber();
     void viewAiguillageNumber();
     void viewLocoLog();
+    void toggleVoiesFigees();
     void toggleLoco(QObject *locoCtrls);
     void toggleInertie();
-    void afficherMessage(QString message);
-    void afficherMessageLoco(int numLoco,QString message);
+    void afficherErreur(QString message);
     void print();
     void onReturnPressed();
 };
@@ -70,6 +70,10 @@ bool MaquetteManager::chargerListeMaquettes()
     for (int i = 0; i < list.size(); ++i) {
         QFileInfo fileInfo = list.at(i);
 
+        //les caches des maquettes ne sont pas des maquettes.
+        if (fileInfo.fileName().endsWith(EXTENSION_CACHE_MAQUETTE) || fileInfo.fileName().endsWith(EXTENSION_CACHE_MAQUETTE ".tmp"))
+            continue;
+
         MaquetteDesc *desc=new MaquetteDesc();
         desc->nomFichier=fileInfo.absoluteFilePath();
         QString s=fileInfo.fileName();
@@ -55,3 +55,18 @@ bool Segment::relie(Contact *c1, Contact *c2)
         return true;
     return false;
 }
+
+Contact* Segment::getContact1() const
+{
+    return contact1;
+}
+
+Contact* Segment::getContact2() const
+{
+    return contact2;
+}
+
+QList<Voie*> Segment::getVoies() const
+{
+    return voies;
+}
@@ -39,6 +39,18 @@ public:
       * \return vrai si le segment relie c1 et c2, faux sinon.
       */
     bool relie(Contact* c1, Contact* c2);
+
+    /** retourne le premier contact du segment.
+      */
+    Contact* getContact1() const;
+
+    /** retourne le second contact du segment, nullptr si le segment se termine sur un buttoir.
+      */
+    Contact* getContact2() const;
+
+    /** retourne les voies du segment, d'un contact à l'autre.
+      */
+    QList<Voie*> getVoies() const;
 signals:
 
 public slots:
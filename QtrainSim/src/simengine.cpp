@@ -0,0 +1,1158 @@
+#include <math.h>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <QTextStream>
+#include <QStringList>
+#include <QRegExp>
+#include <QDebug>
+
+#include "simengine.h"
+#include "connect.h"
+#include "maquettemanager.h"
+#include "voieaiguillage.h"
+#include "voieaiguillageenroule.h"
+#include "voieaiguillagetriple.h"
+#include "voiebuttoir.h"
+#include "voiecourbe.h"
+#include "voiecroisement.h"
+#include "voiedroite.h"
+#include "voietraverseejonction.h"
+#include "journalevenements.h"
+
+//! "QTMQ" : identifie un cache de maquette.
+static const quint32 MAGIE_CACHE_MAQUETTE = 0x51544d51;
+//! à incrémenter à chaque changement du format du cache ou de la géométrie des voies.
+static const quint16 VERSION_CACHE_MAQUETTE = 1;
+
+SimEngine::SimEngine(QObject *parent) :
+    QObject(parent)
+{
+    premiereVoie = nullptr;
+    limiteTempsReel = true;
+    retardMs = 0;
+    enMarche = false;
+    vidageDemande = false;
+    enregistreur = nullptr;
+    lecteur = nullptr;
+    numeroPas = 0;
+    pasMaximum = 0;
+    dimensionSegments = 0;
+    timer = new QTimer(this);
+    timer->setInterval(1000/FRAME_RATE);
+    timer->setTimerType(Qt::PreciseTimer);
+    CONNECT(timer, SIGNAL(timeout()), this, SLOT(timerTrigger()));
+}
+
+SimEngine::~SimEngine()
+{
+    foreach(QList<double>* description, infosVoies)
+        delete description;
+
+    BusContacts::getInstance()->setObservateur(nullptr);
+    delete enregistreur;
+    delete lecteur;
+}
+
+bool SimEngine::enregistrerTrace(const QString &nomFichier)
+{
+    EnregistreurTrace* e = new EnregistreurTrace();
+    if(!e->ouvrir(nomFichier))
+    {
+        delete e;
+        return false;
+    }
+    enregistreur = e;
+    BusContacts::getInstance()->setObservateur(enregistreur);
+    return true;
+}
+
+bool SimEngine::rejouerTrace(const QString &nomFichier, QString &erreur)
+{
+    LecteurTrace* l = new LecteurTrace();
+    if(!l->ouvrir(nomFichier, erreur))
+    {
+        delete l;
+        return false;
+    }
+    lecteur = l;
+    BusContacts::getInstance()->setObservateur(lecteur);
+    return true;
+}
+
+bool SimEngine::estEnRejeu() const
+{
+    return lecteur != nullptr;
+}
+
+QString SimEngine::rapportRejeu(bool &conforme) const
+{
+    conforme = true;
+    if(lecteur == nullptr)
+        return QString();
+    return lecteur->rapport(conforme);
+}
+
+void SimEngine::terminerTrace()
+{
+    if(enregistreur != nullptr)
+        enregistreur->fermer();
+}
+
+void SimEngine::chargerInfosVoies()
+{
+    QFile fichierInfosVoies(DATADIR+"/infosVoies.txt");
+    if (!fichierInfosVoies.open(QIODevice::ReadOnly))
+    {
+        erreurFatale(QString("Le fichier de description des voies ne peut être trouvé. Vérifiez qu'il est bien présent dans le répertoire parent de l'exécutable.\n Le nom du fichier est: %1.\nAvez-vous effectué un \"make install\"?").arg(fichierInfosVoies.fileName()));
+    }
+    QTextStream lecture(&fichierInfosVoies);
+
+    QString ligne;
+
+    QStringList ligneDecoupee;
+
+    QList<double>* description;
+
+    ligne = lecture.readLine();
+
+    while(!ligne.startsWith("EOF"))
+    {
+        ligneDecoupee = ligne.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+
+        description = new QList<double>();
+
+        /* En l'etat, le programme gere 6 types de voies differentes :
+         * - droite : caracterisees par leur longueur.
+         * - courbe : caracterisees par leur rayon de courbure, et l'angle parcouru.
+         * - aiguillage : caracterisees par leur rayon de courbure et l'angle parcouru (pour la partie courbe)
+         *                et par leur longueur (pour la partie droite).
+         * - croisement : caracterisees par leur longueur (pour les deux parties droites) et l'angle aigu entre les deux parties droites.
+         *                Les parties droites se croisent toujours en leur milieu.
+         * - traversee-jonction : caracterisees par leur longueur (pour les deux parties droites, le rayon de courbure des parties courbes,
+         *                        et l'angle parcouru.
+         * - buttoir : caracterisees par leur longueur (utile uniquement pour le dessin.
+         *
+         * Il est possible d'ajouter des types de voies. Referez-vous a la documentation.
+         */
+        if(ligneDecoupee.at(1) == "droite")
+            description->append(1.0);
+        else if(ligneDecoupee.at(1) == "courbe")
+            description->append(2.0);
+        else if(ligneDecoupee.at(1) == "aiguillage")
+            description->append(3.0);
+        else if(ligneDecoupee.at(1) == "croisement")
+            description->append(4.0);
+        else if(ligneDecoupee.at(1) == "traversee-jonction")
+            description->append(5.0);
+        else if(ligneDecoupee.at(1) == "buttoir")
+            description->append(6.0);
+        else if(ligneDecoupee.at(1) == "aiguillageEnroule")
+            description->append(7.0);
+        else if(ligneDecoupee.at(1) == "aiguillageTriple")
+            description->append(8.0);
+
+
+        for(int i =2; i < ligneDecoupee.length(); i++)
+        {
+            description->append(ligneDecoupee.at(i).toDouble());
+        }
+
+        //chargement des informations des voies dans la QMap idoine.
+        infosVoies.insert(ligneDecoupee.at(0).toInt(), description);
+
+        ligne = lecture.readLine();
+
+    }
+}
+
+void SimEngine::chargerMaquette(QString filename)
+{
+    if (infosVoies.isEmpty())
+        chargerInfosVoies();
+
+    arreter();
+    viderMaquette();
+
+    //les pas, et donc la trace, sont comptés depuis le chargement de la maquette.
+    numeroPas = 0;
+    if(enregistreur != nullptr)
+        enregistreur->maquette(QFileInfo(filename).baseName());
+    if(lecteur != nullptr)
+    {
+        lecteur->maquette(QFileInfo(filename).baseName());
+        pasMaximum = qMax(lecteur->getDernierPas(), (qint64) 1);
+    }
+
+    //la maquette est reprise du cache tant que ni elle ni infosVoies.txt n'ont changé.
+    QByteArray empreinte = empreinteMaquette(filename);
+    QString fichierCache = filename + EXTENSION_CACHE_MAQUETTE;
+
+    if(!chargerCache(fichierCache, empreinte))
+    {
+        DescriptionMaquette description;
+        lireMaquette(filename, description);
+        instancierMaquette(description);
+
+        construireMaquette();
+
+        genererSegments();
+
+        ecrireCache(fichierCache, empreinte, description);
+    }
+
+    emit maquetteConstruite();
+
+    this->maquetteChargee.release();
+}
+
+void SimEngine::lireMaquette(QString filename, DescriptionMaquette &description)
+{
+    QStringList listeTemporaire;
+    QList<qreal>* infosVoieEnTraitement;
+    qreal directionVoieEnTraitement;
+
+    QFile fichier(filename);
+
+    if(!fichier.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        //declaration d'erreur.
+    }
+
+    QTextStream lecture(&fichier);
+    QString ligne;
+    bool premiereInfoValide;
+    int limite;
+
+    //avance rapide pour passer une eventuelle introduction.
+
+    ligne = lecture.readLine();
+
+    listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
+
+    limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
+
+    while((listeTemporaire.length() != 1) && !premiereInfoValide)
+    {
+        if(lecture.atEnd())
+            qDebug() << "Erreur de lecture de fichier : fichier non standard. (nombre de voies mal indique)";
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
+
+        limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
+
+    }
+
+    // lecture des informations relatives aux voies.
+
+    for(int i =0; i < limite; i++)
+    {
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", QString::SkipEmptyParts);
+
+        DescriptionVoie dv;
+        dv.id = listeTemporaire.at(0).toInt();
+
+        //recuperation des infos de la voie en traitement.
+        infosVoieEnTraitement = infosVoies[listeTemporaire.at(1).toInt()];
+        dv.type = (int) infosVoieEnTraitement->at(0);
+
+        //parametres du constructeur de la voie, tires de infosVoies.txt.
+        int nbreParametres = (dv.type == 1 || dv.type == 6) ? 1 : (dv.type == 2 || dv.type == 4) ? 2 : 3;
+        for(int j = 1; j <= nbreParametres; j++)
+            dv.parametres.append(infosVoieEnTraitement->at(j));
+
+        //voies a lier, dans l'ordre des extremites.
+        int nbreLiens = (dv.type == 6) ? 1 : (dv.type == 1 || dv.type == 2) ? 2 : (dv.type == 3 || dv.type == 7) ? 3 : 4;
+        for(int j = 0; j < nbreLiens; j++)
+            dv.liens.append(listeTemporaire.at(2 + j).toInt());
+        if(dv.type == 7)//voie Aiguillage Enroule : ordre inversé, pour la cohérence du code...
+            qSwap(dv.liens[1], dv.liens[2]);
+
+        if(dv.type == 2 || dv.type == 3 || dv.type == 7)//voies Courbe et Aiguillages simples
+        {
+            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
+            // NE CHANGER SOUS AUCUN PRETEXTE.
+            QString direction = listeTemporaire.at(dv.type == 2 ? 4 : 5).toLower();
+            if(direction == "gauche")
+                directionVoieEnTraitement = 1.0;
+            else if(direction == "droite")
+                directionVoieEnTraitement = -1.0;
+            else //en cas d'erreur dans le fichier...
+            {
+                directionVoieEnTraitement = 0.0;
+                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction de courbe ou d'aiguillage). ";
+            }
+            dv.parametres.append(directionVoieEnTraitement);
+        }
+
+        description.voies.append(dv);
+    }
+
+    //debut de la lecture des contacts.
+
+    limite = lecture.readLine().toInt();
+
+    for(int i=0; i < limite;i++)
+    {
+        listeTemporaire = lecture.readLine().split(" ", QString::SkipEmptyParts);
+        description.contacts.append(qMakePair(listeTemporaire.at(0).toInt(), listeTemporaire.at(1).toInt()));
+    }
+
+    //debut de la lecture des aiguillages.
+
+    limite = lecture.readLine().toInt();
+
+    for(int i=0; i < limite;i++)
+    {
+        listeTemporaire = lecture.readLine().split(" ", QString::SkipEmptyParts);
+        description.voiesVariables.append(qMakePair(listeTemporaire.at(0).toInt(), listeTemporaire.at(1).toInt()));
+    }
+
+    //indication de la premiere voie a poser.
+
+    description.premiereVoie = lecture.readLine().toInt();
+}
+
+Voie* SimEngine::creerVoie(int type, const QVector<qreal> &p)
+{
+    switch(type)
+    {
+    case 1: return new VoieDroite(p.at(0));
+    case 2: return new VoieCourbe(p.at(0), p.at(1), (int) p.at(2));
+    case 3: return new VoieAiguillage(p.at(0), p.at(1), p.at(2), p.at(3));
+    case 4: return new VoieCroisement(p.at(0), p.at(1));
+    case 5: return new VoieTraverseeJonction(p.at(0), p.at(1), p.at(2));
+    case 6: return new VoieButtoir(p.at(0));
+    case 7: return new VoieAiguillageEnroule(p.at(0), p.at(1), p.at(2), p.at(3));
+    case 8: return new VoieAiguillageTriple(p.at(0), p.at(1), p.at(2));
+    }
+    return nullptr;
+}
+
+void SimEngine::instancierMaquette(const DescriptionMaquette &description)
+{
+    //creation des voies.
+    foreach(const DescriptionVoie &dv, description.voies)
+    {
+        Voie* v = creerVoie(dv.type, dv.parametres);
+        if(v == nullptr)
+            erreurFatale(QString("Type de voie inconnu (%1) pour la voie %2.").arg(dv.type).arg(dv.id));
+        v->setIdVoie(dv.id);
+        addVoie(v, dv.id);
+    }
+
+    //finalisation de la creation des voies.
+    foreach(const DescriptionVoie &dv, description.voies)
+    {
+        for(int j = 0; j < dv.liens.size(); j++)
+            Voies.value(dv.id)->lier(Voies.value(dv.liens.at(j), nullptr), j);
+    }
+
+    //creation des contacts.
+    for(int i = 0; i < description.contacts.size(); i++)
+    {
+        Contact* c = new Contact(description.contacts.at(i).first, description.contacts.at(i).second);
+        Voies.value(description.contacts.at(i).second)->setContact(c);
+        addContact(c, description.contacts.at(i).first);
+    }
+
+    //creation des aiguillages.
+    for(int i = 0; i < description.voiesVariables.size(); i++)
+    {
+        VoieVariable *v = dynamic_cast<VoieVariable *>(Voies.value(description.voiesVariables.at(i).second));
+        addVoieVariable(v, description.voiesVariables.at(i).first);
+        v->setNumVoieVariable(description.voiesVariables.at(i).first);
+    }
+
+    setPremiereVoie(Voies.value(description.premiereVoie));
+}
+
+QByteArray SimEngine::empreinteMaquette(QString filename)
+{
+    QCryptographicHash empreinte(QCryptographicHash::Sha1);
+    empreinte.addData(QByteArray::number(VERSION_CACHE_MAQUETTE));
+
+    QFile fichier(filename);
+    if(fichier.open(QIODevice::ReadOnly))
+        empreinte.addData(fichier.readAll());
+
+    //la geometrie depend aussi des caracteristiques des types de voies.
+    QFile fichierInfosVoies(DATADIR+"/infosVoies.txt");
+    if(fichierInfosVoies.open(QIODevice::ReadOnly))
+        empreinte.addData(fichierInfosVoies.readAll());
+
+    return empreinte.result();
+}
+
+bool SimEngine::chargerCache(QString fichierCache, const QByteArray &empreinte)
+{
+    QFile fichier(fichierCache);
+    if(!fichier.open(QIODevice::ReadOnly))
+        return false;
+
+    //le cache est projeté en mémoire, et lu sans copie.
+    qint64 taille = fichier.size();
+    uchar* projection = fichier.map(0, taille);
+    QByteArray donnees = (projection != nullptr) ? QByteArray::fromRawData((const char*) projection, taille)
+                                                 : fichier.readAll();
+
+    QDataStream flux(donnees);
+    flux.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magie;
+    quint16 version;
+    QByteArray empreinteCache;
+    flux >> magie >> version;
+    if(magie != MAGIE_CACHE_MAQUETTE || version != VERSION_CACHE_MAQUETTE)
+        return false;
+    flux >> empreinteCache;
+    if(empreinteCache != empreinte)
+        return false;
+
+    DescriptionMaquette description;
+    quint32 nbreVoies;
+    flux >> nbreVoies;
+    for(quint32 i = 0; i < nbreVoies && flux.status() == QDataStream::Ok; i++)
+    {
+        DescriptionVoie dv;
+        flux >> dv.id >> dv.type >> dv.parametres >> dv.liens;
+        description.voies.append(dv);
+    }
+    flux >> description.contacts >> description.voiesVariables >> description.premiereVoie;
+
+    if(flux.status() != QDataStream::Ok)
+        return false;
+
+    instancierMaquette(description);
+
+    //geometrie resolue : ni orientation ni pose recursives.
+    foreach(const DescriptionVoie &dv, description.voies)
+    {
+        Voie* v = Voies.value(dv.id);
+        v->restaurerGeometrie(flux);
+        if(v->getContact() != nullptr)
+            v->calculerPositionContact();
+        v->figerGeometrie();
+    }
+
+    //table des segments.
+    quint32 nbreSegments;
+    flux >> nbreSegments;
+    for(quint32 i = 0; i < nbreSegments && flux.status() == QDataStream::Ok; i++)
+    {
+        qint32 contact1, contact2;
+        QVector<int> idVoies;
+        flux >> contact1 >> contact2 >> idVoies;
+
+        QList<Voie*> lv;
+        foreach(int id, idVoies)
+            lv.append(Voies.value(id));
+        segments.append(new Segment(contacts.value(contact1), contacts.value(contact2, nullptr), lv));
+    }
+    indexerSegments();
+
+    if(flux.status() != QDataStream::Ok)
+    {
+        //cache tronqué : on repart du fichier texte.
+        viderMaquette();
+        return false;
+    }
+    return true;
+}
+
+void SimEngine::ecrireCache(QString fichierCache, const QByteArray &empreinte, const DescriptionMaquette &description)
+{
+    //écriture dans un fichier temporaire, renommé une fois complet.
+    QFile fichier(fichierCache + ".tmp");
+    if(!fichier.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+
+    QDataStream flux(&fichier);
+    flux.setVersion(QDataStream::Qt_5_0);
+
+    flux << MAGIE_CACHE_MAQUETTE << VERSION_CACHE_MAQUETTE << empreinte;
+
+    flux << (quint32) description.voies.size();
+    foreach(const DescriptionVoie &dv, description.voies)
+        flux << dv.id << dv.type << dv.parametres << dv.liens;
+    flux << description.contacts << description.voiesVariables << description.premiereVoie;
+
+    foreach(const DescriptionVoie &dv, description.voies)
+        Voies.value(dv.id)->sauverGeometrie(flux);
+
+    flux << (quint32) segments.size();
+    foreach(Segment* s, segments)
+    {
+        QVector<int> idVoies;
+        foreach(Voie* v, s->getVoies())
+            idVoies.append(v->getIdVoie());
+        flux << (qint32) contacts.key(s->getContact1(), 0) << (qint32) contacts.key(s->getContact2(), 0) << idVoies;
+    }
+
+    fichier.close();
+    QFile::remove(fichierCache);
+    QFile::rename(fichier.fileName(), fichierCache);
+}
+
+void SimEngine::selectionMaquette(QString maquette)
+{
+    MaquetteManager manager;
+
+    QStringList list=manager.nomMaquettes();
+    if (!list.contains(maquette))
+    {
+        QString message=QString("La maquette \"%1\" n'existe pas.\n").arg(maquette);
+        if (list.size()==0)
+        {
+            message+="Aucune maquette n'est disponible. Elles devraient se trouver dans le repertoire \""+manager.dossierMaquette()+"\". Verifiez votre installation";
+        }
+        else
+        {
+            message+="Les maquettes valides sont:";
+            foreach(QString maq,list)
+                message+=QString("\n\t%1").arg(maq);
+        }
+        erreurFatale(message);
+    }
+    chargerMaquette(manager.fichierMaquette(maquette));
+}
+
+void SimEngine::addVoie(Voie *v, int ID)
+{
+    this->Voies.insert(ID, v);
+}
+
+void SimEngine::addContact(Contact *c, int ID)
+{
+    this->contacts.insert(ID, c);
+}
+
+void SimEngine::addVoieVariable(VoieVariable *vv, int ID)
+{
+    this->VoiesVariables.insert(ID, vv);
+    CONNECT(vv, SIGNAL(etatModifie(Voie*)), this, SLOT(voieVariableModifiee(Voie*)));
+}
+
+void SimEngine::setPremiereVoie(Voie *v)
+{
+    this->premiereVoie = v;
+}
+
+void SimEngine::construireMaquette()
+{
+    this->premiereVoie->calculerAnglesEtCoordonnees();
+
+    this->premiereVoie->calculerPosition();
+
+    foreach(Voie* v, this->Voies)
+        v->figerGeometrie();
+}
+
+void SimEngine::viderMaquette()
+{
+    qDeleteAll(this->segments);
+    this->segments.clear();
+    this->tableSegments.clear();
+    this->segmentsParVoie.clear();
+    this->itineraires.vider();
+    this->etatsAiguillages.vider();
+    this->dimensionSegments = 0;
+
+    //les contacts et les voies variables sont détruits avec les voies.
+    foreach(Voie* v, this->Voies)
+        delete v;
+
+    this->Voies.clear();
+    this->contacts.clear();
+    this->VoiesVariables.clear();
+}
+
+void SimEngine::genererSegments()
+{
+    //tous les chemins d'un contact sont écrits dans le même tableau, réutilisé d'un contact à l'autre.
+    QVector<Voie*> voies;
+    QVector<int> fins;
+
+    for(int i = 1; i <= this->contacts.size(); i++)
+    {
+        voies.clear();
+        fins.clear();
+        this->Voies.value(contacts.value(i)->getNumVoiePorteuse())->explorationContactAContact(voies, fins);
+
+        int debut = 0;
+        foreach(int fin, fins)
+        {
+            Voie* premiere = voies.at(debut);
+            Voie* derniere = voies.at(fin - 1);
+
+            if(derniere->getContact() != nullptr)
+            {
+                if(premiere->getContact()->getNumContact() < derniere->getContact()->getNumContact())
+                {
+                    segments.append(new Segment(premiere->getContact(), derniere->getContact(), voies.mid(debut, fin - debut).toList()));
+                }
+            }
+            else
+            {
+                //gestion de segments entre un contact et une voie buttoir...
+                segments.append(new Segment(premiere->getContact(), nullptr, voies.mid(debut, fin - debut).toList()));
+            }
+            debut = fin;
+        }
+    }
+
+    indexerSegments();
+}
+
+void SimEngine::addLoco(Loco *l, int ID)
+{
+    this->Locos.insert(ID, l);
+
+    CONNECT(l, SIGNAL(nouveauSegment(Contact*,Contact*,Loco*)), this, SLOT(locoSurNouveauSegment(Contact*,Contact*,Loco*)));
+    CONNECT(this, SIGNAL(locoSurSegment(Segment*)), l, SLOT(locoSurSegment(Segment*)));
+    CONNECT(this, SIGNAL(notificationVoieVariableModifiee(Voie*)), l, SLOT(voieVariableModifiee(Voie*)));
+
+    emit locoAjoutee(l);
+}
+
+void SimEngine::ajouterLoco(int numLoco)
+{
+    if (this->Locos.contains(numLoco))
+        return;
+    addLoco(new Loco(numLoco), numLoco);
+}
+
+QList<Voie*> SimEngine::getVoies() const
+{
+    return this->Voies.values();
+}
+
+QList<Loco*> SimEngine::getLocos() const
+{
+    return this->Locos.values();
+}
+
+Loco* SimEngine::getLoco(int n) const
+{
+    return this->Locos.value(n, nullptr);
+}
+
+Contact* SimEngine::getContact(int n) const
+{
+    return this->contacts.value(n);
+}
+
+void SimEngine::indexerSegments()
+{
+    int maxContact = contacts.isEmpty() ? 0 : contacts.lastKey();
+    dimensionSegments = maxContact + 1;
+    tableSegments.fill(nullptr, dimensionSegments * dimensionSegments);
+
+    int maxVoie = Voies.isEmpty() ? 0 : Voies.lastKey();
+    segmentsParVoie.clear();
+    segmentsParVoie.resize(maxVoie + 1);
+
+    foreach(Segment* s, this->segments)
+    {
+        //les segments aboutissant à une voie buttoir ne relient pas deux contacts.
+        if(s->getContact1() != nullptr && s->getContact2() != nullptr)
+        {
+            int min = qMin(s->getContact1()->getNumContact(), s->getContact2()->getNumContact());
+            int max = qMax(s->getContact1()->getNumContact(), s->getContact2()->getNumContact());
+            //comme le parcours de la liste, on retient le premier segment reliant la paire.
+            Segment* &c = tableSegments[min * dimensionSegments + max];
+            if(c == nullptr)
+                c = s;
+        }
+
+        foreach(Voie* v, s->getVoies())
+        {
+            QList<Segment*> &lv = segmentsParVoie[v->getIdVoie()];
+            if(!lv.contains(s))
+                lv.append(s);
+        }
+    }
+}
+
+Segment* SimEngine::getSegmentByContacts(int contactA, int contactB) const
+{
+    int min = contactA < contactB ? contactA : contactB;
+    int max = contactA < contactB ? contactB : contactA;
+
+    if(min <= 0 || max >= dimensionSegments)
+        return nullptr;
+    return tableSegments.at(min * dimensionSegments + max);
+}
+
+QVector<int> SimEngine::getVoiesSegment(int contactA, int contactB) const
+{
+    QVector<int> idVoies;
+    Segment* s = getSegmentByContacts(contactA, contactB);
+    if(s != nullptr)
+    {
+        foreach(Voie* v, s->getVoies())
+            idVoies.append(v->getIdVoie());
+    }
+    return idVoies;
+}
+
+int SimEngine::calculerItineraire(const QVector<int> &etapes, QString &erreur)
+{
+    return itineraires.calculer(this->Voies, this->contacts, etapes, erreur);
+}
+
+bool SimEngine::getItineraire(int numero, Itineraire &itineraire) const
+{
+    return itineraires.getItineraire(numero, itineraire);
+}
+
+QList<Segment*> SimEngine::getSegmentsDeVoie(Voie *v) const
+{
+    if(v == nullptr || v->getIdVoie() < 0 || v->getIdVoie() >= segmentsParVoie.size())
+        return QList<Segment*>();
+    return segmentsParVoie.at(v->getIdVoie());
+}
+
+Segment* SimEngine::getSegmentDeLoco(int numLoco) const
+{
+    Loco* l = this->Locos.value(numLoco, nullptr);
+    if(l == nullptr)
+        return nullptr;
+
+    QList<Segment*> candidats = getSegmentsDeVoie(l->getVoie());
+    if(candidats.isEmpty())
+        return nullptr;
+
+    //sur un contact ou un aiguillage partagé, le dernier segment signalé par la loco départage.
+    if(candidats.size() > 1 && candidats.contains(l->getSegmentActuel()))
+        return l->getSegmentActuel();
+    return candidats.first();
+}
+
+void SimEngine::demarrer()
+{
+    enMarche = true;
+    retardMs = 0;
+    etatsPrecedents.clear();
+    horloge.start();
+    timer->start();
+}
+
+void SimEngine::arreter()
+{
+    enMarche = false;
+    timer->stop();
+    //les commandes déposées juste avant l'arrêt ne doivent pas attendre la reprise.
+    if(!vidageDemande.exchange(true))
+        QMetaObject::invokeMethod(this, "appliquerCommandes", Qt::QueuedConnection);
+}
+
+bool SimEngine::estEnMarche() const
+{
+    return enMarche;
+}
+
+void SimEngine::setLimiteTempsReel(bool limite)
+{
+    limiteTempsReel = limite;
+    retardMs = 0;
+    etatsPrecedents.clear();
+    horloge.restart();
+    //sans limitation, le timer se déclenche dès que la boucle d'événements est libre.
+    timer->setInterval(limite ? 1000/FRAME_RATE : 0);
+}
+
+bool SimEngine::getLimiteTempsReel() const
+{
+    return limiteTempsReel;
+}
+
+void SimEngine::setPasMaximum(qint64 nbPas)
+{
+    pasMaximum = nbPas;
+}
+
+qint64 SimEngine::getNumeroPas() const
+{
+    return numeroPas;
+}
+
+void SimEngine::timerTrigger()
+{
+    if(!limiteTempsReel)
+    {
+        //sans limitation, on effectue plusieurs pas entre deux passages dans la boucle
+        //d'événements, afin que les commandes du programme client restent traitées.
+        executer(PAS_PAR_LOT);
+        emit pasEffectues();
+        return;
+    }
+
+    //le temps réel écoulé depuis le déclenchement précédent est simulé par pas fixes.
+    retardMs += horloge.nsecsElapsed() / 1000000.0;
+    horloge.restart();
+
+    int nbPas = (int) (retardMs / PAS_SIMULATION);
+    if(nbPas > PAS_MAX_PAR_TRAME)
+    {
+        nbPas = PAS_MAX_PAR_TRAME;
+        retardMs = nbPas * PAS_SIMULATION;
+    }
+    retardMs -= nbPas * PAS_SIMULATION;
+
+    if(nbPas > 0)
+    {
+        executer(nbPas - 1);
+        etatsPrecedents = instantane();
+        executer(1);
+    }
+    emit pasEffectues();
+}
+
+void SimEngine::executer(int nbPas)
+{
+    for(int i = 0; i < nbPas; i++)
+    {
+        if(!enMarche)
+            return;
+
+        pas();
+
+        if(pasMaximum > 0 && numeroPas >= pasMaximum)
+        {
+            arreter();
+            emit simulationTerminee();
+            return;
+        }
+    }
+}
+
+/** indique si une voie est occupée par une autre loco que l.
+  */
+static inline bool occupeeParAutre(Voie* v, Loco* l)
+{
+    return v->getNbreLocos() - (v == l->getVoie() ? 1 : 0) > 0;
+}
+
+void SimEngine::deposerCommande(const Commande &commande)
+{
+    commandes.deposer(commande);
+
+    //simulation arrêtée : aucun pas ne viendra vider la file.
+    if(!enMarche && !vidageDemande.exchange(true))
+        QMetaObject::invokeMethod(this, "appliquerCommandes", Qt::QueuedConnection);
+}
+
+int SimEngine::getEtatVoieVariable(int numVoieVariable, quint64 *version) const
+{
+    return etatsAiguillages.getEtat(numVoieVariable, version);
+}
+
+void SimEngine::appliquerCommandes()
+{
+    vidageDemande = false;
+
+    Commande c;
+    while(commandes.retirer(c))
+    {
+        //en rejeu, seules les commandes de la trace sont appliquées.
+        if(lecteur == nullptr)
+            appliquerCommande(c);
+    }
+
+    if(lecteur != nullptr)
+    {
+        while(lecteur->commandeSuivante(c))
+            appliquerCommande(c);
+    }
+}
+
+void SimEngine::appliquerCommande(const Commande &c)
+{
+    //une voie variable déjà dans l'état demandé n'est pas commandée à nouveau. Le test est
+    //fait ici, sur le thread du moteur, contre l'état appliqué : des commandes opposées
+    //déposées en même temps par plusieurs clients sont toutes appliquées, dans l'ordre de la file.
+    if(c.type == Commande::VOIE_VARIABLE && etatsAiguillages.getEtat(c.numero, nullptr) == c.valeur)
+        return;
+
+    if(enregistreur != nullptr)
+        enregistreur->commande(c);
+
+    switch(c.type)
+    {
+    case Commande::AJOUTER_LOCO:
+        ajouterLoco(c.numero);
+        break;
+    case Commande::PLACER_LOCO:
+        setLoco(c.contactA, c.contactB, c.numero, c.valeur);
+        break;
+    case Commande::VITESSE_LOCO:
+        JournalEvenements::getInstance()->enregistrer(JournalEvenements::VITESSE, c.numero, 0, c.valeur);
+        setVitesseLoco(c.numero, c.valeur);
+        break;
+    case Commande::VITESSE_PROGRESSIVE_LOCO:
+        JournalEvenements::getInstance()->enregistrer(JournalEvenements::VITESSE, c.numero, 1, c.valeur);
+        setVitesseProgressiveLoco(c.numero, c.valeur);
+        break;
+    case Commande::INVERSER_LOCO:
+        reverseLoco(c.numero);
+        break;
+    case Commande::VOIE_VARIABLE:
+        JournalEvenements::getInstance()->enregistrer(JournalEvenements::AIGUILLAGE, -1, c.numero, c.valeur);
+        setVoieVariable(c.numero, c.valeur);
+        break;
+    }
+}
+
+void SimEngine::pas()
+{
+    numeroPas++;
+
+    if(enregistreur != nullptr)
+        enregistreur->setPas(numeroPas);
+    if(lecteur != nullptr)
+        lecteur->setPas(numeroPas);
+
+    appliquerCommandes();
+
+    QList<Loco*> listeLocos = this->Locos.values();
+
+    //l'inertie progresse au rythme du temps simulé, et non de l'horloge murale.
+    foreach(Loco* l, listeLocos)
+        l->avancerInertie(PAS_SIMULATION);
+
+    foreach(Loco* l, listeLocos)
+    {
+        if(l->getActive() && l->getVoie() != nullptr && l->getVitesse() != 0)
+            l->avancer((l->getVitesse() * PAS_SIMULATION) * FACTEUR_VITESSE);
+    }
+
+    detecterCollisions(listeLocos);
+
+    foreach(Loco* l, listeLocos)
+    {
+        if(l->getActive() && l->getVoie() != nullptr)
+        {
+            //alerte proximite : on parcourt les voies à venir sur la distance de
+            //sécurité, en consultant l'occupation tenue à jour par les locos.
+            qreal distanceSecurite = l->getVitesse() * 2000.0 * FACTEUR_VITESSE;
+
+            Voie* precedente = l->getVoie();
+            Voie* courante = l->getVoieSuivante();
+
+            bool tropProche = occupeeParAutre(precedente, l);
+
+            if(courante != nullptr)
+            {
+                tropProche = tropProche || occupeeParAutre(courante, l);
+                distanceSecurite -= courante->getLongueurAParcourir();
+            }
+
+            while(!tropProche && courante != nullptr && distanceSecurite > 0)
+            {
+                Voie* suivante = courante->getVoieSuivante(precedente);
+                precedente = courante;
+                courante = suivante;
+                if(courante != nullptr)
+                {
+                    tropProche = occupeeParAutre(courante, l);
+                    distanceSecurite -= courante->getLongueurAParcourir();
+                }
+            }
+
+            l->setAlerteProximite(tropProche);
+        }
+    }
+}
+
+void SimEngine::detecterCollisions(const QList<Loco*> &listeLocos)
+{
+    //seules les locos posées sur une voie participent à la détection.
+    rectanglesLocos.resize(listeLocos.size());
+    locosPresentes.resize(listeLocos.size());
+
+    for(int i = 0; i < listeLocos.size(); i++)
+    {
+        locosPresentes[i] = (listeLocos.at(i)->getVoie() != nullptr);
+        if(locosPresentes.at(i))
+            rectanglesLocos[i] = listeLocos.at(i)->getRectangle();
+    }
+
+    detecterChevauchements(grilleCollision, rectanglesLocos, locosPresentes, pairesEnCollision);
+
+    for(int p = 0; p < pairesEnCollision.size(); p++)
+    {
+        Loco* l = listeLocos.at(pairesEnCollision.at(p).first);
+        Loco* otherLoco = listeLocos.at(pairesEnCollision.at(p).second);
+
+        //deux locos déjà arrêtées par une collision ne la signalent plus.
+        if(!l->getActive() && !otherLoco->getActive())
+            continue;
+
+        arreter();
+        l->setActive(false);
+        otherLoco->setActive(false);
+        JournalEvenements::getInstance()->enregistrer(JournalEvenements::COLLISION, l->getNumLoco(), otherLoco->getNumLoco());
+        emit collision(l, otherLoco);
+    }
+}
+
+QVector<EtatLoco> SimEngine::instantane() const
+{
+    QVector<EtatLoco> etats;
+    etats.reserve(Locos.size());
+
+    foreach(Loco* l, Locos)
+    {
+        EtatLoco e;
+        e.numLoco = l->getNumLoco();
+        e.position = l->getPosition();
+        e.orientation = l->getOrientation();
+        e.active = l->getActive();
+        e.alerteProximite = l->getAlerteProximite();
+        etats.append(e);
+    }
+    return etats;
+}
+
+QVector<EtatLoco> SimEngine::instantaneAffichage() const
+{
+    QVector<EtatLoco> etats = instantane();
+    if(!limiteTempsReel || !enMarche)
+        return etats;
+
+    //fraction du pas suivant déjà écoulée en temps réel.
+    qreal alpha = qBound(0.0, (retardMs + horloge.nsecsElapsed() / 1000000.0) / PAS_SIMULATION, 1.0);
+
+    for(int i = 0; i < etats.size(); i++)
+    {
+        //une loco ajoutée depuis le pas précédent est affichée telle quelle.
+        if(i >= etatsPrecedents.size() || etatsPrecedents.at(i).numLoco != etats.at(i).numLoco)
+            continue;
+
+        const EtatLoco &avant = etatsPrecedents.at(i);
+        EtatLoco &e = etats[i];
+        e.position = avant.position + (e.position - avant.position) * alpha;
+
+        //rotation par le plus petit angle.
+        qreal ecart = remainder(e.orientation - avant.orientation, 360.0);
+        e.orientation = avant.orientation + ecart * alpha;
+    }
+    return etats;
+}
+
+void SimEngine::setLoco(int contactA, int contactB, int numLoco, int vitesseLoco)
+{
+    Segment* s = getSegmentByContacts(contactA, contactB);
+
+    if (s == nullptr)
+    {
+        erreurFatale(QString("Les numéros de contact (%1,%2) entre lesquels se trouve la loco ne sont pas valides. Ils doivent être directement voisins.\nL'application va se terminer.").arg(contactA).arg(contactB));
+    }
+
+    Voie* v = s->getMilieu();
+
+
+    Loco* l = this->Locos.value(numLoco);
+
+    this->Locos.value(numLoco)->setVitesse(vitesseLoco);
+
+    l->placer(v, contactA > contactB ? s->getSuivantMilieu() : s->getPrecedentMilieu());
+    l->setSegmentActuel(s);
+    oublierEtatPrecedent(l);
+
+    emit locoPlacee();
+}
+
+void SimEngine::setVitesseLoco(int numLoco, int vitesseLoco)
+{
+    if (!checkLoco(numLoco))
+        return;
+    this->Locos.value(numLoco)->setVitesse(vitesseLoco);
+}
+
+void SimEngine::reverseLoco(int numLoco)
+{
+    if (!checkLoco(numLoco))
+        return;
+    this->Locos.value(numLoco)->inverserSens();
+    oublierEtatPrecedent(this->Locos.value(numLoco));
+    emit locoPlacee();
+}
+
+void SimEngine::oublierEtatPrecedent(Loco *l)
+{
+    //l'état précédent prend la valeur actuelle : le saut n'est pas interpolé.
+    for(int i = 0; i < etatsPrecedents.size(); i++)
+    {
+        if(etatsPrecedents.at(i).numLoco != l->getNumLoco())
+            continue;
+        etatsPrecedents[i].position = l->getPosition();
+        etatsPrecedents[i].orientation = l->getOrientation();
+    }
+}
+
+void SimEngine::setVitesseProgressiveLoco(int numLoco, int vitesseLoco)
+{
+    if (!checkLoco(numLoco))
+        return;
+    this->Locos.value(numLoco)->setVitesse(vitesseLoco); //similaire à setVitesseLoco!
+}
+
+void SimEngine::stopLoco(int numLoco)
+{
+    if (!checkLoco(numLoco))
+        return;
+    this->Locos.value(numLoco)->setVitesse(0);
+}
+
+void SimEngine::setVoieVariable(int numVoieVariable, int direction)
+{
+    if (!checkVoieVariable(numVoieVariable))
+        return;
+    this->VoiesVariables.value(numVoieVariable)->setEtat(direction);
+}
+
+void SimEngine::locoSurNouveauSegment(Contact *ctc1, Contact *ctc2, Loco *l)
+{
+    l->setSegmentActuel(getSegmentByContacts(ctc1->getNumContact(), ctc2->getNumContact()));
+}
+
+void SimEngine::voieVariableModifiee(Voie *v)
+{
+    VoieVariable* vv = static_cast<VoieVariable*>(v);
+    etatsAiguillages.appliquer(vv->getNumVoieVariable(), vv->getEtat());
+
+    notificationVoieVariableModifiee(v);
+    emit locoPlacee();
+}
+
+void SimEngine::erreurFatale(QString message)
+{
+    arreter();
+    emit erreur(message);
+    exit(-1);
+}
+
+bool SimEngine::checkLoco(int numLoco)
+{
+    if (!this->Locos.contains(numLoco))
+    {
+        erreurFatale(QString("La loco %1 n'existe pas!\nL'application va se terminer.").arg(numLoco));
+    }
+    return true;
+}
+
+bool SimEngine::checkVoieVariable(int numVoie)
+{
+    if (!this->VoiesVariables.contains(numVoie))
+    {
+        erreurFatale(QString("La voie variable %1 n'existe pas sur la maquette sélectionnée!\nL'application va se terminer.").arg(numVoie));
+    }
+    return true;
+}
@@ -0,0 +1,534 @@
+#ifndef SIMENGINE_H
+#define SIMENGINE_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QVector>
+#include <QTimer>
+#include <QSemaphore>
+#include <QElapsedTimer>
+
+#include <atomic>
+
+#include "general.h"
+#include "voie.h"
+#include "voievariable.h"
+#include "contact.h"
+#include "loco.h"
+#include "segment.h"
+#include "collision.h"
+#include "filecommandes.h"
+#include "trace.h"
+#include "itineraires.h"
+#include "etatsaiguillages.h"
+
+/**
+  Etat instantané d'une loco, tel qu'il est lu par le rendu.
+  Ne contient que des données simples, copiées à la fin d'un pas de simulation.
+  */
+struct EtatLoco
+{
+    int numLoco;
+    QPointF position;
+    qreal orientation;
+    bool active;
+    bool alerteProximite;
+};
+
+/**
+  Description d'une voie lue dans le fichier d'une maquette.
+  */
+struct DescriptionVoie
+{
+    int id;
+    //! type de la voie, tel que codé dans infosVoies (1 : droite, 2 : courbe, ...).
+    int type;
+    //! paramètres du constructeur de la voie.
+    QVector<qreal> parametres;
+    //! identifiants des voies liées, dans l'ordre des extrémités.
+    QVector<int> liens;
+};
+
+/**
+  Description complète d'une maquette, telle que lue dans son fichier texte.
+  */
+struct DescriptionMaquette
+{
+    QVector<DescriptionVoie> voies;
+    //! paires (numéro du contact, voie porteuse).
+    QVector<QPair<int, int> > contacts;
+    //! paires (numéro de l'aiguillage, voie variable).
+    QVector<QPair<int, int> > voiesVariables;
+    int premiereVoie;
+};
+
+/**
+  Moteur de simulation.
+  Possède les voies, contacts, segments et locos de la maquette, et fait avancer
+  la simulation par pas de temps fixes (PAS_SIMULATION). Le moteur n'utilise aucun
+  widget : il peut tourner sans affichage, aussi vite que le processeur le permet,
+  ou être limité au rythme du temps réel.
+  */
+class SimEngine : public QObject
+{
+    Q_OBJECT
+public:
+    /** Constructeur de classe
+      * \param parent le parent du moteur.
+      */
+    explicit SimEngine(QObject *parent = 0);
+
+    /** Destructeur de classe.
+      */
+    ~SimEngine();
+
+    /** Charge et construit la maquette décrite par un fichier.
+      * \param filename le nom du fichier de la maquette à charger.
+      */
+    void chargerMaquette(QString filename);
+
+    /** Permet d'ajouter une voie à la simulation.
+      * \param v la voie à ajouter
+      * \param ID le numéro de la voie
+      */
+    void addVoie(Voie* v, int ID);
+
+    /** Permet d'ajouter une voie variable à la liste idoine de la simulation.
+      * \param vv la voie variable à ajouter
+      * \param ID le numéro de la voie variable
+      */
+    void addVoieVariable(VoieVariable* vv, int ID);
+
+    /** Permet d'ajouter une contact à la simulation.
+      * \param c le contact à ajouter
+      * \param ID le numéro du contact
+      */
+    void addContact(Contact* c, int ID);
+
+    /** Permet d'indiquer la première voie à poser, par rapport à laquelle
+      * toutes les autres voies vont se positionner.
+      * \param v le voie a poser en premier.
+      */
+    void setPremiereVoie(Voie* v);
+
+    /** Lance la construction de la maquette (placement des voies, etc...)
+      */
+    void construireMaquette();
+
+    /** supprime toutes les voies, contacts, etc... en vue d'un nouveau chargement.
+      */
+    void viderMaquette();
+
+    /** Génére la liste des segments de la maquette.
+      */
+    void genererSegments();
+
+    /** Ajoute une locomotive.
+      * \param l la loco à ajouter.
+      * \param ID le numéro de la loco.
+      */
+    void addLoco(Loco* l, int ID);
+
+    /** retourne les voies de la maquette.
+      * \return les voies de la maquette.
+      */
+    QList<Voie*> getVoies() const;
+
+    /** retourne les locos de la simulation.
+      * \return les locos de la simulation.
+      */
+    QList<Loco*> getLocos() const;
+
+    /** retourne la loco ayant le numéro n.
+      * \param n le numéro de la loco
+      * \return la loco correspondante, nullptr si elle n'existe pas.
+      */
+    Loco* getLoco(int n) const;
+
+    /** retourne le contact ayant le numéro n.
+      * \param n le numéro du contact
+      * \return le contact correspondant.
+      */
+    Contact* getContact(int n) const;
+
+    /** retourne les segments contenant une voie. Une voie portant un contact termine
+      * deux segments ; un aiguillage peut appartenir à plusieurs segments.
+      * \param v la voie.
+      * \return les segments contenant la voie, en temps constant.
+      */
+    QList<Segment*> getSegmentsDeVoie(Voie* v) const;
+
+    /** retourne le segment sur lequel se trouve une loco.
+      * \param numLoco le numéro de la loco.
+      * \return le segment occupé par la loco, nullptr si elle n'est pas placée.
+      */
+    Segment* getSegmentDeLoco(int numLoco) const;
+
+    /** retourne les identifiants des voies du segment reliant deux contacts voisins.
+      * Les segments ne changent plus une fois la maquette chargée : la méthode peut
+      * être appelée depuis les threads clients.
+      * \param contactA et contactB les contacts définissant le segment.
+      * \return les voies du segment, dans l'ordre du parcours ; vide si les contacts ne sont pas voisins.
+      */
+    QVector<int> getVoiesSegment(int contactA, int contactB) const;
+
+    /** calcule l'itinéraire passant successivement par des contacts, ou le retrouve dans le cache.
+      * Peut être appelée depuis les threads clients une fois la maquette chargée.
+      * \param etapes les contacts à visiter ; le premier est le contact de départ.
+      * \param erreur reçoit la description de l'erreur le cas échéant.
+      * \return le numéro de l'itinéraire, -1 s'il n'existe pas.
+      */
+    int calculerItineraire(const QVector<int> &etapes, QString &erreur);
+
+    /** retourne un itinéraire calculé.
+      * \param numero le numéro de l'itinéraire.
+      * \param itineraire reçoit l'itinéraire.
+      * \return faux si le numéro n'est pas valide.
+      */
+    bool getItineraire(int numero, Itineraire &itineraire) const;
+
+    /** Effectue un pas de simulation, d'une durée simulée de PAS_SIMULATION ms.
+      */
+    void pas();
+
+    /** Enchaine plusieurs pas de simulation dans le thread appelant.
+      * Sans limitation au temps réel, les pas s'enchainent aussi vite que possible.
+      * S'interrompt dès que la simulation est arrêtée, par exemple par une collision.
+      * \param nbPas le nombre de pas à effectuer.
+      */
+    void executer(int nbPas);
+
+    /** Permet de limiter (ou non) la simulation au rythme du temps réel.
+      * Limitée, la simulation effectue à chaque déclenchement du timer autant de pas
+      * que le temps réel écoulé en contient : un déclenchement tardif ou manqué ne
+      * ralentit pas la simulation, et le pas simulé reste fixe quelle que soit la
+      * charge de l'affichage.
+      * \param limite vrai pour suivre l'horloge murale, faux pour aller au plus vite.
+      */
+    void setLimiteTempsReel(bool limite);
+
+    /** indique si la simulation est limitée au rythme du temps réel.
+      * \return vrai si la simulation suit l'horloge murale.
+      */
+    bool getLimiteTempsReel() const;
+
+    /** Fixe un nombre de pas après lequel la simulation s'arrête d'elle-même.
+      * \param nbPas le nombre de pas maximum, 0 pour une simulation sans fin.
+      */
+    void setPasMaximum(qint64 nbPas);
+
+    /** retourne le nombre de pas effectués depuis le chargement de la maquette.
+      * \return le numéro du pas courant.
+      */
+    qint64 getNumeroPas() const;
+
+    /** indique si la simulation est en cours.
+      * \return vrai si la simulation avance.
+      */
+    bool estEnMarche() const;
+
+    /** retourne l'état instantané de toutes les locos.
+      * \return un tableau contenant l'état de chaque loco.
+      */
+    QVector<EtatLoco> instantane() const;
+
+    /** retourne l'état des locos à afficher. Limitée au temps réel, la simulation a
+      * toujours une fraction de pas d'avance sur l'horloge murale : les positions sont
+      * interpolées entre les deux derniers pas selon cette fraction, de sorte que le
+      * mouvement affiché reste régulier quel que soit le rythme de l'affichage.
+      * \return un tableau contenant l'état affiché de chaque loco.
+      */
+    QVector<EtatLoco> instantaneAffichage() const;
+
+    /** Transmet une commande du programme client au moteur. Peut être appelée depuis
+      * n'importe quel thread, sans allocation : la commande est déposée dans une file
+      * sans verrou, vidée au début du pas suivant dans l'ordre des dépôts.
+      * Lorsque la simulation est arrêtée, la file est vidée par la boucle d'événements.
+      * \param commande la commande à transmettre.
+      */
+    void deposerCommande(const Commande &commande);
+
+    /** retourne l'état d'une voie variable, tel qu'appliqué par le moteur. Peut être
+      * appelée depuis n'importe quel thread, sans verrou.
+      * \param numVoieVariable le numéro de la voie variable.
+      * \param version reçoit, s'il n'est pas nul, le nombre de changements d'état de la voie.
+      * \return l'état de la voie, DIRECTION_INCONNUE s'il n'a jamais été appliqué.
+      */
+    int getEtatVoieVariable(int numVoieVariable, quint64 *version) const;
+
+    /** Enregistre la simulation dans une trace binaire : commandes appliquées,
+      * activations de contacts et pas auxquels elles surviennent.
+      * \param nomFichier le nom du fichier de la trace.
+      * \return vrai si le fichier a pu être créé.
+      */
+    bool enregistrerTrace(const QString &nomFichier);
+
+    /** Rejoue une trace : les commandes de la trace sont appliquées à leur pas
+      * d'origine à la place de celles des threads clients, les activations de contacts
+      * sont comparées à celles enregistrées, et la simulation s'arrête au dernier pas
+      * de la trace.
+      * \param nomFichier le nom du fichier de la trace.
+      * \param erreur reçoit la description de l'erreur le cas échéant.
+      * \return vrai si la trace a pu être lue.
+      */
+    bool rejouerTrace(const QString &nomFichier, QString &erreur);
+
+    /** indique si la simulation rejoue une trace.
+      * \return vrai en cours de rejeu.
+      */
+    bool estEnRejeu() const;
+
+    /** établit le rapport du rejeu.
+      * \param conforme reçoit vrai si le rejeu est identique à la trace.
+      * \return le texte du rapport.
+      */
+    QString rapportRejeu(bool &conforme) const;
+
+    /** Sémaphore relâché à la fin de chaque chargement de maquette.
+      */
+    QSemaphore maquetteChargee;
+
+signals:
+    /** Signale qu'une ou plusieurs étapes de simulation ont été effectuées.
+      */
+    void pasEffectues();
+
+    /** Signale une collision entre deux locos. La simulation est arrêtée.
+      * \param l1 la première loco
+      * \param l2 la seconde loco
+      */
+    void collision(Loco* l1, Loco* l2);
+
+    /** Signale que le nombre de pas maximum a été atteint.
+      */
+    void simulationTerminee();
+
+    /** Signale que la maquette a été construite (voies placées, segments générés).
+      */
+    void maquetteConstruite();
+
+    /** Signale l'ajout d'une loco à la simulation.
+      * \param l la loco ajoutée.
+      */
+    void locoAjoutee(Loco* l);
+
+    /** Signale qu'une loco a été déplacée hors d'un pas de simulation
+      * (placement initial, inversion, déraillement).
+      */
+    void locoPlacee();
+
+    /** Signale une erreur fatale. L'application se termine juste après.
+      * \param message la description de l'erreur.
+      */
+    void erreur(QString message);
+
+    /** Signale qu'une loco a changé de segment, et se trouve que le segment s.
+      * \param s, le segment occupé.
+      */
+    void locoSurSegment(Segment* s);
+
+    /** Signale le changment d'état d'une voie variable.
+      * \param v la voie variable ayant changé.
+      */
+    void notificationVoieVariableModifiee(Voie* v);
+
+public slots:
+    /** démarre la simulation
+      */
+    void demarrer();
+
+    /** termine l'enregistrement de la trace, s'il y en a un.
+      */
+    void terminerTrace();
+
+    /** stoppe la simulation
+      */
+    void arreter();
+
+    /** Charge la maquette désignée par son nom.
+      * Termine l'application si la maquette n'existe pas.
+      * \param maquette le nom de la maquette.
+      */
+    void selectionMaquette(QString maquette);
+
+    /** Crée une loco et l'ajoute à la simulation.
+      * \param numLoco le numéro de la loco.
+      */
+    void ajouterLoco(int numLoco);
+
+    /** prépare la locomotive au départ.
+      * \param contactA le premier contact définissant le segment sur lequel se trouve la loco.
+      * \param contactB le second contact définissant le segment sur lequel se trouve la loco.
+      * \param numLoco le numéro de la loco à placer.
+      * \param vitesseLoco la vitesse de la loco.
+      */
+    void setLoco(int contactA, int contactB, int numLoco, int vitesseLoco);
+
+    /** permet de changer la vitesse d'une loco.
+      * \param numLoco le numéro de la loco à changer
+      * \param vitesseLoco la nouvelle vitesse de la loco.
+      */
+    void setVitesseLoco(int numLoco, int vitesseLoco);
+
+    /** Inverse le sens de la loco.
+      * \param numLoco le numéro de la loco à inverser.
+      */
+    void reverseLoco(int numLoco);
+
+    /** permet de changer la vitesse d'une loco.
+      * \param numLoco le numéro de la loco à changer
+      * \param vitesseLoco la nouvelle vitesse de la loco.
+      */
+    void setVitesseProgressiveLoco(int numLoco, int vitesseLoco);
+
+    /** arrete la loco
+      * \param numLoco le numéro de la loco.
+      */
+    void stopLoco(int numLoco);
+
+    /** modifie l'etat d'une voie variable.
+      * \param numVoieVariable le numéro de la voie variable.
+      * \param direction la nouvelle direction de la voie (DEVIE ou TOUT_DROIT)
+      */
+    void setVoieVariable(int numVoieVariable, int direction);
+
+    /** reçoit l'information qu'une loco a changé de segment.
+      * \param ctc1 et ctc2 définissent le segment.
+      * \param l la loco ayant changé de segment.
+      */
+    void locoSurNouveauSegment(Contact* ctc1, Contact* ctc2, Loco* l);
+
+    /** reçoit l'information qu'une voie variable a été modifiée.
+      * \param v la voie variable modifiée.
+      */
+    void voieVariableModifiee(Voie* v);
+
+protected slots:
+    /** Effectue les pas de simulation dus à chaque déclenchement du timer.
+      */
+    void timerTrigger();
+
+    /** Applique, dans l'ordre de leur dépôt, toutes les commandes en attente dans la file.
+      * En rejeu, ces commandes sont ignorées au profit de celles de la trace.
+      */
+    void appliquerCommandes();
+
+private:
+    QTimer* timer;
+    QMap<int, Voie*> Voies;
+    QMap<int, VoieVariable*> VoiesVariables;
+    QMap<int, Contact*> contacts;
+    Voie* premiereVoie;
+    QMap<int, Loco*> Locos;
+    QList<Segment*> segments;
+    //! segments indexés par paire de contacts : case (min * dimensionSegments + max).
+    QVector<Segment*> tableSegments;
+    int dimensionSegments;
+    //! segments contenant chaque voie, indexés par identifiant de voie.
+    QVector<QList<Segment*> > segmentsParVoie;
+    Itineraires itineraires;
+    EtatsAiguillages etatsAiguillages;
+    QMap <int, QList<double>*> infosVoies;
+    bool limiteTempsReel;
+    //! horloge murale, relancée à chaque déclenchement du timer.
+    QElapsedTimer horloge;
+    //! temps réel écoulé non encore simulé, en millièmes de secondes (moins d'un pas).
+    qreal retardMs;
+    //! état des locos avant le dernier pas, pour l'interpolation de l'affichage.
+    QVector<EtatLoco> etatsPrecedents;
+    //! lu par les threads clients déposant une commande.
+    std::atomic<bool> enMarche;
+    FileCommandes commandes;
+    //! vrai lorsqu'un vidage de la file a déjà été demandé à la boucle d'événements.
+    std::atomic<bool> vidageDemande;
+    EnregistreurTrace* enregistreur;
+    LecteurTrace* lecteur;
+    qint64 numeroPas;
+    qint64 pasMaximum;
+    GrilleCollision grilleCollision;
+    QVector<RectangleOriente> rectanglesLocos;
+    QVector<bool> locosPresentes;
+    QVector<QPair<int, int> > pairesEnCollision;
+
+    /** Applique une commande du programme client, et l'enregistre le cas échéant.
+      * \param c la commande.
+      */
+    void appliquerCommande(const Commande &c);
+
+    /** Détecte les collisions entre locos et arrête la simulation le cas échéant.
+      * \param listeLocos les locos de la simulation.
+      */
+    void detecterCollisions(const QList<Loco*> &listeLocos);
+
+    /** Aligne l'état précédent d'une loco sur son état actuel, après un placement ou
+      * une inversion, afin que instantaneAffichage n'interpole pas à travers le saut.
+      * \param l la loco.
+      */
+    void oublierEtatPrecedent(Loco *l);
+
+    /** Lit le fichier de description des types de voies.
+      */
+    void chargerInfosVoies();
+
+    /** Lit le fichier texte d'une maquette.
+      * \param filename le nom du fichier de la maquette.
+      * \param description reçoit la description de la maquette.
+      */
+    void lireMaquette(QString filename, DescriptionMaquette &description);
+
+    /** Crée les voies, contacts et aiguillages d'une maquette et lie les voies entre elles.
+      * \param description la description de la maquette.
+      */
+    void instancierMaquette(const DescriptionMaquette &description);
+
+    /** Crée une voie d'après son type.
+      * \param type le type de la voie, tel que codé dans infosVoies.
+      * \param p les paramètres du constructeur de la voie.
+      * \return la voie créée, nullptr si le type est inconnu.
+      */
+    static Voie* creerVoie(int type, const QVector<qreal> &p);
+
+    /** Calcule l'empreinte d'une maquette : fichier texte, infosVoies.txt et version du cache.
+      * \param filename le nom du fichier de la maquette.
+      * \return l'empreinte.
+      */
+    QByteArray empreinteMaquette(QString filename);
+
+    /** Construit la maquette depuis son cache binaire : description, géométrie résolue
+      * de chaque voie et table des segments. Le cache est projeté en mémoire.
+      * \param fichierCache le nom du fichier du cache.
+      * \param empreinte l'empreinte attendue de la maquette.
+      * \return vrai si la maquette a été construite, faux si le cache est absent, périmé ou invalide.
+      */
+    bool chargerCache(QString fichierCache, const QByteArray &empreinte);
+
+    /** Ecrit le cache binaire d'une maquette qui vient d'être construite.
+      * \param fichierCache le nom du fichier du cache.
+      * \param empreinte l'empreinte de la maquette.
+      * \param description la description de la maquette.
+      */
+    void ecrireCache(QString fichierCache, const QByteArray &empreinte, const DescriptionMaquette &description);
+
+    /** Construit les index des segments : table par paire de contacts et
+      * segments de chaque voie. Appelée une fois les segments générés ou relus du cache.
+      */
+    void indexerSegments();
+
+    /** retourne le segment correspondant à la paire de contacts passée en paramètre
+      * \param contactA et contactB les contacts définissant les segment.
+      * \return le segment correspondant, nullptr si les contacts ne sont pas voisins.
+      */
+    Segment* getSegmentByContacts(int contactA, int contactB) const;
+
+    /** Signale une erreur fatale et termine l'application.
+      * \param message la description de l'erreur.
+      */
+    void erreurFatale(QString message);
+
+    bool checkLoco(int numLoco);
+
+    bool checkVoieVariable(int numVoie);
+};
+
+#endif // SIMENGINE_H
@@ -1,110 +1,193 @@
+#include <QStyleOptionGraphicsItem>
+#include <math.h>
+
 #include "simview.h"
+#include "voievariable.h"
+#include "trainsimsettings.h"
 
-SimView::SimView(QWidget */*parent*/)
+SimView::SimView(SimEngine *engine, QWidget */*parent*/)
     : QGraphicsView()
 {
+    this->engine = engine;
+    this->voiesFigees = TrainSimSettings::getInstance()->getVoiesFigees();
     scene = new QGraphicsScene();
     this->setScene(scene);
     this->setRenderHints(QPainter::Antialiasing);
-    timer = new QTimer(this);
-    CONNECT(timer, SIGNAL(timeout()), this, SLOT(animationStep()));
+    this->setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
+    //l'affichage a son propre rythme : le moteur peut effectuer zéro, un ou plusieurs
+    //pas entre deux images, instantaneAffichage interpolant entre les deux derniers.
+    timerAffichage = new QTimer(this);
+    timerAffichage->setInterval(1000/FRAME_RATE);
+    timerAffichage->setTimerType(Qt::PreciseTimer);
+    CONNECT(timerAffichage, SIGNAL(timeout()), this, SLOT(rafraichirLocos()));
+    timerAffichage->start();
+    CONNECT(engine, SIGNAL(locoPlacee()), this, SLOT(rafraichirLocos()));
+    CONNECT(engine, SIGNAL(maquetteConstruite()), this, SLOT(afficherMaquette()));
+    CONNECT(engine, SIGNAL(locoAjoutee(Loco*)), this, SLOT(afficherLoco(Loco*)));
+    CONNECT(engine, SIGNAL(collision(Loco*,Loco*)), this, SLOT(afficherCollision(Loco*,Loco*)));
 }
 
 void SimView::redraw()
 {
-    scene->update(sceneRect());
+    //les voies sont dessinées depuis leur cache : il doit être invalidé item par item.
+    foreach(QGraphicsItem* i, scene->items())
+        i->update();
+    tuiles.clear();
 }
 
-void SimView::addVoie(Voie *v, int ID)
+void SimView::setVoiesFigees(bool enable)
 {
-    this->Voies.insert(ID, v);
-    this->scene->addItem(v);
-    v->setVisible(true);
-}
+    voiesFigees = enable;
 
-void SimView::addContact(Contact *c, int ID)
-{
-    this->contacts.insert(ID, c);
-}
+    //une voie pré-rendue reste dans la scène, porteuse de son contact, mais n'est plus dessinée.
+    foreach(Voie* v, voiesFixes)
+        v->setFlag(QGraphicsItem::ItemHasNoContents, voiesFigees);
 
-void SimView::addVoieVariable(VoieVariable *vv, int ID)
-{
-    this->VoiesVariables.insert(ID, vv);
-    connect(vv, SIGNAL(etatModifie(Voie*)), this, SLOT(voieVariableModifiee(Voie*)));
+    tuiles.clear();
+    viewport()->update();
 }
 
-void SimView::setPremiereVoie(Voie *v)
+void SimView::drawBackground(QPainter *painter, const QRectF &rect)
 {
-    this->premiereVoie = v;
-}
+    QGraphicsView::drawBackground(painter, rect);
 
-void SimView::modifierAiguillage(int n, int v)
-{
-    this->VoiesVariables[n]->setEtat(v);
+    if(!voiesFigees || voiesFixes.isEmpty())
+        return;
+
+    //les tuiles ne sont valables que pour un zoom et une rotation donnés.
+    if(transform() != transformTuiles)
+    {
+        tuiles.clear();
+        transformTuiles = transform();
+    }
+
+    //seul le défilement doit séparer le repère des tuiles de celui du painter ;
+    //sinon (impression), les voies sont dessinées directement.
+    QTransform decalage = transformTuiles.inverted() * painter->worldTransform();
+    if(decalage.type() > QTransform::TxTranslate)
+    {
+        dessinerVoiesFixes(painter, rect);
+        return;
+    }
+
+    QRect zone = transformTuiles.mapRect(rect.intersected(rectVoiesFixes)).toAlignedRect();
+    if(zone.isEmpty())
+        return;
+
+    int premiereColonne = (int) floor((qreal) zone.left() / TAILLE_TUILE_FOND);
+    int derniereColonne = (int) floor((qreal) zone.right() / TAILLE_TUILE_FOND);
+    int premiereLigne = (int) floor((qreal) zone.top() / TAILLE_TUILE_FOND);
+    int derniereLigne = (int) floor((qreal) zone.bottom() / TAILLE_TUILE_FOND);
+
+    painter->save();
+    painter->resetTransform();
+    for(int i = premiereColonne; i <= derniereColonne; i++)
+    {
+        for(int j = premiereLigne; j <= derniereLigne; j++)
+        {
+            QPair<int, int> cle(i, j);
+            if(!tuiles.contains(cle))
+            {
+                //au-delà, les tuiles sont rendues de nouveau à mesure du défilement.
+                if(tuiles.size() >= NBRE_MAX_TUILES_FOND)
+                    tuiles.clear();
+                tuiles.insert(cle, rendreTuile(i, j));
+            }
+            painter->drawPixmap(QPointF(i * TAILLE_TUILE_FOND + qRound(decalage.dx()),
+                                        j * TAILLE_TUILE_FOND + qRound(decalage.dy())),
+                                tuiles.value(cle));
+        }
+    }
+    painter->restore();
 }
 
-void SimView::construireMaquette()
+QPixmap SimView::rendreTuile(int i, int j)
 {
-    this->premiereVoie->calculerAnglesEtCoordonnees();
+    QPixmap tuile(TAILLE_TUILE_FOND, TAILLE_TUILE_FOND);
+    tuile.fill(Qt::transparent);
 
-    this->premiereVoie->calculerPosition();
+    QTransform versTuile = transformTuiles * QTransform::fromTranslate(- i * TAILLE_TUILE_FOND,
+                                                                       - j * TAILLE_TUILE_FOND);
+    QRectF rectTuile = versTuile.inverted().mapRect(QRectF(tuile.rect()));
+
+    QPainter painter(&tuile);
+    painter.setRenderHints(renderHints());
+    QStyleOptionGraphicsItem option;
+    foreach(Voie* v, voiesFixes)
+    {
+        if(!v->sceneBoundingRect().intersects(rectTuile))
+            continue;
+        painter.setTransform(v->sceneTransform() * versTuile);
+        v->paint(&painter, &option, nullptr);
+    }
+    return tuile;
 }
 
-void SimView::viderMaquette()
+void SimView::dessinerVoiesFixes(QPainter *painter, const QRectF &rect)
 {
-    foreach(Voie* v, this->Voies)
-        delete v;
-
-    this->Voies.clear();
+    QStyleOptionGraphicsItem option;
+    foreach(Voie* v, voiesFixes)
+    {
+        if(!v->sceneBoundingRect().intersects(rect))
+            continue;
+        painter->save();
+        painter->setTransform(v->sceneTransform(), true);
+        v->paint(painter, &option, nullptr);
+        painter->restore();
+    }
 }
 
-void SimView::genererSegments()
+void SimView::afficherMaquette()
 {
-    for(int i = 1; i <= this->contacts.size(); i++)
+    //les voies de la maquette précédente ont été détruites avec elle.
+    voiesFixes.clear();
+    rectVoiesFixes = QRectF();
+    tuiles.clear();
+
+    foreach(Voie* v, engine->getVoies())
     {
-        QList<QList<Voie*>*> parcours;
-        parcours = this->Voies.value(contacts.value(i)->getNumVoiePorteuse())->startExplorationContactAContact();
+        this->scene->addItem(v);
+        v->setVisible(true);
+        //une voie ne change qu'à la commande d'un aiguillage : elle est rendue une fois
+        //par niveau de zoom, puis recopiée depuis son cache.
+        v->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
-        foreach(QList<Voie*>* lv, parcours)
+        if(qobject_cast<VoieVariable*>(v) == nullptr)
         {
-            if(lv->last()->getContact() != nullptr)
-            {
-                if(contacts.key(lv->first()->getContact()) < contacts.key(lv->last()->getContact()))
-                {
-                    segments.append(new Segment(lv->first()->getContact(), lv->last()->getContact(), *lv));
-                }
-            }
-            else
-            {
-                //gestion de segments entre un contact et une voie buttoir...
-                segments.append(new Segment(lv->first()->getContact(), nullptr, *lv));
-            }
-        }
-
-        // On détruit les QList*
-        while (!parcours.isEmpty()) {
-            QList<Voie*> *l = parcours.at(0);
-            delete l;
-            parcours.pop_front();
+            voiesFixes.append(v);
+            rectVoiesFixes |= v->sceneBoundingRect();
         }
     }
+
+    setVoiesFigees(voiesFigees);
+
+    zoomFit();
+
+    repaint();
 }
 
-void SimView::addLoco(Loco *l, int ID)
+void SimView::afficherLoco(Loco *l)
 {
-    this->Locos.insert(ID, l);
     this->scene->addItem(l);
 
-    CONNECT(l, SIGNAL(nouveauSegment(Contact*,Contact*,Loco*)), this, SLOT(locoSurNouveauSegment(Contact*,Contact*,Loco*)));
-    CONNECT(this, SIGNAL(locoSurSegment(Segment*)), l, SLOT(locoSurSegment(Segment*)));
-    CONNECT(this, SIGNAL(notificationVoieVariableModifiee(Voie*)), l, SLOT(voieVariableModifiee(Voie*)));
-
     peintLocos();
 }
 
+void SimView::rafraichirLocos()
+{
+    foreach(const EtatLoco &e, engine->instantaneAffichage())
+    {
+        Loco* l = engine->getLoco(e.numLoco);
+        //setPos et setRotation ne redessinent que les locos ayant bougé, sur leur
+        //ancien et leur nouveau rectangle englobant.
+        l->setPos(e.position);
+        l->setRotation(e.orientation);
+    }
+}
+
 void SimView::peintLocos()
 {
-    int nbreLocos = this->Locos.size();
+    int nbreLocos = engine->getLocos().size();
 
     int sigmaCouleur = 255 * 6 / nbreLocos;
 
@@ -112,7 +195,7 @@ void SimView::peintLocos()
 
     int r, g, b;
 
-    QList<Loco*> listeLocos = Locos.values();
+    QList<Loco*> listeLocos = engine->getLocos();
 
     for(int i=0; i < listeLocos.length(); i++)
     {
@@ -175,31 +258,6 @@ void SimView::zoomFit()
 }
 
 
-Contact* SimView::getContact(int n)
-{
-    return this->contacts.value(n);
-}
-
-Segment* SimView::getSegmentByContacts(int contactA, int contactB)
-{
-    int min = contactA < contactB ? contactA : contactB;
-    int max = contactA < contactB ? contactB : contactA;
-
-    foreach(Segment* s, this->segments)
-    {
-        if(s->relie(this->contacts.value(min), this->contacts.value(max)))
-            return s;
-    }
-    return nullptr;
-}
-
-void SimView::animationStart()
-{
-    timer->start(1000/FRAME_RATE);
-}
-
-
-
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
 #include <QThread>
@@ -229,214 +287,40 @@ protected:
 
 #endif // WITHSOUND
 
-void SimView::animationStep()
+void SimView::afficherCollision(Loco *l, Loco *otherLoco)
 {
-    QList<Loco*> listeLocos = this->Locos.values();
+    rafraichirLocos();
 
-    bool tropProche;
+    ExplosionItem *item=new ExplosionItem();
+    QPixmap img(":images/explosion.png");
+    item->setPixmap(img);
+    scene->addItem(item);
+    QPointF debPoint((l->getPosition().x()+otherLoco->getPosition().x())/2,
+                (l->getPosition().y()+otherLoco->getPosition().y())/2);
+    QPointF endPoint((l->getPosition().x()+otherLoco->getPosition().x())/2-256,
+                (l->getPosition().y()+otherLoco->getPosition().y())/2-256);
+    item->setPos(endPoint);
 
-    QList<Voie*> prochainesVoies;
+    QPropertyAnimation *animation1=new QPropertyAnimation(item, "pos");
+    animation1->setDuration(500);
+    animation1->setStartValue(debPoint);
+    animation1->setEndValue(endPoint);
 
-    foreach(Loco* l, listeLocos)
-    {
-        if(l->getActive() && l->getVoie() != nullptr)
-        {
-            if(l->getVitesse() != 0)
-                l->avancer((l->getVitesse() * 1000.0 / FRAME_RATE) * FACTEUR_VITESSE);
+    QPropertyAnimation *animation2=new QPropertyAnimation(item, "scale");
+    animation2->setDuration(500);
+    animation2->setStartValue(0.0);
+    animation2->setEndValue(1.0);
 
-            QPolygonF contourLoco = l->getContour();
-            QPolygonF contourAutreLoco;
-            //test de collision
-            foreach(Loco* otherLoco, listeLocos)
-            {
-                if(l != otherLoco)
-                {
-                    contourAutreLoco = otherLoco->getContour();
-
-                    if(contourLoco.subtracted(contourAutreLoco) != contourLoco)
-                    {
-                        animationStop();
-                        l->setActive(false);
-                        otherLoco->setActive(false);
-                        ExplosionItem *item=new ExplosionItem();
-                        QPixmap img(":images/explosion.png");
-                        item->setPixmap(img);
-                        scene->addItem(item);
-                        QPointF debPoint((l->pos().x()+otherLoco->pos().x())/2,
-                                    (l->pos().y()+otherLoco->pos().y())/2);
-                        QPointF endPoint((l->pos().x()+otherLoco->pos().x())/2-256,
-                                    (l->pos().y()+otherLoco->pos().y())/2-256);
-                        item->setPos(endPoint);
-
-                        QPropertyAnimation *animation1=new QPropertyAnimation(item, "pos");
-                        animation1->setDuration(500);
-                        animation1->setStartValue(debPoint);
-                        animation1->setEndValue(endPoint);
-
-                        QPropertyAnimation *animation2=new QPropertyAnimation(item, "scale");
-                        animation2->setDuration(500);
-                        animation2->setStartValue(0.0);
-                        animation2->setEndValue(1.0);
-
-                        QParallelAnimationGroup *animationGroup=new QParallelAnimationGroup();
-
-                        animationGroup->addAnimation(animation1);
-                        animationGroup->addAnimation(animation2);
-
-                        item->setZValue(ZVAL_EXPLOSION);
-                        item->show();
-                        animationGroup->start();
-#ifdef WITHSOUND
-                        SoundThread *thread=new SoundThread(this);
-                        thread->start();
-#endif // WITHSOUND
-                    }
-                }
-            }
+    QParallelAnimationGroup *animationGroup=new QParallelAnimationGroup();
 
+    animationGroup->addAnimation(animation1);
+    animationGroup->addAnimation(animation2);
 
-            //alerte proximite. Pas encore optimal.
-            qreal distanceSecurite = l->getVitesse() * 2000.0 * FACTEUR_VITESSE;
-
-            prochainesVoies.append(l->getVoie());
-            prochainesVoies.append(l->getVoieSuivante());
-            distanceSecurite -= prochainesVoies.last()->getLongueurAParcourir();
-
-            while(distanceSecurite > 0)
-            {
-                prochainesVoies.append(prochainesVoies.last()->getVoieSuivante(prochainesVoies.at(prochainesVoies.length()-2)));
-                distanceSecurite -= prochainesVoies.last()->getLongueurAParcourir();
-            }
-
-            tropProche = false;
-
-            foreach(Voie* v, prochainesVoies)
-            {
-                foreach(Loco* autreLoco, listeLocos)
-                {
-                    if(autreLoco != l && v == autreLoco->getVoie())
-                    {
-                        tropProche = true;
-                    }
-                }
-            }
-            if(tropProche)
-                l->setAlerteProximite(true);
-            else
-                l->setAlerteProximite(false);
-
-            prochainesVoies.clear();
-        }
-    }
-}
-
-void SimView::animationStop()
-{
-    timer->stop();
-}
-
-void SimView::setLoco(int contactA, int contactB, int numLoco, int vitesseLoco)
-{
-    Segment* s = getSegmentByContacts(contactA, contactB);
-
-    if (s == nullptr)
-    {
-        QMessageBox::warning(this,"Error",QString("Les numéros de contact (%1,%2) entre lesquels se trouve la loco ne sont pas valides. Ils doivent être directement voisins.\nL'application va se terminer.").arg(contactA).arg(contactB));
-        exit(-1);
-    }
-
-    Voie* v = s->getMilieu();
-
-
-    Loco* l = this->Locos.value(numLoco);
-
-    this->Locos.value(numLoco)->setVitesse(vitesseLoco);
-
-    l->setVoie(v);
-
-    l->setVoieSuivante(contactA > contactB ? s->getSuivantMilieu() : s->getPrecedentMilieu());
-
-    l->setPos(v->pos());
-
-    if(l->getVoieSuivante() == l->getVoie()->getVoieVoisineDOrdre(0))
-    {
-        l->setRotation(l->rotation() - v->getAngleDeg(0));
-        l->setAngleCumule(l->getAngleCumule() + v->getAngleDeg(0));
-    }
-    else
-    {
-        l->setRotation(l->rotation() + (- v->getAngleDeg(0) - 180.0) < 0.0 ? (- v->getAngleDeg(0) + 180.0) : (- v->getAngleDeg(0) - 180.0));
-        l->setAngleCumule(l->getAngleCumule() + ((v->getAngleDeg(0) - 180.0) < 0.0 ? (v->getAngleDeg(0) + 180.0) : (v->getAngleDeg(0) - 180.0)));
-    }
-}
-
-void SimView::askLoco(int /*contactA*/, int /*contactB*/)
-{
-    //prompter un message demandant le numLoco et la vitesse.
-}
-
-void SimView::setVitesseLoco(int numLoco, int vitesseLoco)
-{
-    if (!checkLoco(numLoco))
-        return;
-    this->Locos.value(numLoco)->setVitesse(vitesseLoco);
-}
-
-void SimView::reverseLoco(int numLoco)
-{
-    if (!checkLoco(numLoco))
-        return;
-    this->Locos.value(numLoco)->inverserSens();
-}
-
-void SimView::setVitesseProgressiveLoco(int numLoco, int vitesseLoco)
-{
-    if (!checkLoco(numLoco))
-        return;
-    this->Locos.value(numLoco)->setVitesse(vitesseLoco); //similaire à setVitesseLoco!
-}
-
-void SimView::stopLoco(int numLoco)
-{
-    if (!checkLoco(numLoco))
-        return;
-    this->Locos.value(numLoco)->setVitesse(0);
-}
-
-void SimView::setVoieVariable(int numVoieVariable, int direction)
-{
-    if (!checkVoieVariable(numVoieVariable))
-        return;
-    this->VoiesVariables.value(numVoieVariable)->setEtat(direction);
-}
-
-void SimView::locoSurNouveauSegment(Contact *ctc1, Contact *ctc2, Loco *l)
-{
-    l->setSegmentActuel(getSegmentByContacts(contacts.key(ctc1), contacts.key(ctc2)));
-}
-
-void SimView::voieVariableModifiee(Voie *v)
-{
-    notificationVoieVariableModifiee(v);
-}
-
-
-bool SimView::checkLoco(int numLoco)
-{
-    if (!this->Locos.contains(numLoco))
-    {
-        QMessageBox::critical(this,"Erreur",QString("La loco %1 n'existe pas!\nL'application va se terminer.").arg(numLoco));
-        exit(-1);
-    }
-    return true;
-}
-
-bool SimView::checkVoieVariable(int numVoie)
-{
-    if (!this->VoiesVariables.contains(numVoie))
-    {
-        QMessageBox::critical(this,"Erreur",QString("La voie variable %1 n'existe pas sur la maquette sélectionnée!\nL'application va se terminer.").arg(numVoie));
-        exit(-1);
-    }
-    return true;
+    item->setZValue(ZVAL_EXPLOSION);
+    item->show();
+    animationGroup->start();
+#ifdef WITHSOUND
+    SoundThread *thread=new SoundThread(this);
+    thread->start();
+#endif // WITHSOUND
 }
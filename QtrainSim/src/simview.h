@@ -3,13 +3,14 @@
 
 #include <QGraphicsView>
 #include <QGraphicsScene>
+#include <QHash>
+#include <QPair>
+#include <QPixmap>
 #include <QTimer>
 
 #include "connect.h"
-#include "voie.h"
-#include "voievariable.h"
 #include "loco.h"
-#include "segment.h"
+#include "simengine.h"
 
 
 class ExplosionItem :  public QObject, public QGraphicsPixmapItem
@@ -27,61 +28,9 @@ class SimView : public QGraphicsView
     Q_OBJECT
 public:
     /** Constructeur de classe
-      *
-      */
-    explicit SimView(QWidget *);
-
-    /** Permet d'ajouter une voie à la simulation.
-      * \param v la voie à ajouter
-      * \param ID le numéro de la voie
-      */
-    void addVoie(Voie* v, int ID);
-
-    /** Permet d'ajouter une voie variable à la liste idoine de la simulation.
-      * \param vv la voie variable à ajouter
-      * \param ID le numéro de la voie variable
-      * Remarque : une voie variable a donc deux numéros :
-      *            - son numéro de voie
-      *            - son numéro de voie variable
-      */
-    void addVoieVariable(VoieVariable* vv, int ID);
-
-    /** Permet d'ajouter une contact à la simulation.
-      * \param c le contact à ajouter
-      * \param ID le numéro du contact
+      * \param engine le moteur de simulation à afficher.
       */
-    void addContact(Contact* c, int ID);
-
-    /** Permet d'indiquer la première voie à poser, par rapport à laquelle
-      * toutes les autres voies vont se positionner.
-      * \param v le voie a poser en premier.
-      */
-    void setPremiereVoie(Voie* v);
-
-    /** Permet de modifier une voie variable.
-      * \param n le numéro de la voie variable.
-      * \param v l'etat de la voie variable (DEVIE ou TOUT_DROIT)
-      */
-    void modifierAiguillage(int n, int v);
-
-    /** Lance la construction de la maquette (placement des voies, etc...)
-      */
-    void construireMaquette();
-
-    /** supprime toutes les voies, contacts, etc... en vue d'un nouveau chargement.
-      */
-    void viderMaquette();
-
-    /** Génére la liste des segments de la maquette.
-      *
-      */
-    void genererSegments();
-
-    /** Ajoute une locomotive.
-      * \param l la loco à ajouter.
-      * \param ID le numéro de la loco.
-      */
-    void addLoco(Loco* l, int ID);
+    explicit SimView(SimEngine *engine, QWidget *);
 
     /** Attribue des couleurs à chaque locomotive présente, de telle manière qu'il soit
       * le plus facile de les distinguer.
@@ -104,116 +53,79 @@ public:
       */
     void zoomFit();
 
-    /** retourne le contact ayant le numéro n.
-      * \param n le numéro du contact
-      * \return le contact correspondant.
-      */
-    Contact* getContact(int n);
-
     /** raffraichit l'affichage.
       *
       */
     void redraw();
-signals:
 
-    /** Signale qu'une loco a changé de segment, et se trouve que le segment s.
-      * \param s, le segment occupé.
+    /** active ou désactive le pré-rendu des voies fixes.
+      * Les voies fixes (toutes sauf les voies variables) sont alors rendues une seule
+      * fois dans des tuiles, recopiées en fond de scène et recalculées uniquement lorsque
+      * le zoom ou la rotation changent. Les voies variables, les contacts et les locos
+      * restent des éléments de la scène dessinés par-dessus.
+      * \param enable vrai pour activer le pré-rendu.
       */
-    void locoSurSegment(Segment* s);
+    void setVoiesFigees(bool enable);
 
-    /** Signale le changment d'état d'une voie variable.
-      * \param v la voie variable ayant changé.
+protected:
+    /** dessine le fond de la scène, et les voies fixes lorsqu'elles sont pré-rendues.
+      * \param painter le painter de la vue.
+      * \param rect la zone à dessiner, en coordonnées de la scène.
       */
-    void notificationVoieVariableModifiee(Voie* v);
-public slots:
-
-    /** effectue un nouveau pas d'animation.
-      *
-      */
-    void animationStep();
+    void drawBackground(QPainter *painter, const QRectF &rect);
 
-    /** démarre l'animation
-      *
-      */
-    void animationStart();
+public slots:
 
-    /** stoppe l'animation
+    /** recopie l'état des locos calculé par le moteur dans les éléments graphiques.
       *
       */
-    void animationStop();
-
-    /** prépare la locomotive au départ.
-      * \param contactA le premier contact définissant le segment sur lequel se trouve la loco.
-      * \param contactB le second contact définissant le segment sur lequel se trouve la loco.
-      * \param numLoco le numéro de la loco à placer.
-      * \param vitesseLoco la vitesse de la loco.
-      */
-    void setLoco(int contactA, int contactB, int numLoco, int vitesseLoco);
+    void rafraichirLocos();
 
-    /** pas implémenté.
+    /** ajoute à la scene les voies de la maquette qui vient d'être construite.
       *
       */
-    void askLoco(int, int);
-
-    /** permet de changer la vitesse d'une loco.
-      * \param numLoco le numéro de la loco à changer
-      * \param vitesseLoco la nouvelle vitesse de la loco.
-      */
-    void setVitesseLoco(int numLoco, int vitesseLoco);
+    void afficherMaquette();
 
-    /** Inverse le sens de la loco.
-      * \param numLoco le numéro de la loco à inverser.
+    /** ajoute une locomotive à la scene.
+      * \param l la loco à afficher.
       */
-    void reverseLoco(int numLoco);
+    void afficherLoco(Loco* l);
 
-    /** permet de changer la vitesse d'une loco.
-      * \param numLoco le numéro de la loco à changer
-      * \param vitesseLoco la nouvelle vitesse de la loco.
+    /** affiche une explosion entre deux locos entrées en collision.
+      * \param l1 la première loco
+      * \param l2 la seconde loco
       */
-    void setVitesseProgressiveLoco(int numLoco, int vitesseLoco);
+    void afficherCollision(Loco* l1, Loco* l2);
 
-    /** arrete la loco
-      * \param numLoco le numéro de la loco.
-      */
-    void stopLoco(int numLoco);
-
-    /** modifie l'etat d'une voie variable.
-      * \param numVoieVariable le numéro de la voie variable.
-      * \param direction la nouvelle direction de la voie (DEVIE ou TOUT_DROIT)
-      */
-    void setVoieVariable(int numVoieVariable, int direction);
-
-    /** reçoit l'information qu'une loco a changé de segment.
-      * \param ctc1 et ctc2 définissent le segment.
-      * \param l la loco ayant changé de segment.
+private:
+    /** rend les voies fixes dans une tuile.
+      * \param i la colonne de la tuile.
+      * \param j la ligne de la tuile.
+      * \return la tuile, dans le repère de transform().
       */
-    void locoSurNouveauSegment(Contact* ctc1, Contact* ctc2, Loco* l);
+    QPixmap rendreTuile(int i, int j);
 
-    /** reçoit l'information qu'une voie variable a été modifiée.
-      * \param v la voie variable modifiée.
+    /** dessine directement les voies fixes, lorsque le painter n'est pas à l'échelle
+      * des tuiles (impression).
+      * \param painter le painter.
+      * \param rect la zone à dessiner, en coordonnées de la scène.
       */
-    void voieVariableModifiee(Voie* v);
+    void dessinerVoiesFixes(QPainter *painter, const QRectF &rect);
 
-
-private:
-    QTimer* timer;
+    SimEngine* engine;
     QGraphicsScene * scene;
-    QMap<int, Voie*> Voies;
-    QMap<int, VoieVariable*> VoiesVariables;
-    QMap<int, Contact*> contacts;
-    Voie* premiereVoie;
-    QMap<int, Loco*> Locos;
-    QList<Segment*> segments;
-
-    /** retourne le segment correspondant à la paire de contacts passée en paramètre
-      * \param contactA et contactB les contacts définissant les segment.
-      * \return le segment correspondant.
-      */
-    Segment* getSegmentByContacts(int contactA, int contactB);
-
-    bool checkLoco(int numLoco);
-
-    bool checkVoieVariable(int numVoie);
+    //! rythme l'affichage des locos, indépendamment des pas de la simulation.
+    QTimer* timerAffichage;
+
+    bool voiesFigees;
+    //! voies de la maquette dont l'aspect ne change jamais.
+    QList<Voie*> voiesFixes;
+    //! rectangle englobant les voies fixes, en coordonnées de la scène.
+    QRectF rectVoiesFixes;
+    //! transformation pour laquelle les tuiles ont été rendues.
+    QTransform transformTuiles;
+    //! tuiles déjà rendues, par colonne et ligne.
+    QHash<QPair<int, int>, QPixmap> tuiles;
 };
 
 #endif // SIMVIEW_H
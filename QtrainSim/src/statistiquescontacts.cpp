@@ -0,0 +1,202 @@
+#include <math.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "statistiquescontacts.h"
+
+HistogrammeLatences::HistogrammeLatences()
+    : nombre(0), immediates(0), sommeNs(0), maxNs(0)
+{
+    for(int i = 0; i < NB_CLASSES; i++)
+        classes[i].store(0, std::memory_order_relaxed);
+}
+
+void HistogrammeLatences::enregistrer(qint64 latenceNs)
+{
+    if(latenceNs < 0)
+        latenceNs = 0;
+
+    //classe : nombre de bits de la latence en microsecondes.
+    quint64 us = latenceNs / 1000;
+    int classe = 0;
+    while(us != 0 && classe < NB_CLASSES - 1)
+    {
+        us >>= 1;
+        classe++;
+    }
+
+    classes[classe].fetch_add(1, std::memory_order_relaxed);
+    nombre.fetch_add(1, std::memory_order_relaxed);
+    sommeNs.fetch_add(latenceNs, std::memory_order_relaxed);
+
+    qint64 max = maxNs.load(std::memory_order_relaxed);
+    while(latenceNs > max && !maxNs.compare_exchange_weak(max, latenceNs, std::memory_order_relaxed))
+        ;
+}
+
+void HistogrammeLatences::enregistrerImmediate()
+{
+    immediates.fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 HistogrammeLatences::getClasse(int classe) const
+{
+    return classes[classe].load(std::memory_order_relaxed);
+}
+
+qint64 HistogrammeLatences::getBorneClasseUs(int classe)
+{
+    if(classe >= NB_CLASSES - 1)
+        return -1;
+    return Q_INT64_C(1) << classe;
+}
+
+quint64 HistogrammeLatences::getNombre() const
+{
+    return nombre.load(std::memory_order_relaxed);
+}
+
+quint64 HistogrammeLatences::getImmediates() const
+{
+    return immediates.load(std::memory_order_relaxed);
+}
+
+qint64 HistogrammeLatences::getMoyenneNs() const
+{
+    quint64 n = getNombre();
+    if(n == 0)
+        return 0;
+    return sommeNs.load(std::memory_order_relaxed) / n;
+}
+
+qint64 HistogrammeLatences::getMaxNs() const
+{
+    return maxNs.load(std::memory_order_relaxed);
+}
+
+qint64 HistogrammeLatences::getQuantileUs(double q) const
+{
+    quint64 total = 0;
+    quint64 valeurs[NB_CLASSES];
+    for(int i = 0; i < NB_CLASSES; i++)
+    {
+        valeurs[i] = getClasse(i);
+        total += valeurs[i];
+    }
+    if(total == 0)
+        return 0;
+
+    quint64 rang = (quint64) ceil(q * total);
+    quint64 cumul = 0;
+    for(int i = 0; i < NB_CLASSES; i++)
+    {
+        cumul += valeurs[i];
+        if(cumul >= rang && valeurs[i] != 0)
+            return getBorneClasseUs(i);
+    }
+    return getBorneClasseUs(NB_CLASSES - 1);
+}
+
+
+StatistiquesContacts::StatistiquesContacts()
+{
+}
+
+StatistiquesContacts* StatistiquesContacts::getInstance()
+{
+    static StatistiquesContacts instance;
+    return &instance;
+}
+
+void StatistiquesContacts::enregistrerLatence(int numContact, qint64 latenceNs)
+{
+    if(numContact < 0 || numContact > MAX_CONTACTS)
+        return;
+    histogrammes[numContact].enregistrer(latenceNs);
+}
+
+void StatistiquesContacts::enregistrerImmediate(int numContact)
+{
+    if(numContact < 0 || numContact > MAX_CONTACTS)
+        return;
+    histogrammes[numContact].enregistrerImmediate();
+}
+
+/** met en forme un quantile, la dernière classe n'étant pas bornée.
+  */
+static QString formaterQuantile(qint64 quantileUs)
+{
+    if(quantileUs < 0)
+        return QString(">%1").arg(HistogrammeLatences::getBorneClasseUs(HistogrammeLatences::NB_CLASSES - 2));
+    return QString::number(quantileUs);
+}
+
+QString StatistiquesContacts::texte() const
+{
+    QString resultat = "Latences de réveil des contacts (us) :\n"
+                       "contact  réveils  immédiats  moyenne  p50  p99  max";
+    bool vide = true;
+
+    for(int i = 0; i <= MAX_CONTACTS; i++)
+    {
+        const HistogrammeLatences &h = histogrammes[i];
+        if(h.getNombre() == 0 && h.getImmediates() == 0)
+            continue;
+        vide = false;
+
+        resultat += QString("\n%1  %2  %3  %4  %5  %6  %7")
+                .arg(i, 7)
+                .arg(h.getNombre(), 7)
+                .arg(h.getImmediates(), 9)
+                .arg(h.getMoyenneNs() / 1000, 7)
+                .arg(formaterQuantile(h.getQuantileUs(0.5)), 3)
+                .arg(formaterQuantile(h.getQuantileUs(0.99)), 3)
+                .arg(h.getMaxNs() / 1000);
+    }
+
+    if(vide)
+        resultat += "\n(aucune attente de contact)";
+    return resultat;
+}
+
+bool StatistiquesContacts::ecrireFichier(const QString &nomFichier) const
+{
+    QJsonArray bornes;
+    for(int k = 0; k < HistogrammeLatences::NB_CLASSES; k++)
+        bornes.append((double) HistogrammeLatences::getBorneClasseUs(k));
+
+    QJsonArray contacts;
+    for(int i = 0; i <= MAX_CONTACTS; i++)
+    {
+        const HistogrammeLatences &h = histogrammes[i];
+        if(h.getNombre() == 0 && h.getImmediates() == 0)
+            continue;
+
+        QJsonArray classes;
+        for(int k = 0; k < HistogrammeLatences::NB_CLASSES; k++)
+            classes.append((double) h.getClasse(k));
+
+        QJsonObject contact;
+        contact["contact"] = i;
+        contact["reveils"] = (double) h.getNombre();
+        contact["immediats"] = (double) h.getImmediates();
+        contact["moyenne_ns"] = (double) h.getMoyenneNs();
+        contact["max_ns"] = (double) h.getMaxNs();
+        contact["classes"] = classes;
+        contacts.append(contact);
+    }
+
+    QJsonObject racine;
+    racine["source"] = QString("simulateur");
+    racine["bornes_classes_us"] = bornes;
+    racine["contacts"] = contacts;
+
+    QFile fichier(nomFichier);
+    if(!fichier.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    fichier.write(QJsonDocument(racine).toJson());
+    return true;
+}
@@ -0,0 +1,112 @@
+#ifndef STATISTIQUESCONTACTS_H
+#define STATISTIQUESCONTACTS_H
+
+#include <atomic>
+
+#include <QString>
+
+#include "general.h"
+
+/**
+  Histogramme des latences de réveil d'un contact, c'est-à-dire du délai entre
+  l'activation du contact et le retour du thread qui l'attendait.
+  Les classes sont des puissances de deux en microsecondes : la classe 0 compte
+  les latences inférieures à 1 us, la classe k celles comprises entre 2^(k-1) et
+  2^k us, la dernière classe tout ce qui dépasse.
+  L'enregistrement se fait sans verrou : il peut être appelé depuis n'importe quel
+  thread, y compris pendant une lecture.
+  */
+class HistogrammeLatences
+{
+public:
+    //! nombre de classes de l'histogramme.
+    static const int NB_CLASSES = 24;
+
+    HistogrammeLatences();
+
+    /** enregistre le réveil d'un thread ayant dû attendre l'activation.
+      * \param latenceNs la latence en nanosecondes.
+      */
+    void enregistrer(qint64 latenceNs);
+
+    /** enregistre une attente satisfaite sans bloquer (activation déjà survenue).
+      */
+    void enregistrerImmediate();
+
+    /** retourne le nombre de réveils enregistrés dans une classe.
+      * \param classe l'indice de la classe.
+      * \return le nombre de réveils.
+      */
+    quint64 getClasse(int classe) const;
+
+    /** retourne la borne supérieure d'une classe, en microsecondes.
+      * \param classe l'indice de la classe.
+      * \return la borne supérieure, -1 pour la dernière classe (non bornée).
+      */
+    static qint64 getBorneClasseUs(int classe);
+
+    //! nombre de réveils après blocage.
+    quint64 getNombre() const;
+    //! nombre d'attentes satisfaites sans bloquer.
+    quint64 getImmediates() const;
+    //! latence moyenne des réveils, en nanosecondes.
+    qint64 getMoyenneNs() const;
+    //! latence maximale des réveils, en nanosecondes.
+    qint64 getMaxNs() const;
+
+    /** estime un quantile des latences, à la précision des classes.
+      * \param q le quantile désiré, entre 0 et 1.
+      * \return la borne supérieure en microsecondes de la classe contenant le quantile.
+      */
+    qint64 getQuantileUs(double q) const;
+
+private:
+    std::atomic<quint64> classes[NB_CLASSES];
+    std::atomic<quint64> nombre;
+    std::atomic<quint64> immediates;
+    std::atomic<quint64> sommeNs;
+    std::atomic<qint64> maxNs;
+};
+
+/**
+  Statistiques des latences de réveil de tous les contacts.
+  Elles sont alimentées par le bus des contacts, consultables depuis la console
+  de commande (commande ":stats") et écrites dans un fichier à la fermeture du simulateur.
+  */
+class StatistiquesContacts
+{
+public:
+    /** retourne l'unique instance des statistiques.
+      * \return l'instance des statistiques.
+      */
+    static StatistiquesContacts* getInstance();
+
+    /** enregistre la latence de réveil d'un thread attendant un contact.
+      * \param numContact le numéro du contact.
+      * \param latenceNs la latence en nanosecondes.
+      */
+    void enregistrerLatence(int numContact, qint64 latenceNs);
+
+    /** enregistre une attente d'un contact satisfaite sans bloquer.
+      * \param numContact le numéro du contact.
+      */
+    void enregistrerImmediate(int numContact);
+
+    /** met en forme les statistiques des contacts ayant été attendus, pour la console.
+      * \return le texte des statistiques.
+      */
+    QString texte() const;
+
+    /** écrit les statistiques complètes au format JSON.
+      * \param nomFichier le nom du fichier à écrire.
+      * \return vrai si le fichier a pu être écrit.
+      */
+    bool ecrireFichier(const QString &nomFichier) const;
+
+private:
+    StatistiquesContacts();
+
+    HistogrammeLatences histogrammes[MAX_CONTACTS + 1];
+};
+
+#endif // STATISTIQUESCONTACTS_H
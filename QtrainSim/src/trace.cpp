@@ -0,0 +1,242 @@
+#include "trace.h"
+
+//! "QTRT" : identifie un fichier de trace.
+static const quint32 MAGIE_TRACE = 0x51545254;
+static const quint16 VERSION_TRACE = 1;
+
+EnregistreurTrace::EnregistreurTrace()
+{
+    pas = 0;
+    pasPrecedent = 0;
+}
+
+EnregistreurTrace::~EnregistreurTrace()
+{
+    fermer();
+}
+
+bool EnregistreurTrace::ouvrir(const QString &nomFichier)
+{
+    fichier.setFileName(nomFichier);
+    if(!fichier.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    flux.setDevice(&fichier);
+    flux.setVersion(QDataStream::Qt_5_0);
+    flux << MAGIE_TRACE << VERSION_TRACE;
+    return true;
+}
+
+void EnregistreurTrace::setPas(qint64 pas)
+{
+    this->pas = pas;
+}
+
+void EnregistreurTrace::entete(EvenementTrace::Type type)
+{
+    flux << (quint8) type << (quint32) (pas - pasPrecedent);
+    pasPrecedent = pas;
+}
+
+void EnregistreurTrace::maquette(const QString &nom)
+{
+    if(!fichier.isOpen())
+        return;
+    entete(EvenementTrace::MAQUETTE);
+    flux << nom;
+    pas = 0;
+    pasPrecedent = 0;
+}
+
+void EnregistreurTrace::commande(const Commande &c)
+{
+    if(!fichier.isOpen())
+        return;
+    entete(EvenementTrace::COMMANDE);
+    flux << (quint8) c.type << (qint32) c.numero << (qint32) c.valeur
+         << (qint32) c.contactA << (qint32) c.contactB;
+}
+
+void EnregistreurTrace::contactActive(int numContact, int numLoco)
+{
+    if(!fichier.isOpen())
+        return;
+    entete(EvenementTrace::CONTACT);
+    flux << (qint16) numContact << (qint16) numLoco;
+}
+
+void EnregistreurTrace::fermer()
+{
+    if(!fichier.isOpen())
+        return;
+    entete(EvenementTrace::FIN);
+    fichier.close();
+}
+
+
+LecteurTrace::LecteurTrace()
+{
+    indiceCommande = 0;
+    indiceContact = 0;
+    chargement = -1;
+    pas = 0;
+    nbreDivergences = 0;
+}
+
+bool LecteurTrace::ouvrir(const QString &nomFichier, QString &erreur)
+{
+    QFile fichier(nomFichier);
+    if(!fichier.open(QIODevice::ReadOnly))
+    {
+        erreur = QString("Impossible d'ouvrir la trace \"%1\".").arg(nomFichier);
+        return false;
+    }
+
+    QDataStream flux(&fichier);
+    flux.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magie;
+    quint16 version;
+    flux >> magie >> version;
+    if(magie != MAGIE_TRACE || version != VERSION_TRACE)
+    {
+        erreur = QString("\"%1\" n'est pas une trace de simulation valide.").arg(nomFichier);
+        return false;
+    }
+
+    int indice = -1;
+    qint64 pasCourant = 0;
+    while(!flux.atEnd())
+    {
+        quint8 type;
+        quint32 ecart;
+        flux >> type >> ecart;
+        pasCourant += ecart;
+
+        EvenementTrace e;
+        e.type = (EvenementTrace::Type) type;
+        e.pas = pasCourant;
+        e.chargement = indice;
+
+        quint8 typeCommande;
+        qint32 numero, valeur, contactA, contactB;
+        qint16 numContact, numLoco;
+
+        switch(e.type)
+        {
+        case EvenementTrace::MAQUETTE:
+            flux >> e.maquette;
+            maquettes.append(e.maquette);
+            indice++;
+            pasCourant = 0;
+            break;
+        case EvenementTrace::COMMANDE:
+            flux >> typeCommande >> numero >> valeur >> contactA >> contactB;
+            e.commande.type = (Commande::Type) typeCommande;
+            e.commande.numero = numero;
+            e.commande.valeur = valeur;
+            e.commande.contactA = contactA;
+            e.commande.contactB = contactB;
+            commandes.append(e);
+            break;
+        case EvenementTrace::CONTACT:
+            flux >> numContact >> numLoco;
+            e.numContact = numContact;
+            e.numLoco = numLoco;
+            contacts.append(e);
+            break;
+        case EvenementTrace::FIN:
+            break;
+        default:
+            erreur = QString("La trace \"%1\" est corrompue.").arg(nomFichier);
+            return false;
+        }
+
+        if(flux.status() != QDataStream::Ok)
+        {
+            erreur = QString("La trace \"%1\" est tronquée.").arg(nomFichier);
+            return false;
+        }
+
+        derniersPas[indice] = pasCourant;
+    }
+    return true;
+}
+
+void LecteurTrace::maquette(const QString &nom)
+{
+    chargement++;
+    pas = 0;
+
+    if(chargement >= maquettes.size())
+        divergence(QString("chargement supplémentaire de la maquette \"%1\"").arg(nom));
+    else if(maquettes.at(chargement) != nom)
+        divergence(QString("maquette \"%1\" chargée, \"%2\" attendue").arg(nom).arg(maquettes.at(chargement)));
+
+    //les événements restants des chargements précédents ne seront jamais rejoués.
+    while(indiceCommande < commandes.size() && commandes.at(indiceCommande).chargement < chargement)
+        indiceCommande++;
+    while(indiceContact < contacts.size() && contacts.at(indiceContact).chargement < chargement)
+    {
+        divergence(QString("contact %1 non activé au pas %2").arg(contacts.at(indiceContact).numContact).arg(contacts.at(indiceContact).pas));
+        indiceContact++;
+    }
+}
+
+void LecteurTrace::setPas(qint64 pas)
+{
+    this->pas = pas;
+}
+
+bool LecteurTrace::commandeSuivante(Commande &c)
+{
+    if(indiceCommande >= commandes.size())
+        return false;
+
+    const EvenementTrace &e = commandes.at(indiceCommande);
+    if(e.chargement != chargement || e.pas > pas)
+        return false;
+
+    c = e.commande;
+    indiceCommande++;
+    return true;
+}
+
+void LecteurTrace::contactActive(int numContact, int numLoco)
+{
+    if(indiceContact >= contacts.size() || contacts.at(indiceContact).chargement != chargement)
+    {
+        divergence(QString("pas %1 : activation supplémentaire du contact %2 par la loco %3").arg(pas).arg(numContact).arg(numLoco));
+        return;
+    }
+
+    const EvenementTrace &e = contacts.at(indiceContact);
+    if(e.pas != pas || e.numContact != numContact || e.numLoco != numLoco)
+        divergence(QString("pas %1 : contact %2 activé par la loco %3, attendu au pas %4 : contact %5 par la loco %6")
+                   .arg(pas).arg(numContact).arg(numLoco).arg(e.pas).arg(e.numContact).arg(e.numLoco));
+    indiceContact++;
+}
+
+qint64 LecteurTrace::getDernierPas() const
+{
+    return derniersPas.value(chargement, 0);
+}
+
+QString LecteurTrace::rapport(bool &conforme) const
+{
+    int manquants = contacts.size() - indiceContact;
+    conforme = (nbreDivergences == 0 && manquants == 0);
+
+    QString texte = QString("Rejeu : %1 activations de contacts vérifiées, %2 manquantes, %3 divergences.")
+            .arg(indiceContact).arg(manquants).arg(nbreDivergences);
+    if(nbreDivergences > 0)
+        texte += QString("\nPremière divergence : %1").arg(premiereDivergence);
+    return texte;
+}
+
+void LecteurTrace::divergence(const QString &description)
+{
+    if(nbreDivergences == 0)
+        premiereDivergence = description;
+    nbreDivergences++;
+}
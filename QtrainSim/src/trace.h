@@ -0,0 +1,154 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QFile>
+#include <QDataStream>
+#include <QString>
+#include <QVector>
+#include <QMap>
+
+#include "buscontacts.h"
+#include "filecommandes.h"
+
+/**
+  Evénement d'une trace de simulation.
+  Chaque événement est daté par le numéro du pas au cours duquel il est survenu,
+  compté depuis le chargement de la maquette. Dans le fichier, seul l'écart avec
+  l'événement précédent est écrit : les frontières de pas sont ainsi enregistrées
+  sans coûter un enregistrement par pas.
+  */
+struct EvenementTrace
+{
+    enum Type
+    {
+        MAQUETTE = 1,
+        COMMANDE = 2,
+        CONTACT = 3,
+        FIN = 4
+    };
+
+    Type type;
+    qint64 pas;
+    //! indice du chargement de maquette auquel appartient l'événement.
+    int chargement;
+    Commande commande;
+    int numContact;
+    int numLoco;
+    QString maquette;
+};
+
+/**
+  Enregistre une simulation dans une trace binaire : chargements de maquette,
+  commandes appliquées par le moteur, activations de contacts et dernier pas effectué.
+  Toutes les méthodes sont appelées depuis le thread du moteur de simulation.
+  */
+class EnregistreurTrace : public ObservateurContacts
+{
+public:
+    EnregistreurTrace();
+    ~EnregistreurTrace();
+
+    /** crée le fichier de la trace et y écrit l'entête.
+      * \param nomFichier le nom du fichier.
+      * \return vrai si le fichier a pu être créé.
+      */
+    bool ouvrir(const QString &nomFichier);
+
+    /** indique le numéro du pas en cours.
+      * \param pas le numéro du pas.
+      */
+    void setPas(qint64 pas);
+
+    /** enregistre le chargement d'une maquette. La numérotation des pas repart de zéro.
+      * \param nom le nom de la maquette.
+      */
+    void maquette(const QString &nom);
+
+    /** enregistre une commande appliquée par le moteur.
+      * \param c la commande.
+      */
+    void commande(const Commande &c);
+
+    void contactActive(int numContact, int numLoco);
+
+    /** enregistre le dernier pas effectué et ferme la trace.
+      */
+    void fermer();
+
+private:
+    /** écrit le type d'un événement et son écart en pas avec l'événement précédent.
+      */
+    void entete(EvenementTrace::Type type);
+
+    QFile fichier;
+    QDataStream flux;
+    qint64 pas;
+    qint64 pasPrecedent;
+};
+
+/**
+  Relit une trace pour rejouer une simulation.
+  Le moteur applique les commandes de la trace à leur pas d'origine, à la place de
+  celles des threads clients ; chaque activation de contact est comparée à celle
+  enregistrée, et toute divergence est comptée.
+  */
+class LecteurTrace : public ObservateurContacts
+{
+public:
+    LecteurTrace();
+
+    /** lit entièrement une trace.
+      * \param nomFichier le nom du fichier.
+      * \param erreur reçoit la description de l'erreur le cas échéant.
+      * \return vrai si la trace a pu être lue.
+      */
+    bool ouvrir(const QString &nomFichier, QString &erreur);
+
+    /** signale le chargement d'une maquette et vérifie qu'il s'agit de celle de la trace.
+      * \param nom le nom de la maquette chargée.
+      */
+    void maquette(const QString &nom);
+
+    /** indique le numéro du pas en cours.
+      * \param pas le numéro du pas.
+      */
+    void setPas(qint64 pas);
+
+    /** retourne la prochaine commande à appliquer au pas courant.
+      * \param c reçoit la commande.
+      * \return vrai si une commande a été retournée.
+      */
+    bool commandeSuivante(Commande &c);
+
+    void contactActive(int numContact, int numLoco);
+
+    /** retourne le dernier pas de la trace pour la maquette chargée.
+      * \return le numéro du dernier pas.
+      */
+    qint64 getDernierPas() const;
+
+    /** établit le rapport du rejeu : activations vérifiées, manquantes et divergences.
+      * \param conforme reçoit vrai si le rejeu est identique à la trace.
+      * \return le texte du rapport.
+      */
+    QString rapport(bool &conforme) const;
+
+private:
+    /** compte une divergence et mémorise la première.
+      */
+    void divergence(const QString &description);
+
+    QVector<EvenementTrace> commandes;
+    QVector<EvenementTrace> contacts;
+    QVector<QString> maquettes;
+    //! dernier pas de chaque chargement de maquette.
+    QMap<int, qint64> derniersPas;
+    int indiceCommande;
+    int indiceContact;
+    int chargement;
+    qint64 pas;
+    int nbreDivergences;
+    QString premiereDivergence;
+};
+
+#endif // TRACE_H
@@ -5,6 +5,11 @@ TrainSimSettings::TrainSimSettings()
     viewLocoLog=false;
     viewContactNumber=false;
     viewAiguillageNumber=false;
+    voiesFigees=true;
+    inertie=true;
+    sansRendu=false;
+    tempsReel=false;
+    dureeSimulation=0.0;
 }
 
 //TrainSimSettings *TrainSimSettings::instance = nullptr;
@@ -48,6 +53,16 @@ void TrainSimSettings::setViewContactNumber(bool draw)
     viewContactNumber=draw;
 }
 
+bool TrainSimSettings::getVoiesFigees()
+{
+    return voiesFigees;
+}
+
+void TrainSimSettings::setVoiesFigees(bool enable)
+{
+    voiesFigees=enable;
+}
+
 bool TrainSimSettings::getInertie()
 {
     return inertie;
@@ -58,3 +73,62 @@ void TrainSimSettings::setInertie(bool enable)
     inertie=enable;
 }
 
+bool TrainSimSettings::getSansRendu()
+{
+    return sansRendu;
+}
+
+void TrainSimSettings::setSansRendu(bool enable)
+{
+    sansRendu=enable;
+}
+
+bool TrainSimSettings::getTempsReel()
+{
+    return tempsReel;
+}
+
+void TrainSimSettings::setTempsReel(bool enable)
+{
+    tempsReel=enable;
+}
+
+double TrainSimSettings::getDureeSimulation()
+{
+    return dureeSimulation;
+}
+
+void TrainSimSettings::setDureeSimulation(double secondes)
+{
+    dureeSimulation=secondes;
+}
+
+QString TrainSimSettings::getFichierEnregistrement()
+{
+    return fichierEnregistrement;
+}
+
+void TrainSimSettings::setFichierEnregistrement(QString fichier)
+{
+    fichierEnregistrement=fichier;
+}
+
+QString TrainSimSettings::getFichierRejeu()
+{
+    return fichierRejeu;
+}
+
+void TrainSimSettings::setFichierRejeu(QString fichier)
+{
+    fichierRejeu=fichier;
+}
+
+QString TrainSimSettings::getFichierEvenements()
+{
+    return fichierEvenements;
+}
+
+void TrainSimSettings::setFichierEvenements(QString fichier)
+{
+    fichierEvenements=fichier;
+}
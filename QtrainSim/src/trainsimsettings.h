@@ -1,6 +1,8 @@
 #ifndef TRAINSIMSETTINGS_H
 #define TRAINSIMSETTINGS_H
 
+#include <QString>
+
 class TrainSimSettings
 {
 
@@ -17,9 +19,30 @@ public:
     bool getViewLocoLog();
     void setViewLocoLog(bool view);
 
+    bool getVoiesFigees();
+    void setVoiesFigees(bool enable);
+
     bool getInertie();
     void setInertie(bool enable);
 
+    bool getSansRendu();
+    void setSansRendu(bool enable);
+
+    bool getTempsReel();
+    void setTempsReel(bool enable);
+
+    double getDureeSimulation();
+    void setDureeSimulation(double secondes);
+
+    QString getFichierEnregistrement();
+    void setFichierEnregistrement(QString fichier);
+
+    QString getFichierRejeu();
+    void setFichierRejeu(QString fichier);
+
+    QString getFichierEvenements();
+    void setFichierEvenements(QString fichier);
+
 protected:
     TrainSimSettings();
 //    static TrainSimSettings *instance;
@@ -27,7 +50,14 @@ protected:
     bool viewContactNumber;
     bool viewAiguillageNumber;
     bool viewLocoLog;
+    bool voiesFigees;
     bool inertie;
+    bool sansRendu;
+    bool tempsReel;
+    double dureeSimulation;
+    QString fichierEnregistrement;
+    QString fichierRejeu;
+    QString fichierEvenements;
 };
 
 
@@ -7,6 +7,8 @@
 Voie::Voie()
 {
     this->contact = nullptr;
+    this->nbreLocos = 0;
+    this->geometrieFigee = false;
     setZValue(ZVAL_VOIE);
 }
 
@@ -31,8 +33,8 @@ void Voie::calculerPosition(Voie *v)
     {
         QPointF positionLiaison = v->getPosAbsLiaison(this);
 
-        setPos(positionLiaison.x() - coordonneesLiaison[ordreLiaison.key(v)]->x(),
-               positionLiaison.y() - coordonneesLiaison[ordreLiaison.key(v)]->y());
+        setPos(positionLiaison.x() - coordonneesLiaison[ordreDe(v)].x(),
+               positionLiaison.y() - coordonneesLiaison[ordreDe(v)].y());
     }
 
     posee = true;
@@ -65,28 +67,82 @@ void Voie::calculerPosition(Voie *v)
 }
 
 
-QList<QList<Voie*>*> Voie::startExplorationContactAContact()
+void Voie::explorationContactAContact(QVector<Voie*> &voies, QVector<int> &fins)
 {
-    QList<QList<Voie*>*> temp;
-
-    for(int i=0; i<ordreLiaison.size(); i++)
+    //étape du parcours en profondeur : la pile des étapes forme le chemin courant.
+    struct Etape
     {
-        temp.append(ordreLiaison[i]->explorationContactAContact(this));
-    }
-
-    foreach(QList<Voie*>* lv, temp)
+        Voie* voie;
+        int ordreEntree;
+        //une case de plus pour la voie de départ, dont toutes les extrémités sont explorées.
+        int ordresSortie[MAX_SORTIES_EXPLORATION + 1];
+        int nbreSorties;
+        int sortieSuivante;
+    };
+
+    QVarLengthArray<Etape, 64> pile;
+
+    Etape depart;
+    depart.voie = this;
+    depart.ordreEntree = -1;
+    depart.nbreSorties = 0;
+    depart.sortieSuivante = 0;
+    //depuis la voie de départ, toutes les extrémités sont explorées.
+    for(int i = 0; i < ordreLiaison.size() && i <= MAX_SORTIES_EXPLORATION; i++)
+        depart.ordresSortie[depart.nbreSorties++] = i;
+    pile.append(depart);
+
+    while(!pile.isEmpty())
     {
-        lv->prepend(this);
-    }
+        Etape &courante = pile.last();
+        if(courante.sortieSuivante == courante.nbreSorties)
+        {
+            pile.removeLast();
+            continue;
+        }
 
-    return temp;
+        Voie* precedente = courante.voie;
+        Voie* voisine = precedente->ordreLiaison.value(courante.ordresSortie[courante.sortieSuivante++], nullptr);
+        if(voisine == nullptr)
+            continue;
+
+        Etape suivante;
+        suivante.voie = voisine;
+        suivante.ordreEntree = voisine->ordreDe(precedente);
+        suivante.sortieSuivante = 0;
+        suivante.nbreSorties = 0;
+        if(voisine->contact == nullptr)
+            suivante.nbreSorties = voisine->getSortiesExploration(suivante.ordreEntree, suivante.ordresSortie);
+
+        if(suivante.nbreSorties == 0)
+        {
+            //le chemin se termine sur un contact ou une voie buttoir.
+            for(int i = 0; i < pile.size(); i++)
+                voies.append(pile.at(i).voie);
+            voies.append(voisine);
+            fins.append(voies.size());
+        }
+        else
+        {
+            //une boucle sans contact ramène sur une voie par la même extrémité : le chemin est abandonné.
+            bool boucle = false;
+            for(int i = 0; i < pile.size() && !boucle; i++)
+                boucle = (pile.at(i).voie == voisine && pile.at(i).ordreEntree == suivante.ordreEntree);
+            if(!boucle)
+                pile.append(suivante);
+        }
+    }
 }
 
 void Voie::lier(Voie *v, int ordre)
 {
-    ordreLiaison.insert(ordre, v);
-    coordonneesLiaison.insert(ordre, new QPointF());
-    angleLiaison.insert(ordre, 0.0);
+    while(ordreLiaison.size() <= ordre)
+    {
+        ordreLiaison.append(nullptr);
+        coordonneesLiaison.append(QPointF());
+        angleLiaison.append(0.0);
+    }
+    ordreLiaison[ordre] = v;
 }
 
 bool Voie::estOrientee()
@@ -112,8 +168,169 @@ double Voie::normaliserAngle(double angle) const
 
 QPointF Voie::getPosAbsLiaison(Voie *v)
 {
-    return QPointF(this->scenePos().x() + coordonneesLiaison[ordreLiaison.key(v)]->x(),
-                                this->scenePos().y() + coordonneesLiaison[ordreLiaison.key(v)]->y());
+    return getPosAbsLiaisonDOrdre(ordreDe(v));
+}
+
+QPointF Voie::getPosAbsLiaisonDOrdre(int ordre) const
+{
+    if(geometrieFigee)
+        return positionsAbsLiaison.at(ordre);
+
+    return QPointF(this->scenePos().x() + coordonneesLiaison[ordre].x(),
+                   this->scenePos().y() + coordonneesLiaison[ordre].y());
+}
+
+void Voie::sauverGeometrie(QDataStream &flux) const
+{
+    flux << pos();
+    for(int i = 0; i < ordreLiaison.size(); i++)
+        flux << angleLiaison.at(i) << coordonneesLiaison.at(i);
+}
+
+void Voie::restaurerGeometrie(QDataStream &flux)
+{
+    QPointF p;
+    flux >> p;
+    setPos(p);
+    for(int i = 0; i < ordreLiaison.size(); i++)
+        flux >> angleLiaison[i] >> coordonneesLiaison[i];
+
+    orientee = true;
+    posee = true;
+}
+
+void Voie::figerGeometrie()
+{
+    geometrieFigee = false;
+    positionsAbsLiaison.resize(coordonneesLiaison.size());
+    for(int i = 0; i < coordonneesLiaison.size(); i++)
+        positionsAbsLiaison[i] = getPosAbsLiaisonDOrdre(i);
+    geometrieFigee = true;
+
+    compilerParcours();
+}
+
+int Voie::indiceParcours(int a, int b)
+{
+    static const int indices[4][4] = {{-1, 0, 1, 2},
+                                      { 0,-1, 3, 4},
+                                      { 1, 3,-1, 5},
+                                      { 2, 4, 5,-1}};
+    return indices[a][b];
+}
+
+ParcoursVoie Voie::calculerParcours(const QPointF &depart, qreal angleLiaison, const QPointF &arrivee)
+{
+    ParcoursVoie p;
+
+    //la loco entre dans la voie dans le sens opposé à l'angle de l'extrémité (axe Y vers le bas).
+    qreal dx = - cos(angleLiaison);
+    qreal dy = sin(angleLiaison);
+    qreal cx = arrivee.x() - depart.x();
+    qreal cy = arrivee.y() - depart.y();
+    qreal corde = sqrt(cx * cx + cy * cy);
+
+    p.depart = depart;
+    p.cap = atan2(dy, dx);
+    p.cosCap = dx;
+    p.sinCap = dy;
+    p.courbure = 0.0;
+    p.longueur = corde;
+
+    if(corde < 1e-9)
+        return p;
+
+    //l'angle entre la tangente de départ et la corde vaut la moitié de l'angle de l'arc.
+    qreal theta = atan2(dx * cy - dy * cx, dx * cx + dy * cy);
+    if(fabs(theta) > 1e-6)
+    {
+        p.courbure = 2.0 * sin(theta) / corde;
+        p.longueur = corde * theta / sin(theta);
+    }
+
+    return p;
+}
+
+void Voie::compilerParcours()
+{
+    int n = ordreLiaison.size();
+
+    parcours.resize(n * (n - 1) / 2);
+    for(int a = 0; a < n; a++)
+        for(int b = a + 1; b < n; b++)
+            parcours[indiceParcours(a, b)] = calculerParcours(positionsAbsLiaison.at(a), getAngleRad(a), positionsAbsLiaison.at(b));
+
+    //au fond d'une impasse, la loco s'arrête lorsque son avant touche l'extrémité de la voie.
+    qreal longueurImpasse = qMax(0.0, getLongueurAParcourir() - LONGUEUR_LOCO / 2.0);
+    impasses.resize(n);
+    for(int a = 0; a < n; a++)
+    {
+        QPointF fond(positionsAbsLiaison.at(a).x() - longueurImpasse * cos(getAngleRad(a)),
+                     positionsAbsLiaison.at(a).y() + longueurImpasse * sin(getAngleRad(a)));
+        impasses[a] = calculerParcours(positionsAbsLiaison.at(a), getAngleRad(a), fond);
+    }
+}
+
+int Voie::getOrdreSuivant(int ordreEntree)
+{
+    if(ordreEntree < 0 || ordreEntree >= ordreLiaison.size())
+        return -1;
+
+    Voie* suivante = getVoieSuivante(ordreLiaison.at(ordreEntree));
+    return suivante == nullptr ? -1 : ordreDe(suivante);
+}
+
+qreal Voie::getLongueurParcours(int ordreEntree, int ordreSortie) const
+{
+    if(ordreSortie < 0 || ordreEntree == ordreSortie)
+        return impasses.at(ordreEntree).longueur;
+    if(ordreEntree < 0)
+        return impasses.at(ordreSortie).longueur;
+    return parcours.at(indiceParcours(ordreEntree, ordreSortie)).longueur;
+}
+
+void Voie::getPoseParcours(int ordreEntree, int ordreSortie, qreal abscisse, QPointF &position, qreal &cap) const
+{
+    const ParcoursVoie *p;
+    bool inverse;
+
+    if(ordreSortie < 0 || ordreEntree == ordreSortie)
+    {
+        p = &impasses.at(ordreEntree);
+        inverse = false;
+    }
+    else if(ordreEntree < 0)
+    {
+        p = &impasses.at(ordreSortie);
+        inverse = true;
+    }
+    else
+    {
+        //seul le parcours de la plus petite extrémité vers la plus grande est stocké.
+        p = &parcours.at(indiceParcours(ordreEntree, ordreSortie));
+        inverse = ordreEntree > ordreSortie;
+    }
+
+    qreal s = inverse ? p->longueur - abscisse : abscisse;
+    qreal capRad;
+
+    if(p->courbure == 0.0)
+    {
+        capRad = p->cap;
+        position = QPointF(p->depart.x() + s * p->cosCap,
+                           p->depart.y() + s * p->sinCap);
+    }
+    else
+    {
+        capRad = p->cap + p->courbure * s;
+        position = QPointF(p->depart.x() + (sin(capRad) - p->sinCap) / p->courbure,
+                           p->depart.y() + (p->cosCap - cos(capRad)) / p->courbure);
+    }
+
+    if(inverse)
+        capRad += PI;
+
+    cap = capRad * 180.0 / PI;
 }
 
 void Voie::setContact(Contact *c)
@@ -154,12 +371,12 @@ qreal Voie::getYmax() const
 
 qreal Voie::getAngleVoisin(Voie *voisin) const
 {
-    return angleLiaison[ordreLiaison.key(voisin)];
+    return angleLiaison[ordreDe(voisin)];
 }
 
 qreal Voie::getNouvelAngle(Voie *voisin) const
 {
-    return normaliserAngle(angleLiaison[ordreLiaison.key(voisin)] + 180.0);
+    return normaliserAngle(angleLiaison[ordreDe(voisin)] + 180.0);
 }
 
 qreal Voie::getAngleDeg(int liaison) const
@@ -227,6 +444,21 @@ int Voie::getIdVoie()
     return idVoie;
 }
 
+void Voie::entreeLoco()
+{
+    nbreLocos++;
+}
+
+void Voie::sortieLoco()
+{
+    nbreLocos--;
+}
+
+int Voie::getNbreLocos() const
+{
+    return nbreLocos;
+}
+
 /*
 #include "commandetrain.h"
 void Voie::mousePressEvent ( QGraphicsSceneMouseEvent * event )
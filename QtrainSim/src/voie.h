@@ -5,6 +5,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 #include <QMap>
 #include <QPointF>
 #include <QDebug>
@@ -12,11 +13,27 @@
 #include <QAbstractGraphicsShapeItem>
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
-#include <QMap>
+#include <QVarLengthArray>
+#include <QDataStream>
 
 #include "general.h"
 #include "contact.h"
 
+/**
+  Parcours d'une extrémité à une autre d'une voie, précalculé à la construction de la maquette.
+  Il s'agit d'un arc de cercle (ou d'un segment de droite si la courbure est nulle)
+  paramétré par l'abscisse curviligne, exprimé en coordonnées de la scene.
+  */
+struct ParcoursVoie
+{
+    QPointF depart;
+    qreal cap;
+    qreal cosCap;
+    qreal sinCap;
+    qreal courbure;
+    qreal longueur;
+};
+
 class Voie : public QObject, public QAbstractGraphicsShapeItem
 {
     Q_OBJECT
@@ -65,6 +82,30 @@ public:
       */
     QPointF getPosAbsLiaison(Voie* v);
 
+    /** retourne la position en coordonnées absolue de l'extrémité d'ordre spécifié.
+      * \param ordre l'ordre de l'extrémité.
+      * \return la position absolue de l'extrémité.
+      */
+    QPointF getPosAbsLiaisonDOrdre(int ordre) const;
+
+    /** retourne l'ordre de l'extrémité reliée à la voie passée en paramètre.
+      * Les extrémités étant au plus quatre et rangées de manière contiguë, la recherche est immédiate.
+      * \param v la voie voisine.
+      * \return l'ordre de l'extrémité reliée à v, 0 si v n'est pas voisine.
+      */
+    inline int ordreDe(const Voie* v) const
+    {
+        for(int i = 0; i < ordreLiaison.size(); i++)
+            if(ordreLiaison.at(i) == v)
+                return i;
+        return 0;
+    }
+
+    /** fige la géométrie de la voie une fois la maquette construite : les positions
+      * absolues des extrémités et les parcours entre extrémités sont alors précalculés.
+      */
+    void figerGeometrie();
+
     /** attribue le contact passé en paramètre à la voie.
       * \param c le contact attribué.
       */
@@ -80,18 +121,24 @@ public:
       */
     virtual void calculerPositionContact()=0;
 
-    /** Permet l'exploration récursive des voies en vue de la création des segments.
-      * \param voieAppelante pointeur sur la voie appelant récursivement celle-ci.
-      * \return Une liste de liste de voies, correspondant à tous chemins partant de cette voie
-      *         et terminant sur un contact, sauf le chemin partant depuis la voie appelante.
+    //! nombre maximum d'extrémités de sortie pour une extrémité d'entrée (aiguillage triple).
+    static const int MAX_SORTIES_EXPLORATION = 3;
+
+    /** retourne les extrémités par lesquelles une loco entrée par l'extrémité spécifiée
+      * peut ressortir, toutes positions d'aiguillage confondues, en vue de la création des segments.
+      * \param ordreEntree l'ordre de l'extrémité d'entrée.
+      * \param ordresSortie reçoit les ordres des extrémités de sortie (MAX_SORTIES_EXPLORATION au plus).
+      * \return le nombre d'extrémités de sortie, 0 si le chemin se termine sur cette voie.
       */
-    virtual QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante)=0;
+    virtual int getSortiesExploration(int ordreEntree, int *ordresSortie) const=0;
 
-    /** Démarre l'exploration contact à contact en vue de la création des segments.
-      * \return Une liste de liste de voies, correspondant à tous chemins partant de cette voie
-      *         et terminant sur un contact.
+    /** Explore, sans récursion, tous les chemins partant de cette voie et terminant sur
+      * un contact ou une voie buttoir. Les chemins sont écrits bout à bout dans un même
+      * tableau, dans l'ordre d'un parcours en profondeur des extrémités.
+      * \param voies reçoit les voies de tous les chemins, à la suite les unes des autres.
+      * \param fins reçoit, pour chaque chemin, l'indice suivant sa dernière voie dans voies.
       */
-    QList<QList<Voie*>*> startExplorationContactAContact();
+    void explorationContactAContact(QVector<Voie*> &voies, QVector<int> &fins);
 
     /** retourne le nombre de liaisons (en d'autres termes d'extrémités) de la voie.
       * \return le nombre de liaisons de la voie.
@@ -167,15 +214,28 @@ public:
       */
     virtual Voie* getVoieSuivante(Voie* voieArrivee)=0;
 
-    /** fournit les informations nécessaires a l'avancement de la locomotive d'une certaine distance.
-      * \param dist la distance à parcourir
-      * \param angle l'angle de rotation
-      * \param rayon le rayon de rotation
-      * \param angleCumule l'angle actuel de la loco
-      * \param posActuelle la position actuelle de la loco en coordonnees absolues.
-      * \param voieSuivante la voie vers laquelle se dirige la loco.
+    /** retourne l'ordre de l'extrémité par laquelle sortira une loco entrée par l'extrémité spécifiée.
+      * Par défaut, se déduit de getVoieSuivante(...).
+      * \param ordreEntree l'ordre de l'extrémité d'entrée.
+      * \return l'ordre de l'extrémité de sortie, -1 si la voie est une impasse.
+      */
+    virtual int getOrdreSuivant(int ordreEntree);
+
+    /** retourne la longueur du parcours précalculé entre deux extrémités.
+      * \param ordreEntree l'ordre de l'extrémité d'entrée, -1 pour partir du fond d'une impasse.
+      * \param ordreSortie l'ordre de l'extrémité de sortie, -1 pour une impasse.
+      * \return la longueur du parcours.
       */
-    virtual void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie* voieSuivante)=0;
+    qreal getLongueurParcours(int ordreEntree, int ordreSortie) const;
+
+    /** retourne la position et le cap d'une loco sur un parcours précalculé.
+      * \param ordreEntree l'ordre de l'extrémité d'entrée, -1 pour partir du fond d'une impasse.
+      * \param ordreSortie l'ordre de l'extrémité de sortie, -1 pour une impasse.
+      * \param abscisse la distance parcourue depuis l'entrée.
+      * \param position la position de la loco, en coordonnées de la scene.
+      * \param cap le cap de la loco en degrés (même convention que QGraphicsItem::rotation()).
+      */
+    void getPoseParcours(int ordreEntree, int ordreSortie, qreal abscisse, QPointF &position, qreal &cap) const;
 
     /** retourne la voie voisine spécifiée par son ordre.
       * \param n l'ordre de la voie
@@ -200,23 +260,42 @@ public:
       */
     virtual void correctionPosition(qreal deltaX, qreal deltaY, Voie* v)=0;
 
+    /** écrit la géométrie résolue de la voie (position, angles et coordonnées des extrémités)
+      * dans le cache de la maquette. Les sous-classes y ajoutent leurs propres grandeurs.
+      * \param flux le flux du cache.
+      */
+    virtual void sauverGeometrie(QDataStream &flux) const;
+
+    /** relit la géométrie écrite par sauverGeometrie(...), en lieu et place de
+      * calculerAnglesEtCoordonnees(...) et calculerPosition(...). La voie doit être liée.
+      * \param flux le flux du cache.
+      */
+    virtual void restaurerGeometrie(QDataStream &flux);
+
     /** permet d'afficher le rectangle englobant la voie. Utile pour le débuggage.
       * \param painter l'outil de dessin.
       */
     void drawBoundingRect(QPainter *painter);
 
-    /** permet de corriger la position d'une locomotive par rapport à une voie.
-      * \param x la correction en X
-      * \param y la correction en Y
-      */
-    virtual void correctionPositionLoco(qreal &x, qreal &y)=0;
-
     void setIdVoie(int id);
 
     int getIdVoie();
+
+    /** signale qu'une loco vient d'arriver sur la voie.
+      */
+    void entreeLoco();
+
+    /** signale qu'une loco vient de quitter la voie.
+      */
+    void sortieLoco();
+
+    /** retourne le nombre de locos présentes sur la voie.
+      * \return le nombre de locos présentes sur la voie.
+      */
+    int getNbreLocos() const;
 protected:
-    QMap<int, Voie*> ordreLiaison;
-    QMap<int, QPointF*> coordonneesLiaison;
+    QVarLengthArray<Voie*, 4> ordreLiaison;
+    QVarLengthArray<QPointF, 4> coordonneesLiaison;
     bool orientee, posee;
 
     /** normalise l'angle entre 0 et 360 degrés.
@@ -228,10 +307,34 @@ protected:
     QRectF* bRect;
     Contact* contact;
     int idVoie;
+    int nbreLocos;
 
     //virtual void mousePressEvent ( QGraphicsSceneMouseEvent * event );
 private:
-    QMap<int, qreal> angleLiaison;
+    QVarLengthArray<qreal, 4> angleLiaison;
+    QVarLengthArray<QPointF, 4> positionsAbsLiaison;
+    bool geometrieFigee;
+
+    //! parcours entre deux extrémités a < b, rangés selon indiceParcours(a, b).
+    QVarLengthArray<ParcoursVoie, 6> parcours;
+    //! parcours de chaque extrémité vers le fond de la voie, lorsque celle-ci est une impasse.
+    QVarLengthArray<ParcoursVoie, 4> impasses;
+
+    /** précalcule les parcours entre toutes les paires d'extrémités.
+      */
+    void compilerParcours();
+
+    /** calcule l'arc de cercle partant d'une extrémité, tangent à celle-ci, et passant par un point d'arrivée.
+      * \param depart la position absolue de l'extrémité de départ.
+      * \param angleLiaison l'angle de l'extrémité de départ, en radians.
+      * \param arrivee la position absolue du point d'arrivée.
+      * \return le parcours calculé.
+      */
+    static ParcoursVoie calculerParcours(const QPointF &depart, qreal angleLiaison, const QPointF &arrivee);
+
+    /** retourne l'indice du parcours reliant deux extrémités distinctes.
+      */
+    static int indiceParcours(int a, int b);
 };
 
 #endif // VOIE_H
@@ -20,7 +20,6 @@ VoieAiguillage::VoieAiguillage(qreal angle, qreal rayon, qreal longueur, qreal d
     this->etat = 0;
     this->orientee = false;
     this->posee = false;
-    this->lastDistDel = 1000.0;
 }
 #include "ctrain_handler.h"
 
@@ -50,7 +49,7 @@ void VoieAiguillage::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = ordreDe(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -75,12 +74,12 @@ void VoieAiguillage::calculerAnglesEtCoordonnees(Voie *v)
     centre.setY(- rayon * sin(getAngleRad(0) - (direction / 2.0) * PI));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX(centre.x() + rayon * cos(getAngleRad(2) - (direction / 2.0) * PI));
-    coordonneesLiaison[2]->setY(centre.y() - rayon * sin(getAngleRad(2) - (direction / 2.0) * PI));
+    coordonneesLiaison[0].setX(0.0);
+    coordonneesLiaison[0].setY(0.0);
+    coordonneesLiaison[1].setX(longueur * cos(getAngleRad(1)));
+    coordonneesLiaison[1].setY(- longueur * sin(getAngleRad(1)));
+    coordonneesLiaison[2].setX(centre.x() + rayon * cos(getAngleRad(2) - (direction / 2.0) * PI));
+    coordonneesLiaison[2].setY(centre.y() - rayon * sin(getAngleRad(2) - (direction / 2.0) * PI));
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -101,35 +100,16 @@ void VoieAiguillage::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillage::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillage::getSortiesExploration(int ordreEntree, int *ordresSortie) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
+    if(ordreEntree == 0)
     {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
+        ordresSortie[0] = 1;
+        ordresSortie[1] = 2;
+        return 2;
     }
-
-    return temp;
+    ordresSortie[0] = 0;
+    return 1;
 }
 
 qreal VoieAiguillage::getLongueurAParcourir()
@@ -144,188 +124,30 @@ qreal VoieAiguillage::getLongueurAParcourir()
     }
 }
 
-void VoieAiguillage::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante)
-{
-    if(ordreLiaison.key(voieSuivante) == 0)
-    {
-        if(normaliserAngle(angleCumule - getAngleDeg(1) - 180.0) < 1.0 &&
-           normaliserAngle(angleCumule - getAngleDeg(1) - 180.0) > -1.0)
-        {
-            angle = 0.0;
-            rayon = 0.0;
-
-            if(sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                    (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) < dist)
-            {
-                dist -= sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                             (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()));
-            }
-            else
-            {
-                dist = 0.0;
-            }
-        }
-        else
-        {
-            rayon = this->rayon;
-
-            qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-            qreal angleRestant = (getAngleDeg(0) + 360.0) - (angleCumule + 360.0);
-
-            while(angleRestant < - this->angle)
-            {
-                angleRestant += 360.0;
-            }
-            if(angleRestant > this->angle)
-            {
-                angleRestant -= 360.0;
-            }
-
-            if(angleRestant < 0.0)
-            {
-                if(- angleRestant < angleAParcourir)
-                {
-                    dist -= - angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = - angleAParcourir;
-                }
-            }
-            else
-            {
-                if(angleRestant < angleAParcourir)
-                {
-                    dist -= angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = angleAParcourir;
-                }
-            }
-        }
-    }
-    else
-    {
-        if(etat == TOUT_DROIT)
-        {
-            angle = 0.0;
-            rayon = 0.0;
-
-            if(sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                    (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) < dist)
-            {
-                dist -= sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                             (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()));
-            }
-            else
-            {
-                dist = 0.0;
-            }
-        }
-        else
-        {
-            rayon = this->rayon;
-
-            qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-            qreal angleRestant = (getAngleDeg(2) + 360.0) - (angleCumule + 360.0);
-
-            while(angleRestant < - this->angle)
-            {
-                angleRestant += 360.0;
-            }
-            if(angleRestant > this->angle)
-            {
-                angleRestant -= 360.0;
-            }
-
-            if(angleRestant < 0.0)
-            {
-                if(- angleRestant < angleAParcourir)
-                {
-                    dist -= - angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = - angleAParcourir;
-                }
-            }
-            else
-            {
-                if(angleRestant < angleAParcourir)
-                {
-                    dist -= angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = angleAParcourir;
-                }
-            }
-        }
-    }
-
-    qreal xLiaison = getPosAbsLiaison(voieSuivante).x();
-    qreal yLiaison = getPosAbsLiaison(voieSuivante).y();
-    qreal x = posActuelle.x() - xLiaison;
-    qreal y = posActuelle.y() - yLiaison;
-    qreal distDel = sqrt((x*x) + (y*y));
-
-    if(lastDistDel > distDel)
-    {
-        lastDistDel = distDel;
-    }
-    else
-    {
-        dist = 0.1;
-    }
-    if(dist > 0.0)
-    {
-        lastDistDel = 1000.0;
-    }
-}
-
 void VoieAiguillage::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(ordreDe(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
+        coordonneesLiaison[1].setX(coordonneesLiaison[1].x() - deltaX);
+        coordonneesLiaison[1].setY(coordonneesLiaison[1].y() - deltaY);
+        coordonneesLiaison[2].setX(coordonneesLiaison[2].x() - deltaX);
+        coordonneesLiaison[2].setY(coordonneesLiaison[2].y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        coordonneesLiaison[ordreDe(v)].setX(coordonneesLiaison[ordreDe(v)].x() + deltaX);
+        coordonneesLiaison[ordreDe(v)].setY(coordonneesLiaison[ordreDe(v)].y() + deltaY);
     }
 
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[2]->x() *
-                               coordonneesLiaison[2]->x() +
-                               coordonneesLiaison[2]->y() *
-                               coordonneesLiaison[2]->y());
+    qreal nouvelleCorde = sqrt(coordonneesLiaison[2].x() *
+                               coordonneesLiaison[2].x() +
+                               coordonneesLiaison[2].y() *
+                               coordonneesLiaison[2].y());
     this->rayon = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[2]->y(), - coordonneesLiaison[2]->x()) -
+    qreal anglePourCentre = atan2(- coordonneesLiaison[2].y(), - coordonneesLiaison[2].x()) -
                             direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre.
@@ -342,12 +164,6 @@ void VoieAiguillage::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 }
 
 
-void VoieAiguillage::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
-{
-    //TODO
-}
-
-
 #define min(a,b) (a<b?a:b)
 #define min3(a,b,c) (a<min(b,c)?a:min(b,c))
 
@@ -356,10 +172,10 @@ void VoieAiguillage::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
 
 QRectF VoieAiguillage::boundingRect() const
 {
-    qreal x1=min3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal x2=max3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal y1=min3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
-    qreal y2=max3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
+    qreal x1=min3(coordonneesLiaison[0].x(),coordonneesLiaison[1].x(),coordonneesLiaison[2].x());
+    qreal x2=max3(coordonneesLiaison[0].x(),coordonneesLiaison[1].x(),coordonneesLiaison[2].x());
+    qreal y1=min3(coordonneesLiaison[0].y(),coordonneesLiaison[1].y(),coordonneesLiaison[2].y());
+    qreal y2=max3(coordonneesLiaison[0].y(),coordonneesLiaison[1].y(),coordonneesLiaison[2].y());
     QRectF rect=QRectF(QPointF(x1,y1),QPointF(x2,y2));
     rect.adjust(-LARGEUR_VOIE,-LARGEUR_VOIE,LARGEUR_VOIE,LARGEUR_VOIE);
     return rect;
@@ -379,12 +195,12 @@ void VoieAiguillage::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
                          static_cast<int>((getAngleDeg(0) - (direction * 270.0)) *16),
                          static_cast<int>((direction * angle) *16));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
     }
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
         painter->setPen(p1);
         painter->drawArc(QRectF(centre.x() - rayon, centre.y() - rayon, 2.0 * rayon, 2.0 * rayon),
                          static_cast<int>((getAngleDeg(0) - (direction * 270.0)) *16.0),
@@ -402,7 +218,7 @@ void VoieAiguillage::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- coordonneesLiaison[1].y(), - coordonneesLiaison[1].x()) - PI / 2.0;
 
 /*        if (angleTranslation>PI)
             angleTranslation-=PI;
@@ -410,13 +226,13 @@ void VoieAiguillage::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
             angleTranslation+=PI;
   */
         if (direction==1.0)
-            rect = QRectF((coordonneesLiaison[1]->x()-coordonneesLiaison[0]->x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
-                        (coordonneesLiaison[1]->y()-coordonneesLiaison[0]->y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
+            rect = QRectF((coordonneesLiaison[1].x()-coordonneesLiaison[0].x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
+                        (coordonneesLiaison[1].y()-coordonneesLiaison[0].y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT); //meme constantes que pour les contacts.
         else
-            rect = QRectF((coordonneesLiaison[1]->x()-coordonneesLiaison[0]->x())/2-TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
-                        (coordonneesLiaison[1]->y()-coordonneesLiaison[0]->y())/2-TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
+            rect = QRectF((coordonneesLiaison[1].x()-coordonneesLiaison[0].x())/2-TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
+                        (coordonneesLiaison[1].y()-coordonneesLiaison[0].y())/2-TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT); //meme constantes que pour les contacts.
 
@@ -433,18 +249,24 @@ Voie* VoieAiguillage::getVoieSuivante(Voie *voieArrivee)
 {
     //gestion des deraillements!
 
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    return ordreLiaison.value(getOrdreSortie(ordreDe(voieArrivee), etat));
+}
+
+int VoieAiguillage::getOrdreSortie(int ordreEntree, int etatVoie) const
+{
+    if(ordreEntree == 0)
+        return etatVoie == TOUT_DROIT ? 1 : 2;
+    return 0;
+}
 
-    if(ordreVoieArrivee == 0)
-    {
-        if(etat == TOUT_DROIT)
-        {
-            return ordreLiaison.value(1);
-        }
-        else
-        {
-            return ordreLiaison.value(2);
-        }
-    }
-    else return ordreLiaison.value(0);
+void VoieAiguillage::sauverGeometrie(QDataStream &flux) const
+{
+    Voie::sauverGeometrie(flux);
+    flux << centre << rayon << angle << longueur << direction;
+}
+
+void VoieAiguillage::restaurerGeometrie(QDataStream &flux)
+{
+    Voie::restaurerGeometrie(flux);
+    flux >> centre >> rayon >> angle >> longueur >> direction;
 }
@@ -13,7 +13,6 @@ VoieAiguillageEnroule::VoieAiguillageEnroule(qreal angle, qreal rayon, qreal lon
     this->etat = 0;
     this->orientee = false;
     this->posee = false;
-    this->lastDistDel = 1000.0;
 }
 
 void VoieAiguillageEnroule::mousePressEvent ( QGraphicsSceneMouseEvent * /*event*/ )
@@ -37,7 +36,7 @@ void VoieAiguillageEnroule::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = ordreDe(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -66,12 +65,12 @@ void VoieAiguillageEnroule::calculerAnglesEtCoordonnees(Voie *v)
                           rayonExterieur * sin(getAngleRad(0) - (direction / 2.0) * PI));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(centreExterieur.x() + rayonExterieur * cos(getAngleRad(2) - (direction / 2.0) * PI));
-    coordonneesLiaison[1]->setY(centreExterieur.y() - rayonExterieur * sin(getAngleRad(2) - (direction / 2.0) * PI));
-    coordonneesLiaison[2]->setX(centreInterieur.x() + rayonInterieur * cos(getAngleRad(1) - (direction / 2.0) * PI));
-    coordonneesLiaison[2]->setY(centreInterieur.y() - rayonInterieur * sin(getAngleRad(1) - (direction / 2.0) * PI));
+    coordonneesLiaison[0].setX(0.0);
+    coordonneesLiaison[0].setY(0.0);
+    coordonneesLiaison[1].setX(centreExterieur.x() + rayonExterieur * cos(getAngleRad(2) - (direction / 2.0) * PI));
+    coordonneesLiaison[1].setY(centreExterieur.y() - rayonExterieur * sin(getAngleRad(2) - (direction / 2.0) * PI));
+    coordonneesLiaison[2].setX(centreInterieur.x() + rayonInterieur * cos(getAngleRad(1) - (direction / 2.0) * PI));
+    coordonneesLiaison[2].setY(centreInterieur.y() - rayonInterieur * sin(getAngleRad(1) - (direction / 2.0) * PI));
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -87,47 +86,22 @@ void VoieAiguillageEnroule::calculerAnglesEtCoordonnees(Voie *v)
 }
 
 
-void VoieAiguillageEnroule::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
-{
-    //TODO
-}
-
-
 void VoieAiguillageEnroule::calculerPositionContact()
 {
     //dummy code. A priori, on ne met pas de contact sur un aiguillage.
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillageEnroule::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillageEnroule::getSortiesExploration(int ordreEntree, int *ordresSortie) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
+    if(ordreEntree == 0)
     {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
+        ordresSortie[0] = 1;
+        ordresSortie[1] = 2;
+        return 2;
     }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    ordresSortie[0] = 0;
+    return 1;
 }
 
 qreal VoieAiguillageEnroule::getLongueurAParcourir()
@@ -142,314 +116,58 @@ qreal VoieAiguillageEnroule::getLongueurAParcourir()
     }
 }
 
-void VoieAiguillageEnroule::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante)
-{
-    QPointF positionLocoRelative = mapFromParent(posActuelle);
-
-    if(ordreLiaison.key(voieSuivante) == 0)
-    {
-        if(sqrt((positionLocoRelative.x() - centreInterieur.x()) * (positionLocoRelative.x() - centreInterieur.x()) +
-                (positionLocoRelative.y() - centreInterieur.y()) * (positionLocoRelative.y() - centreInterieur.y())) - this->rayonInterieur < 0.1 &&
-           sqrt((positionLocoRelative.x() - centreInterieur.x()) * (positionLocoRelative.x() - centreInterieur.x()) +
-                (positionLocoRelative.y() - centreInterieur.y()) * (positionLocoRelative.y() - centreInterieur.y())) - this->rayonInterieur > -0.1)
-        {
-            rayon = this->rayonInterieur;
-
-            qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-            qreal angleRestant = (getAngleDeg(0) + 360.0) - (angleCumule + 360.0);
-
-            while(angleRestant < - this->angle)
-            {
-                angleRestant += 360.0;
-            }
-            if(angleRestant > this->angle)
-            {
-                angleRestant -= 360.0;
-            }
-
-            if(angleRestant < 0.0)
-            {
-                if(- angleRestant < angleAParcourir)
-                {
-                    dist -= - angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = - angleAParcourir;
-                }
-            }
-            else
-            {
-                if(angleRestant < angleAParcourir)
-                {
-                    dist -= angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = angleAParcourir;
-                }
-            }
-        }
-        else
-        {
-            if(sqrt((positionLocoRelative.x()) * (positionLocoRelative.x()) +
-                    (positionLocoRelative.y()) * (positionLocoRelative.y())) < longueur)
-            {
-                angle = 0.0;
-                rayon = 0.0;
-
-                if(sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                        (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                        (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                        (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) < dist)
-                {
-                    dist -= sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                                 (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                                 (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                                 (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()));
-                }
-                else
-                {
-                    dist = 0.0;
-                }
-            }
-            else
-            {
-                rayon = this->rayonExterieur;
-
-                qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-                qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
-
-                while(angleRestant < - this->angle * 2.0)
-                {
-                    angleRestant += 360.0;
-                }
-                while(angleRestant > this->angle * 2.0)
-                {
-                    angleRestant -= 360.0;
-                }
-
-                if(angleRestant < 0.0)
-                {
-                    if(- angleRestant < angleAParcourir)
-                    {
-                        dist -= - angleRestant * (PI / 180.0) * rayon;
-                        angle = angleRestant;
-                    }
-                    else
-                    {
-                        dist = 0.0;
-                        angle = - angleAParcourir;
-                    }
-                }
-                else
-                {
-                    if(angleRestant < angleAParcourir)
-                    {
-                        dist -= angleRestant * (PI / 180.0) * rayon;
-                        angle = angleRestant;
-                    }
-                    else
-                    {
-                        dist = 0.0;
-                        angle = angleAParcourir;
-                    }
-                }
-            }
-        }
-    }
-    else
-    {
-        if(etat == TOUT_DROIT)
-        {
-            if(sqrt((positionLocoRelative.x()) * (positionLocoRelative.x()) +
-                    (positionLocoRelative.y()) * (positionLocoRelative.y())) < longueur)
-            {
-                angle = 0.0;
-                rayon = 0.0;
-
-                if(sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                        (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                        (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                        (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) - longueur < dist)
-                {
-                    dist -= sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                                 (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                                 (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                                 (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) - longueur;
-                }
-                else
-                {
-                    dist = 0.0;
-                }
-            }
-            else
-            {
-                rayon = this->rayonExterieur;
-
-                qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-                qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
-
-                while(angleRestant < - this->angle * 2.0)
-                {
-                    angleRestant += 360.0;
-                }
-                while(angleRestant > this->angle * 2.0)
-                {
-                    angleRestant -= 360.0;
-                }
-
-                if(angleRestant < 0.0)
-                {
-                    if(- angleRestant < angleAParcourir)
-                    {
-                        dist -= - angleRestant * (PI / 180.0) * rayon;
-                        angle = angleRestant;
-                    }
-                    else
-                    {
-                        dist = 0.0;
-                        angle = - angleAParcourir;
-                    }
-                }
-                else
-                {
-                    if(angleRestant < angleAParcourir)
-                    {
-                        dist -= angleRestant * (PI / 180.0) * rayon;
-                        angle = angleRestant;
-                    }
-                    else
-                    {
-                        dist = 0.0;
-                        angle = angleAParcourir;
-                    }
-                }
-            }
-        }
-        else
-        {
-            rayon = this->rayonInterieur;
-
-            qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-            qreal angleRestant = (getAngleDeg(2) + 360.0) - (angleCumule + 360.0);
-
-            while(angleRestant < - this->angle)
-            {
-                angleRestant += 360.0;
-            }
-            if(angleRestant > this->angle)
-            {
-                angleRestant -= 360.0;
-            }
-
-            if(angleRestant < 0.0)
-            {
-                if(- angleRestant < angleAParcourir)
-                {
-                    dist -= - angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = - angleAParcourir;
-                }
-            }
-            else
-            {
-                if(angleRestant < angleAParcourir)
-                {
-                    dist -= angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = angleAParcourir;
-                }
-            }
-        }
-    }
-
-    qreal xLiaison = getPosAbsLiaison(voieSuivante).x();
-    qreal yLiaison = getPosAbsLiaison(voieSuivante).y();
-    qreal x = posActuelle.x() - xLiaison;
-    qreal y = posActuelle.y() - yLiaison;
-    qreal distDel = sqrt((x*x) + (y*y));
-
-    if(lastDistDel > distDel)
-    {
-        lastDistDel = distDel;
-    }
-    else
-    {
-        dist = 0.1;
-    }
-    if(dist > 0.0)
-        lastDistDel = 1000.0;
-}
-
 void VoieAiguillageEnroule::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(ordreDe(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
+        coordonneesLiaison[1].setX(coordonneesLiaison[1].x() - deltaX);
+        coordonneesLiaison[1].setY(coordonneesLiaison[1].y() - deltaY);
+        coordonneesLiaison[2].setX(coordonneesLiaison[2].x() - deltaX);
+        coordonneesLiaison[2].setY(coordonneesLiaison[2].y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        coordonneesLiaison[ordreDe(v)].setX(coordonneesLiaison[ordreDe(v)].x() + deltaX);
+        coordonneesLiaison[ordreDe(v)].setY(coordonneesLiaison[ordreDe(v)].y() + deltaY);
     }
 
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[2]->x() *
-                               coordonneesLiaison[2]->x() +
-                               coordonneesLiaison[2]->y() *
-                               coordonneesLiaison[2]->y());
+    qreal nouvelleCorde = sqrt(coordonneesLiaison[2].x() *
+                               coordonneesLiaison[2].x() +
+                               coordonneesLiaison[2].y() *
+                               coordonneesLiaison[2].y());
     this->rayonInterieur = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[2]->y(), - coordonneesLiaison[2]->x()) -
+    qreal anglePourCentre = atan2(- coordonneesLiaison[2].y(), - coordonneesLiaison[2].x()) -
                            direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre interieur.
     centreInterieur.setX(- rayonInterieur * cos(anglePourCentre));
     centreInterieur.setY(- rayonInterieur * sin(anglePourCentre));
 
-    nouvelleCorde = sqrt((coordonneesLiaison[1]->x()- longueur * cos(getAngleRad(0) + PI)) *
-                         (coordonneesLiaison[1]->x()- longueur * cos(getAngleRad(0) + PI)) +
-                         (- coordonneesLiaison[1]->y()- longueur * sin(getAngleRad(0) + PI)) *
-                         (- coordonneesLiaison[1]->y()- longueur * sin(getAngleRad(0) + PI)));
+    nouvelleCorde = sqrt((coordonneesLiaison[1].x()- longueur * cos(getAngleRad(0) + PI)) *
+                         (coordonneesLiaison[1].x()- longueur * cos(getAngleRad(0) + PI)) +
+                         (- coordonneesLiaison[1].y()- longueur * sin(getAngleRad(0) + PI)) *
+                         (- coordonneesLiaison[1].y()- longueur * sin(getAngleRad(0) + PI)));
     this->rayonExterieur = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    anglePourCentre = atan2(+ coordonneesLiaison[1]->y() - longueur * sin(getAngleRad(0)),
-                            - coordonneesLiaison[1]->x()- longueur * cos(getAngleRad(0))) -
+    anglePourCentre = atan2(+ coordonneesLiaison[1].y() - longueur * sin(getAngleRad(0)),
+                            - coordonneesLiaison[1].x()- longueur * cos(getAngleRad(0))) -
                             direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre exterieur.
-    centreExterieur.setX(coordonneesLiaison[1]->x() + rayonExterieur * cos(anglePourCentre));
-    centreExterieur.setY(coordonneesLiaison[1]->y() - rayonExterieur * sin(anglePourCentre));
+    centreExterieur.setX(coordonneesLiaison[1].x() + rayonExterieur * cos(anglePourCentre));
+    centreExterieur.setY(coordonneesLiaison[1].y() - rayonExterieur * sin(anglePourCentre));
 
 
     setAngleRad(0, atan2(- centreInterieur.y(), centreInterieur.x()) + direction * PI / 2.0);
 
-    setAngleRad(1, atan2(- centreExterieur.y() + coordonneesLiaison[1]->y(),
-                         centreExterieur.x() - coordonneesLiaison[1]->x()) - direction * PI / 2.0);
+    setAngleRad(1, atan2(- centreExterieur.y() + coordonneesLiaison[1].y(),
+                         centreExterieur.x() - coordonneesLiaison[1].x()) - direction * PI / 2.0);
 
-    setAngleRad(2, atan2(- centreInterieur.y() - coordonneesLiaison[2]->y(),
-                         centreInterieur.x() + coordonneesLiaison[2]->x()) - direction * PI / 2.0);
+    setAngleRad(2, atan2(- centreInterieur.y() - coordonneesLiaison[2].y(),
+                         centreInterieur.x() + coordonneesLiaison[2].x()) - direction * PI / 2.0);
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -463,10 +181,10 @@ void VoieAiguillageEnroule::correctionPosition(qreal deltaX, qreal deltaY, Voie
 
 QRectF VoieAiguillageEnroule::boundingRect() const
 {
-    qreal x1=min3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal x2=max3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal y1=min3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
-    qreal y2=max3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
+    qreal x1=min3(coordonneesLiaison[0].x(),coordonneesLiaison[1].x(),coordonneesLiaison[2].x());
+    qreal x2=max3(coordonneesLiaison[0].x(),coordonneesLiaison[1].x(),coordonneesLiaison[2].x());
+    qreal y1=min3(coordonneesLiaison[0].y(),coordonneesLiaison[1].y(),coordonneesLiaison[2].y());
+    qreal y2=max3(coordonneesLiaison[0].y(),coordonneesLiaison[1].y(),coordonneesLiaison[2].y());
     QRectF rect=QRectF(QPointF(x1,y1),QPointF(x2,y2));
     rect.adjust(-LARGEUR_VOIE,-LARGEUR_VOIE,LARGEUR_VOIE,LARGEUR_VOIE);
     return rect;
@@ -489,7 +207,7 @@ void VoieAiguillageEnroule::paint(QPainter *painter, const QStyleOptionGraphicsI
                      static_cast<int>((getAngleDeg(0) - (direction * 270.0)) *16),
                      static_cast<int>((direction * angle) *16));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], QPointF(longueur * cos(getAngleRad(0) + PI),
+        painter->drawLine(coordonneesLiaison[0], QPointF(longueur * cos(getAngleRad(0) + PI),
                                                           - longueur * sin(getAngleRad(0) + PI)));
         painter->drawArc(QRectF(centreExterieur.x() - rayonExterieur,
                                 centreExterieur.y() - rayonExterieur,
@@ -501,7 +219,7 @@ void VoieAiguillageEnroule::paint(QPainter *painter, const QStyleOptionGraphicsI
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], QPointF(longueur * cos(getAngleRad(0) + PI),
+        painter->drawLine(coordonneesLiaison[0], QPointF(longueur * cos(getAngleRad(0) + PI),
                                                           - longueur * sin(getAngleRad(0) + PI)));
         painter->drawArc(QRectF(centreExterieur.x() - rayonExterieur,
                                 centreExterieur.y() - rayonExterieur,
@@ -528,7 +246,7 @@ void VoieAiguillageEnroule::paint(QPainter *painter, const QStyleOptionGraphicsI
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- coordonneesLiaison[1].y(), - coordonneesLiaison[1].x()) - PI / 2.0;
 
         rect = QRectF(TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
                       TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
@@ -548,18 +266,24 @@ Voie* VoieAiguillageEnroule::getVoieSuivante(Voie *voieArrivee)
 {
     //gestion des deraillements!
 
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    return ordreLiaison.value(getOrdreSortie(ordreDe(voieArrivee), etat));
+}
 
-    if(ordreVoieArrivee == 0)
-    {
-        if(etat == TOUT_DROIT)
-        {
-            return ordreLiaison.value(1);
-        }
-        else
-        {
-            return ordreLiaison.value(2);
-        }
-    }
-    else return ordreLiaison.value(0);
+int VoieAiguillageEnroule::getOrdreSortie(int ordreEntree, int etatVoie) const
+{
+    if(ordreEntree == 0)
+        return etatVoie == TOUT_DROIT ? 1 : 2;
+    return 0;
+}
+
+void VoieAiguillageEnroule::sauverGeometrie(QDataStream &flux) const
+{
+    Voie::sauverGeometrie(flux);
+    flux << centreInterieur << centreExterieur << rayonInterieur << rayonExterieur << angle << longueur << direction;
+}
+
+void VoieAiguillageEnroule::restaurerGeometrie(QDataStream &flux)
+{
+    Voie::restaurerGeometrie(flux);
+    flux >> centreInterieur >> centreExterieur >> rayonInterieur >> rayonExterieur >> angle >> longueur >> direction;
 }
@@ -12,12 +12,13 @@ public:
     void setNumVoieVariable(int numVoieVariable) override;
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int getSortiesExploration(int ordreEntree, int *ordresSortie) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
-    void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
+    int getOrdreSortie(int ordreEntree, int etatVoie) const override;
     void correctionPosition(qreal deltaX, qreal deltaY, Voie *v) override;
-    void correctionPositionLoco(qreal &, qreal &) override;
+    void sauverGeometrie(QDataStream &flux) const override;
+    void restaurerGeometrie(QDataStream &flux) override;
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
 
@@ -26,7 +27,6 @@ private:
     qreal rayonInterieur, rayonExterieur, angle, longueur, direction;
     QPointF centreInterieur;
     QPointF centreExterieur;
-    qreal lastDistDel;
 
 };
 
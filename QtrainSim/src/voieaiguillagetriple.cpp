@@ -19,7 +19,6 @@ VoieAiguillageTriple::VoieAiguillageTriple(qreal angle, qreal rayon, qreal longu
     this->etat = 0;
     this->orientee = false;
     this->posee = false;
-    this->lastDistDel = 1000.0;
 }
 
 void VoieAiguillageTriple::mousePressEvent ( QGraphicsSceneMouseEvent * /*event*/ )
@@ -45,7 +44,7 @@ void VoieAiguillageTriple::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = ordreDe(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -81,14 +80,14 @@ void VoieAiguillageTriple::calculerAnglesEtCoordonnees(Voie *v)
     centreDroite.setY(- rayonDroite * sin(getAngleRad(0) + (PI / 2.0)));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX(centreGauche.x() + rayonGauche * cos(getAngleRad(2) - (PI / 2.0)));
-    coordonneesLiaison[2]->setY(centreGauche.y() - rayonGauche * sin(getAngleRad(2) - (PI / 2.0)));
-    coordonneesLiaison[3]->setX(centreDroite.x() + rayonDroite * cos(getAngleRad(3) + (PI / 2.0)));
-    coordonneesLiaison[3]->setY(centreDroite.y() - rayonDroite * sin(getAngleRad(3) + (PI / 2.0)));
+    coordonneesLiaison[0].setX(0.0);
+    coordonneesLiaison[0].setY(0.0);
+    coordonneesLiaison[1].setX(longueur * cos(getAngleRad(1)));
+    coordonneesLiaison[1].setY(- longueur * sin(getAngleRad(1)));
+    coordonneesLiaison[2].setX(centreGauche.x() + rayonGauche * cos(getAngleRad(2) - (PI / 2.0)));
+    coordonneesLiaison[2].setY(centreGauche.y() - rayonGauche * sin(getAngleRad(2) - (PI / 2.0)));
+    coordonneesLiaison[3].setX(centreDroite.x() + rayonDroite * cos(getAngleRad(3) + (PI / 2.0)));
+    coordonneesLiaison[3].setY(centreDroite.y() - rayonDroite * sin(getAngleRad(3) + (PI / 2.0)));
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -111,36 +110,17 @@ void VoieAiguillageTriple::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillageTriple::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillageTriple::getSortiesExploration(int ordreEntree, int *ordresSortie) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
+    if(ordreEntree == 0)
     {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
+        ordresSortie[0] = 1;
+        ordresSortie[1] = 2;
+        ordresSortie[2] = 3;
+        return 3;
     }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    ordresSortie[0] = 0;
+    return 1;
 }
 
 qreal VoieAiguillageTriple::getLongueurAParcourir()
@@ -159,225 +139,33 @@ qreal VoieAiguillageTriple::getLongueurAParcourir()
     }
 }
 
-void VoieAiguillageTriple::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante)
-{
-    QPointF positionLocoRelative = mapFromParent(posActuelle);
-
-    if(ordreLiaison.key(voieSuivante) == 0)
-    {
-        if(angleCumule == normaliserAngle(getAngleDeg(1) - 180.0))
-        {
-            angle = 0.0;
-            rayon = 0.0;
-
-            if(sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                    (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) < dist)
-            {
-                dist -= sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                             (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()));
-            }
-            else
-            {
-                dist = 0.0;
-            }
-        }
-        else
-        {
-            if(sqrt((positionLocoRelative.x() - centreGauche.x()) *
-                    (positionLocoRelative.x() - centreGauche.x()) +
-                    (positionLocoRelative.y() - centreGauche.y()) *
-                    (positionLocoRelative.y() - centreGauche.y())) - rayonGauche < 0.1 &&
-               sqrt((positionLocoRelative.x() - centreGauche.x()) *
-                    (positionLocoRelative.x() - centreGauche.x()) +
-                    (positionLocoRelative.y() - centreGauche.y()) *
-                    (positionLocoRelative.y() - centreGauche.y())) - rayonGauche > -0.1)
-            {
-                rayon = this->rayonGauche;
-            }
-            else
-            {
-                rayon = this->rayonDroite;
-            }
-
-            qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-            qreal angleRestant = (getAngleDeg(0) + 360.0) - (angleCumule + 360.0);
-
-            while(angleRestant < - this->angle)
-            {
-                angleRestant += 360.0;
-            }
-            if(angleRestant > this->angle)
-            {
-                angleRestant -= 360.0;
-            }
-
-            if(angleRestant < 0.0)
-            {
-                if(- angleRestant < angleAParcourir)
-                {
-                    dist -= - angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = - angleAParcourir;
-                }
-            }
-            else
-            {
-                if(angleRestant < angleAParcourir)
-                {
-                    dist -= angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = angleAParcourir;
-                }
-            }
-        }
-    }
-    else
-    {
-        if(etat == TOUT_DROIT)
-        {
-            angle = 0.0;
-            rayon = 0.0;
-
-            if(sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                    (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                    (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) < dist)
-            {
-                dist -= sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                             (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                             (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()));
-            }
-            else
-            {
-                dist = 0.0;
-            }
-        }
-        else
-        {
-            if(sqrt((positionLocoRelative.x() - centreGauche.x()) *
-                    (positionLocoRelative.x() - centreGauche.x()) +
-                    (positionLocoRelative.y() - centreGauche.y()) *
-                    (positionLocoRelative.y() - centreGauche.y())) - rayonGauche < 0.1 &&
-               sqrt((positionLocoRelative.x() - centreGauche.x()) *
-                    (positionLocoRelative.x() - centreGauche.x()) +
-                    (positionLocoRelative.y() - centreGauche.y()) *
-                    (positionLocoRelative.y() - centreGauche.y())) - rayonGauche > -0.1)
-            {
-                rayon = this->rayonGauche;
-            }
-            else
-            {
-                rayon = this->rayonDroite;
-            }
-
-            qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-            qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
-
-            while(angleRestant < - this->angle)
-            {
-                angleRestant += 360.0;
-            }
-            if(angleRestant > this->angle)
-            {
-                angleRestant -= 360.0;
-            }
-
-            if(angleRestant < 0.0)
-            {
-                if(- angleRestant < angleAParcourir)
-                {
-                    dist -= - angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = - angleAParcourir;
-                }
-            }
-            else
-            {
-                if(angleRestant < angleAParcourir)
-                {
-                    dist -= angleRestant * (PI / 180.0) * rayon;
-                    angle = angleRestant;
-                }
-                else
-                {
-                    dist = 0.0;
-                    angle = angleAParcourir;
-                }
-            }
-        }
-    }
-
-    qreal xLiaison = getPosAbsLiaison(voieSuivante).x();
-    qreal yLiaison = getPosAbsLiaison(voieSuivante).y();
-    qreal x = posActuelle.x() - xLiaison;
-    qreal y = posActuelle.y() - yLiaison;
-    qreal distDel = sqrt((x*x) + (y*y));
-
-    if(lastDistDel > distDel)
-    {
-        lastDistDel = distDel;
-    }
-    else
-    {
-        dist = 0.1;
-    }
-    if(dist > 0.0)
-        lastDistDel = 1000.0;
-}
-
-
-void VoieAiguillageTriple::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
-{
-    //TODO
-}
-
-
 void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(ordreDe(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
-        coordonneesLiaison[3]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[3]->setY(coordonneesLiaison[2]->y() - deltaY);
+        coordonneesLiaison[1].setX(coordonneesLiaison[1].x() - deltaX);
+        coordonneesLiaison[1].setY(coordonneesLiaison[1].y() - deltaY);
+        coordonneesLiaison[2].setX(coordonneesLiaison[2].x() - deltaX);
+        coordonneesLiaison[2].setY(coordonneesLiaison[2].y() - deltaY);
+        coordonneesLiaison[3].setX(coordonneesLiaison[2].x() - deltaX);
+        coordonneesLiaison[3].setY(coordonneesLiaison[2].y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        coordonneesLiaison[ordreDe(v)].setX(coordonneesLiaison[ordreDe(v)].x() + deltaX);
+        coordonneesLiaison[ordreDe(v)].setY(coordonneesLiaison[ordreDe(v)].y() + deltaY);
     }
 
     //modifications pour courbe gauche.
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[2]->x() *
-                               coordonneesLiaison[2]->x() +
-                               coordonneesLiaison[2]->y() *
-                               coordonneesLiaison[2]->y());
+    qreal nouvelleCorde = sqrt(coordonneesLiaison[2].x() *
+                               coordonneesLiaison[2].x() +
+                               coordonneesLiaison[2].y() *
+                               coordonneesLiaison[2].y());
     this->rayonGauche = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[2]->y(), - coordonneesLiaison[2]->x()) -
+    qreal anglePourCentre = atan2(- coordonneesLiaison[2].y(), - coordonneesLiaison[2].x()) -
                             ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre gauche.
@@ -385,13 +173,13 @@ void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *
     centreGauche.setY(- rayonGauche * sin(anglePourCentre));
 
     //modifications pour courbe droite.
-    nouvelleCorde = sqrt(coordonneesLiaison[3]->x() *
-                         coordonneesLiaison[3]->x() +
-                         coordonneesLiaison[3]->y() *
-                         coordonneesLiaison[3]->y());
+    nouvelleCorde = sqrt(coordonneesLiaison[3].x() *
+                         coordonneesLiaison[3].x() +
+                         coordonneesLiaison[3].y() *
+                         coordonneesLiaison[3].y());
     this->rayonDroite = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    anglePourCentre = atan2(- coordonneesLiaison[3]->y(), - coordonneesLiaison[3]->x()) +
+    anglePourCentre = atan2(- coordonneesLiaison[3].y(), - coordonneesLiaison[3].x()) +
                       ((180.0 - angle) / 360.0) * PI;
 
 
@@ -401,13 +189,13 @@ void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *
 
     setAngleRad(0, atan2(- centreGauche.y(), centreGauche.x()) + PI / 2.0);
 
-    setAngleDeg(1, atan2(- coordonneesLiaison[1]->y(), -coordonneesLiaison[1]->x()));
+    setAngleDeg(1, atan2(- coordonneesLiaison[1].y(), -coordonneesLiaison[1].x()));
 
-    setAngleRad(2, atan2(- centreGauche.y() + coordonneesLiaison[2]->y(),
-                         centreGauche.x() - coordonneesLiaison[2]->x()) - PI / 2.0);
+    setAngleRad(2, atan2(- centreGauche.y() + coordonneesLiaison[2].y(),
+                         centreGauche.x() - coordonneesLiaison[2].x()) - PI / 2.0);
 
-    setAngleRad(3, atan2(- centreDroite.y() + coordonneesLiaison[3]->y(),
-                         centreDroite.x() - coordonneesLiaison[3]->x()) + PI / 2.0);
+    setAngleRad(3, atan2(- centreDroite.y() + coordonneesLiaison[3].y(),
+                         centreDroite.x() - coordonneesLiaison[3].x()) + PI / 2.0);
 
 
     if(this->contact != nullptr)
@@ -425,10 +213,10 @@ void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *
 
 QRectF VoieAiguillageTriple::boundingRect() const
 {
-    qreal x1=min4(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x(),coordonneesLiaison[3]->x());
-    qreal x2=max4(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x(),coordonneesLiaison[3]->x());
-    qreal y1=min4(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y(),coordonneesLiaison[3]->y());
-    qreal y2=max4(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y(),coordonneesLiaison[3]->y());
+    qreal x1=min4(coordonneesLiaison[0].x(),coordonneesLiaison[1].x(),coordonneesLiaison[2].x(),coordonneesLiaison[3].x());
+    qreal x2=max4(coordonneesLiaison[0].x(),coordonneesLiaison[1].x(),coordonneesLiaison[2].x(),coordonneesLiaison[3].x());
+    qreal y1=min4(coordonneesLiaison[0].y(),coordonneesLiaison[1].y(),coordonneesLiaison[2].y(),coordonneesLiaison[3].y());
+    qreal y2=max4(coordonneesLiaison[0].y(),coordonneesLiaison[1].y(),coordonneesLiaison[2].y(),coordonneesLiaison[3].y());
     QRectF rect=QRectF(QPointF(x1,y1),QPointF(x2,y2));
     rect.adjust(-LARGEUR_VOIE,-LARGEUR_VOIE,LARGEUR_VOIE,LARGEUR_VOIE);
     return rect;
@@ -451,12 +239,12 @@ void VoieAiguillageTriple::paint(QPainter *painter, const QStyleOptionGraphicsIt
                      static_cast<int>(-(getAngleDeg(0) *16.0 - 4320.0)),
                      static_cast<int>(-(angle *16.0)));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
     }
     else if(etat == -1)
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
         painter->drawArc(QRectF(centreDroite.x() - rayonDroite, centreDroite.y() - rayonDroite, 2.0 * rayonDroite, 2.0 * rayonDroite),
                      static_cast<int>(-(getAngleDeg(0) *16.0 - 4320.0)),
                      static_cast<int>(-(angle *16.0)));
@@ -468,7 +256,7 @@ void VoieAiguillageTriple::paint(QPainter *painter, const QStyleOptionGraphicsIt
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
         painter->drawArc(QRectF(centreGauche.x() - rayonGauche, centreGauche.y() - rayonGauche, 2.0 * rayonGauche, 2.0 * rayonGauche),
                      static_cast<int>((getAngleDeg(0) *16.0 - 4320.0)),
                      static_cast<int>(angle *16.0));
@@ -489,7 +277,7 @@ void VoieAiguillageTriple::paint(QPainter *painter, const QStyleOptionGraphicsIt
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- coordonneesLiaison[1].y(), - coordonneesLiaison[1].x()) - PI / 2.0;
 
         rect = QRectF(TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
                       TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
@@ -509,18 +297,24 @@ Voie* VoieAiguillageTriple::getVoieSuivante(Voie *voieArrivee)
 {
     //gestion des deraillements!
 
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    return ordreLiaison.value(getOrdreSortie(ordreDe(voieArrivee), etat));
+}
+
+int VoieAiguillageTriple::getOrdreSortie(int ordreEntree, int etatVoie) const
+{
+    if(ordreEntree == 0)
+        return etatVoie == TOUT_DROIT ? 1 : 2;
+    return 0;
+}
 
-    if(ordreVoieArrivee == 0)
-    {
-        if(etat == TOUT_DROIT)
-        {
-            return ordreLiaison.value(1);
-        }
-        else
-        {
-            return ordreLiaison.value(2);
-        }
-    }
-    else return ordreLiaison.value(0);
+void VoieAiguillageTriple::sauverGeometrie(QDataStream &flux) const
+{
+    Voie::sauverGeometrie(flux);
+    flux << centreGauche << centreDroite << rayonGauche << rayonDroite << angle << longueur;
+}
+
+void VoieAiguillageTriple::restaurerGeometrie(QDataStream &flux)
+{
+    Voie::restaurerGeometrie(flux);
+    flux >> centreGauche >> centreDroite >> rayonGauche >> rayonDroite >> angle >> longueur;
 }
@@ -21,8 +21,8 @@ void VoieButtoir::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
+    coordonneesLiaison[0].setX(0.0);
+    coordonneesLiaison[0].setY(0.0);
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -39,14 +39,10 @@ void VoieButtoir::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieButtoir::explorationContactAContact(Voie */*voieAppelante*/)
+int VoieButtoir::getSortiesExploration(int /*ordreEntree*/, int */*ordresSortie*/) const
 {
-    QList<QList<Voie*>*> temp;
-
-    temp.append(new QList<Voie*>);
-    temp.at(0)->append(this);
-
-    return temp;
+    //une voie buttoir termine toujours le chemin.
+    return 0;
 }
 
 qreal VoieButtoir::getLongueurAParcourir()
@@ -60,41 +56,6 @@ Voie* VoieButtoir::getVoieSuivante(Voie */*voieArrivee*/)
     return nullptr;
 }
 
-void VoieButtoir::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal /*angleCumule*/, QPointF posActuelle, Voie *voieSuivante)
-{
-    angle = 0.0;
-    rayon = 0.0;
-
-    qreal distanceAuContact = sqrt((posActuelle.x() - this->pos().x()) *
-                                   (posActuelle.x() - this->pos().x()) +
-                                   (posActuelle.y() - this->pos().y()) *
-                                   (posActuelle.y() - this->pos().y()));
-    if (distanceAuContact + LONGUEUR_LOCO / 2.0 > longueur)
-    {
-        //déclarer un deraillement.
-    }
-    else
-    {
-        if(voieSuivante == nullptr)
-        {
-            dist = 0.0;
-        }
-        else
-        {
-            if(distanceAuContact < dist)
-            {
-                dist -= distanceAuContact;
-            }
-            else
-            {
-                dist = 0.0;
-            }
-        }
-    }
-}
-
-
-
 void VoieButtoir::correctionPosition(qreal deltaX, qreal deltaY, Voie */*v*/)
 {
     //corrections...
@@ -105,22 +66,16 @@ void VoieButtoir::correctionPosition(qreal deltaX, qreal deltaY, Voie */*v*/)
 }
 
 
-void VoieButtoir::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
-{
-    //TODO
-}
-
-
 #define min(a,b) ((a<b)?(a):(b))
 
 QRectF VoieButtoir::boundingRect() const
 {
     QPointF temp = QPointF(- longueur * cos(getAngleRad(0)),
                                 longueur * sin(getAngleRad(0)));
-    QRectF rect(min(coordonneesLiaison[0]->x(),temp.x()),
-                min(coordonneesLiaison[0]->y(),temp.y()),
-                fabs(coordonneesLiaison[0]->x()-temp.x()),
-                fabs(coordonneesLiaison[0]->y()-temp.y()));
+    QRectF rect(min(coordonneesLiaison[0].x(),temp.x()),
+                min(coordonneesLiaison[0].y(),temp.y()),
+                fabs(coordonneesLiaison[0].x()-temp.x()),
+                fabs(coordonneesLiaison[0].y()-temp.y()));
     rect.adjust(-10,-10,10,10);
     return rect;
 }
@@ -132,7 +87,7 @@ void VoieButtoir::paint(QPainter *painter, const QStyleOptionGraphicsItem */*opt
     QPointF temp = QPointF(- longueur * cos(getAngleRad(0)),
                                 longueur * sin(getAngleRad(0)));
 
-    painter->drawLine(*coordonneesLiaison[0], temp);
+    painter->drawLine(coordonneesLiaison[0], temp);
     painter->drawEllipse(temp, 5.0, 5.0);
     drawBoundingRect(painter);
 
@@ -142,3 +97,15 @@ void VoieButtoir::setEtat(int /*nouvelEtat*/)
 {
     qDebug() << "Appel de setEtat sur une voie non variable.";
 }
+
+void VoieButtoir::sauverGeometrie(QDataStream &flux) const
+{
+    Voie::sauverGeometrie(flux);
+    flux << longueur;
+}
+
+void VoieButtoir::restaurerGeometrie(QDataStream &flux)
+{
+    Voie::restaurerGeometrie(flux);
+    flux >> longueur;
+}
@@ -12,12 +12,12 @@ public:
     VoieButtoir(qreal longueur);
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie *) override;
+    int getSortiesExploration(int ordreEntree, int *ordresSortie) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie*) override;
-    void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal, QPointF posActuelle, Voie *voieSuivante) override;
     void correctionPosition(qreal deltaX, qreal deltaY, Voie *) override;
-    void correctionPositionLoco(qreal &, qreal &) override;
+    void sauverGeometrie(QDataStream &flux) const override;
+    void restaurerGeometrie(QDataStream &flux) override;
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
     void setEtat(int) override;
@@ -9,7 +9,6 @@ VoieCourbe::VoieCourbe(qreal angle, qreal rayon, int direction)
     this->direction = direction;
     this->orientee = false;
     this->posee = false;
-    this->lastDistDel = 1000.0;
 }
 
 void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
@@ -22,7 +21,7 @@ void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = ordreDe(v);
 
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
@@ -41,10 +40,10 @@ void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
     centre.setY(- rayon * sin(getAngleRad(0) - (direction / 2.0) * PI));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(centre.x() + rayon * cos(getAngleRad(1) - (direction / 2.0) * PI));
-    coordonneesLiaison[1]->setY(centre.y() - rayon * sin(getAngleRad(1) - (direction / 2.0) * PI));
+    coordonneesLiaison[0].setX(0.0);
+    coordonneesLiaison[0].setY(0.0);
+    coordonneesLiaison[1].setX(centre.x() + rayon * cos(getAngleRad(1) - (direction / 2.0) * PI));
+    coordonneesLiaison[1].setY(centre.y() - rayon * sin(getAngleRad(1) - (direction / 2.0) * PI));
 
     if(this->contact != nullptr)
     {
@@ -63,33 +62,13 @@ void VoieCourbe::calculerPositionContact()
 {
     this->contact->setPos(centre.x() + rayon * cos(getAngleRad(1) - direction * (PI + angle * PI / 180.0) / 2.0),
                           centre.y() - rayon * sin(getAngleRad(1) - direction * (PI + angle * PI / 180.0) / 2.0));
-    this->contact->setAngle(atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) + direction * PI / 2.0);
+    this->contact->setAngle(atan2(- coordonneesLiaison[1].y(), - coordonneesLiaison[1].x()) + direction * PI / 2.0);
 }
 
-QList<QList<Voie*>*> VoieCourbe::explorationContactAContact(Voie* voieAppelante)
+int VoieCourbe::getSortiesExploration(int ordreEntree, int *ordresSortie) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-            temp.append(ordreLiaison.value(1)->explorationContactAContact(this));
-        else
-            temp.append(ordreLiaison.value(0)->explorationContactAContact(this));
-
-        for(int i=0; i< temp.length(); i++)
-        {
-            temp.at(i)->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    ordresSortie[0] = ordreEntree == 0 ? 1 : 0;
+    return 1;
 }
 
 qreal VoieCourbe::getLongueurAParcourir()
@@ -99,93 +78,31 @@ qreal VoieCourbe::getLongueurAParcourir()
 
 Voie* VoieCourbe::getVoieSuivante(Voie *voieArrivee)
 {
-    return ordreLiaison.value((ordreLiaison.key(voieArrivee) +1) % 2);
-}
-
-void VoieCourbe::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante)
-{
-    rayon = this->rayon;
-
-    qreal angleAParcourir = (dist / this->rayon) * (180.0 / PI);
-
-    qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
-
-    while(angleRestant < - this->angle * 2.0)
-    {
-        angleRestant += 360.0;
-    }
-    while(angleRestant > this->angle * 2.0)
-    {
-        angleRestant -= 360.0;
-    }
-
-    if(angleRestant < 0.0)
-    {
-        if(- angleRestant < angleAParcourir)
-        {
-            dist -= - angleRestant * (PI / 180.0) * rayon;
-            angle = angleRestant;
-        }
-        else
-        {
-            dist = 0.0;
-            angle = - angleAParcourir;
-        }
-    }
-    else
-    {
-        if(angleRestant < angleAParcourir)
-        {
-            dist -= angleRestant * (PI / 180.0) * rayon;
-            angle = angleRestant;
-        }
-        else
-        {
-            dist = 0.0;
-            angle = angleAParcourir;
-        }
-    }
-
-    qreal xLiaison = getPosAbsLiaison(voieSuivante).x();
-    qreal yLiaison = getPosAbsLiaison(voieSuivante).y();
-    qreal x = posActuelle.x() - xLiaison;
-    qreal y = posActuelle.y() - yLiaison;
-    qreal distDel = sqrt((x*x) + (y*y));
-
-    if(lastDistDel > distDel)
-    {
-        lastDistDel = distDel;
-    }
-    else
-    {
-        dist = 0.1;
-    }
-    if(dist > 0.0)
-        lastDistDel = 1000.0;
+    return ordreLiaison.value((ordreDe(voieArrivee) +1) % 2);
 }
 
 void VoieCourbe::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction...
-    if(ordreLiaison.key(v) ==0)
+    if(ordreDe(v) ==0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
+        coordonneesLiaison[1].setX(coordonneesLiaison[1].x() - deltaX);
+        coordonneesLiaison[1].setY(coordonneesLiaison[1].y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() + deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() + deltaY);
+        coordonneesLiaison[1].setX(coordonneesLiaison[1].x() + deltaX);
+        coordonneesLiaison[1].setY(coordonneesLiaison[1].y() + deltaY);
     }
 
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[1]->x() *
-                               coordonneesLiaison[1]->x() +
-                               coordonneesLiaison[1]->y() *
-                               coordonneesLiaison[1]->y());
+    qreal nouvelleCorde = sqrt(coordonneesLiaison[1].x() *
+                               coordonneesLiaison[1].x() +
+                               coordonneesLiaison[1].y() *
+                               coordonneesLiaison[1].y());
     this->rayon = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) -
+    qreal anglePourCentre = atan2(- coordonneesLiaison[1].y(), - coordonneesLiaison[1].x()) -
                             direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre.
@@ -201,12 +118,6 @@ void VoieCourbe::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 }
 
 
-void VoieCourbe::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
-{
-    //TODO
-}
-
-
 QRectF VoieCourbe::boundingRect() const
 {
     return QRectF(QPointF(-200.0, -200.0),
@@ -232,3 +143,17 @@ void VoieCourbe::setEtat(int /*nouvelEtat*/)
 {
     qDebug() << "Appel de setEtat sur une voie non variable.";
 }
+
+void VoieCourbe::sauverGeometrie(QDataStream &flux) const
+{
+    Voie::sauverGeometrie(flux);
+    flux << centre << rayon << angle << (qint32) direction;
+}
+
+void VoieCourbe::restaurerGeometrie(QDataStream &flux)
+{
+    Voie::restaurerGeometrie(flux);
+    qint32 luDirection;
+    flux >> centre >> rayon >> angle >> luDirection;
+    direction = luDirection;
+}
@@ -12,12 +12,12 @@ public:
     VoieCourbe(qreal angle, qreal rayon, int direction);
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int getSortiesExploration(int ordreEntree, int *ordresSortie) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
-    void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
     void correctionPosition(qreal deltaX, qreal deltaY, Voie *v) override;
-    void correctionPositionLoco(qreal &, qreal &) override;
+    void sauverGeometrie(QDataStream &flux) const override;
+    void restaurerGeometrie(QDataStream &flux) override;
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
     void setEtat(int) override;
@@ -26,7 +26,6 @@ private:
     QPointF centre;
     qreal rayon, angle;
     int direction;
-    qreal lastDistDel;
 };
 
 #endif // VOIECOURBE_H
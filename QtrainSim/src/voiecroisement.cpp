@@ -8,7 +8,6 @@ VoieCroisement::VoieCroisement(qreal angle, qreal longueur)
     this->longueur = longueur;
     this->orientee = false;
     this->posee = false;
-    this->lastDistDel = 1000.0;
 }
 
 void VoieCroisement::calculerAnglesEtCoordonnees(Voie *v)
@@ -21,7 +20,7 @@ void VoieCroisement::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = ordreDe(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -51,14 +50,14 @@ void VoieCroisement::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
-    coordonneesLiaison[2]->setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
-    coordonneesLiaison[3]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
-    coordonneesLiaison[3]->setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
+    coordonneesLiaison[0].setX(0.0);
+    coordonneesLiaison[0].setY(0.0);
+    coordonneesLiaison[1].setX(longueur * cos(getAngleRad(1)));
+    coordonneesLiaison[1].setY(- longueur * sin(getAngleRad(1)));
+    coordonneesLiaison[2].setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
+    coordonneesLiaison[2].setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
+    coordonneesLiaison[3].setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
+    coordonneesLiaison[3].setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -81,42 +80,11 @@ void VoieCroisement::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieCroisement::explorationContactAContact(Voie* voieAppelante)
+int VoieCroisement::getSortiesExploration(int ordreEntree, int *ordresSortie) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 1)
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 2)
-        {
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 3)
-        {
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    //chaque voie du croisement relie les extrémités 0-1 et 2-3.
+    ordresSortie[0] = ordreEntree ^ 1;
+    return 1;
 }
 
 qreal VoieCroisement::getLongueurAParcourir()
@@ -126,7 +94,7 @@ qreal VoieCroisement::getLongueurAParcourir()
 
 Voie* VoieCroisement::getVoieSuivante(Voie *voieArrivee)
 {
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    int ordreVoieArrivee = ordreDe(voieArrivee);
 
     if( ordreVoieArrivee == 0)
         return ordreLiaison.value(1);
@@ -138,55 +106,23 @@ Voie* VoieCroisement::getVoieSuivante(Voie *voieArrivee)
         return ordreLiaison.value(2);
 }
 
-void VoieCroisement::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal /*angleCumule*/, QPointF posActuelle, Voie *voieSuivante)
-{
-    angle = 0.0;
-    rayon = 0.0;
-
-    qreal xLiaison = getPosAbsLiaison(voieSuivante).x();
-    qreal yLiaison = getPosAbsLiaison(voieSuivante).y();
-    qreal x = posActuelle.x() - xLiaison;
-    qreal y = posActuelle.y() - yLiaison;
-    qreal distDel = sqrt((x*x) + (y*y));
-
-    if(distDel < dist)
-    {
-        dist -= distDel;
-    }
-    else
-    {
-        dist = 0.0;
-    }
-
-    if(lastDistDel > distDel)
-    {
-        lastDistDel = distDel;
-    }
-    else
-    {
-        dist = 0.1;
-    }
-    if(dist > 0.0)
-        lastDistDel = 1000.0;
-}
-
 void VoieCroisement::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(ordreDe(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
-        coordonneesLiaison[3]->setX(coordonneesLiaison[3]->x() - deltaX);
-        coordonneesLiaison[3]->setY(coordonneesLiaison[3]->y() - deltaY);
+        coordonneesLiaison[1].setX(coordonneesLiaison[1].x() - deltaX);
+        coordonneesLiaison[1].setY(coordonneesLiaison[1].y() - deltaY);
+        coordonneesLiaison[2].setX(coordonneesLiaison[2].x() - deltaX);
+        coordonneesLiaison[2].setY(coordonneesLiaison[2].y() - deltaY);
+        coordonneesLiaison[3].setX(coordonneesLiaison[3].x() - deltaX);
+        coordonneesLiaison[3].setY(coordonneesLiaison[3].y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        coordonneesLiaison[ordreDe(v)].setX(coordonneesLiaison[ordreDe(v)].x() + deltaX);
+        coordonneesLiaison[ordreDe(v)].setY(coordonneesLiaison[ordreDe(v)].y() + deltaY);
     }
 
     if(this->contact != nullptr)
@@ -194,12 +130,6 @@ void VoieCroisement::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 }
 
 
-void VoieCroisement::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
-{
-    //TODO
-}
-
-
 QRectF VoieCroisement::boundingRect() const
 {
     return QRectF(QPointF(-200.0, -200.0),
@@ -209,8 +139,8 @@ QRectF VoieCroisement::boundingRect() const
 void VoieCroisement::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
 {
     painter->setPen(this->pen());
-    painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
-    painter->drawLine(*coordonneesLiaison[2], *coordonneesLiaison[3]);
+    painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
+    painter->drawLine(coordonneesLiaison[2], coordonneesLiaison[3]);
     drawBoundingRect(painter);
 
 }
@@ -219,3 +149,15 @@ void VoieCroisement::setEtat(int /*nouvelEtat*/)
 {
     qDebug() << "Appel de setEtat sur une voie non variable.";
 }
+
+void VoieCroisement::sauverGeometrie(QDataStream &flux) const
+{
+    Voie::sauverGeometrie(flux);
+    flux << angle << longueur;
+}
+
+void VoieCroisement::restaurerGeometrie(QDataStream &flux)
+{
+    Voie::restaurerGeometrie(flux);
+    flux >> angle >> longueur;
+}
@@ -10,7 +10,6 @@ VoieTraverseeJonction::VoieTraverseeJonction(qreal angle, qreal rayon, qreal lon
     this->etat = 0;
     this->orientee = false;
     this->posee = false;
-    this->lastDistDel = 1000.0;
 }
 
 void VoieTraverseeJonction::setNumVoieVariable(int numVoieVariable)
@@ -28,7 +27,7 @@ void VoieTraverseeJonction::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = ordreDe(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -58,18 +57,18 @@ void VoieTraverseeJonction::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
-    coordonneesLiaison[2]->setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
-    coordonneesLiaison[3]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
-    coordonneesLiaison[3]->setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
+    coordonneesLiaison[0].setX(0.0);
+    coordonneesLiaison[0].setY(0.0);
+    coordonneesLiaison[1].setX(longueur * cos(getAngleRad(1)));
+    coordonneesLiaison[1].setY(- longueur * sin(getAngleRad(1)));
+    coordonneesLiaison[2].setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
+    coordonneesLiaison[2].setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
+    coordonneesLiaison[3].setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
+    coordonneesLiaison[3].setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
 
     //calculer coordonnees du centre12.
-    centre12.setX(coordonneesLiaison.value(1)->x() + rayon12 * cos(getAngleRad(1) - PI / 2.0));
-    centre12.setY(coordonneesLiaison.value(1)->y() +- rayon12 * sin(getAngleRad(1) - PI / 2.0));
+    centre12.setX(coordonneesLiaison.value(1).x() + rayon12 * cos(getAngleRad(1) - PI / 2.0));
+    centre12.setY(coordonneesLiaison.value(1).y() +- rayon12 * sin(getAngleRad(1) - PI / 2.0));
     //calculer coordonnees du centre03.
     centre03.setX(rayon03 * cos(getAngleRad(0) - PI / 2.0));
     centre03.setY(- rayon03 * sin(getAngleRad(0) - PI / 2.0));
@@ -96,36 +95,21 @@ void VoieTraverseeJonction::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieTraverseeJonction::explorationContactAContact(Voie* voieAppelante)
+int VoieTraverseeJonction::getSortiesExploration(int ordreEntree, int *ordresSortie) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
+    if(ordreEntree == 0 || ordreEntree == 2)
     {
-        if(ordreLiaison.key(voieAppelante) == 0 || ordreLiaison.key(voieAppelante) == 2)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 1 || ordreLiaison.key(voieAppelante) == 3)
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
+        ordresSortie[0] = 1;
+        ordresSortie[1] = 3;
+        return 2;
     }
-    else
+    if(ordreEntree == 1 || ordreEntree == 3)
     {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
+        ordresSortie[0] = 0;
+        ordresSortie[1] = 2;
+        return 2;
     }
-
-    return temp;
+    return 0;
 }
 
 qreal VoieTraverseeJonction::getLongueurAParcourir()
@@ -142,159 +126,49 @@ qreal VoieTraverseeJonction::getLongueurAParcourir()
 
 Voie* VoieTraverseeJonction::getVoieSuivante(Voie *voieArrivee)
 {
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
-
-    if(this->etat == TOUT_DROIT)
-    {
-        if( ordreVoieArrivee == 0)
-            return ordreLiaison.value(1);
-        else if (ordreVoieArrivee == 1)
-            return ordreLiaison.value(0);
-        else if (ordreVoieArrivee == 2)
-            return ordreLiaison.value(3);
-        else
-            return ordreLiaison.value(2);
-    }
-    else
-    {
-        if( ordreVoieArrivee == 0)
-            return ordreLiaison.value(3);
-        else if (ordreVoieArrivee == 1)
-            return ordreLiaison.value(2);
-        else if (ordreVoieArrivee == 2)
-            return ordreLiaison.value(1);
-        else
-            return ordreLiaison.value(0);
-    }
+    return ordreLiaison.value(getOrdreSortie(ordreDe(voieArrivee), etat));
 }
 
-void VoieTraverseeJonction::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante)
+int VoieTraverseeJonction::getOrdreSortie(int ordreEntree, int etatVoie) const
 {
-    QPointF positionLocoRelative = mapFromParent(posActuelle);
-
-    if(etat == TOUT_DROIT)
-    {
-        angle = 0.0;
-        rayon = 0.0;
-
-        if(sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                (posActuelle.y() - getPosAbsLiaison(voieSuivante).y())) < dist)
-        {
-            dist -= sqrt((posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) *
-                         (posActuelle.x() - getPosAbsLiaison(voieSuivante).x()) +
-                         (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()) *
-                         (posActuelle.y() - getPosAbsLiaison(voieSuivante).y()));
-        }
-        else
-        {
-            dist = 0.0;
-        }
-    }
-    else
+    if(etatVoie == TOUT_DROIT)
     {
-        if(sqrt((positionLocoRelative.x() - centre03.x()) *
-                (positionLocoRelative.x() - centre03.x()) +
-                (positionLocoRelative.y() - centre03.y()) *
-                (positionLocoRelative.y() - centre03.y())) - rayon03 < 0.1 &&
-           sqrt((positionLocoRelative.x() - centre03.x()) *
-                (positionLocoRelative.x() - centre03.x()) +
-                (positionLocoRelative.y() - centre03.y()) *
-                (positionLocoRelative.y() - centre03.y())) - rayon03 > -0.1)
-        {
-            rayon = this->rayon03;
-        }
-        else
-        {
-            rayon = this->rayon12;
-        }
-        qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
-
-        qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
-
-        while(angleRestant < - this->angle)
-        {
-            angleRestant += 360.0;
-        }
-        if(angleRestant > this->angle)
-        {
-            angleRestant -= 360.0;
-        }
-
-        if(angleRestant < 0.0)
-        {
-            if(- angleRestant < angleAParcourir)
-            {
-                dist -= - angleRestant * (PI / 180.0) * rayon;
-                angle = angleRestant;
-            }
-            else
-            {
-                dist = 0.0;
-                angle = - angleAParcourir;
-            }
-        }
-        else
-        {
-            if(angleRestant < angleAParcourir)
-            {
-                dist -= angleRestant * (PI / 180.0) * rayon;
-                angle = angleRestant;
-            }
-            else
-            {
-                dist = 0.0;
-                angle = angleAParcourir;
-            }
-        }
+        //les deux voies droites : 0-1 et 2-3.
+        static const int sortiesToutDroit[4] = {1, 0, 3, 2};
+        return sortiesToutDroit[ordreEntree];
     }
-
-    qreal xLiaison = getPosAbsLiaison(voieSuivante).x();
-    qreal yLiaison = getPosAbsLiaison(voieSuivante).y();
-    qreal x = posActuelle.x() - xLiaison;
-    qreal y = posActuelle.y() - yLiaison;
-    qreal distDel = sqrt((x*x) + (y*y));
-
-    if(lastDistDel > distDel)
-    {
-        lastDistDel = distDel;
-    }
-    else
-    {
-        dist = 0.1;
-    }
-    if(dist > 0.0)
-        lastDistDel = 1000.0;
+    //les deux voies déviées : 0-3 et 1-2.
+    static const int sortiesDevie[4] = {3, 2, 1, 0};
+    return sortiesDevie[ordreEntree];
 }
 
 void VoieTraverseeJonction::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //Correction
-    if(ordreLiaison.key(v) == 0)
+    if(ordreDe(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
-        coordonneesLiaison[3]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[3]->setY(coordonneesLiaison[2]->y() - deltaY);
+        coordonneesLiaison[1].setX(coordonneesLiaison[1].x() - deltaX);
+        coordonneesLiaison[1].setY(coordonneesLiaison[1].y() - deltaY);
+        coordonneesLiaison[2].setX(coordonneesLiaison[2].x() - deltaX);
+        coordonneesLiaison[2].setY(coordonneesLiaison[2].y() - deltaY);
+        coordonneesLiaison[3].setX(coordonneesLiaison[2].x() - deltaX);
+        coordonneesLiaison[3].setY(coordonneesLiaison[2].y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        coordonneesLiaison[ordreDe(v)].setX(coordonneesLiaison[ordreDe(v)].x() + deltaX);
+        coordonneesLiaison[ordreDe(v)].setY(coordonneesLiaison[ordreDe(v)].y() + deltaY);
     }
 
     //modifications pour courbe 03.
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[3]->x() *
-                               coordonneesLiaison[3]->x() +
-                               coordonneesLiaison[3]->y() *
-                               coordonneesLiaison[3]->y());
+    qreal nouvelleCorde = sqrt(coordonneesLiaison[3].x() *
+                               coordonneesLiaison[3].x() +
+                               coordonneesLiaison[3].y() *
+                               coordonneesLiaison[3].y());
     this->rayon03 = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[3]->y(), - coordonneesLiaison[3]->x()) -
+    qreal anglePourCentre = atan2(- coordonneesLiaison[3].y(), - coordonneesLiaison[3].x()) -
                             ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre 03.
@@ -302,30 +176,30 @@ void VoieTraverseeJonction::correctionPosition(qreal deltaX, qreal deltaY, Voie
     centre03.setY(- rayon03 * sin(anglePourCentre));
 
     //modifications pour courbe 12.
-    nouvelleCorde = sqrt((coordonneesLiaison[1]->x() - coordonneesLiaison[2]->x()) *
-                         (coordonneesLiaison[1]->x() - coordonneesLiaison[2]->x()) +
-                         (coordonneesLiaison[1]->y() - coordonneesLiaison[2]->y()) *
-                         (coordonneesLiaison[1]->y() - coordonneesLiaison[2]->y()));
+    nouvelleCorde = sqrt((coordonneesLiaison[1].x() - coordonneesLiaison[2].x()) *
+                         (coordonneesLiaison[1].x() - coordonneesLiaison[2].x()) +
+                         (coordonneesLiaison[1].y() - coordonneesLiaison[2].y()) *
+                         (coordonneesLiaison[1].y() - coordonneesLiaison[2].y()));
     this->rayon12 = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    anglePourCentre = atan2(- coordonneesLiaison[1]->y() + coordonneesLiaison[2]->y(), - coordonneesLiaison[1]->x() + coordonneesLiaison[2]->x()) +
+    anglePourCentre = atan2(- coordonneesLiaison[1].y() + coordonneesLiaison[2].y(), - coordonneesLiaison[1].x() + coordonneesLiaison[2].x()) +
                       ((180.0 - angle) / 360.0) * PI;
 
 
     //calculer coordonnees du centre 12.
-    centre12.setX(coordonneesLiaison[2]->x() - rayon12 * cos(anglePourCentre));
-    centre12.setY(coordonneesLiaison[2]->y() - rayon12 * sin(anglePourCentre));
+    centre12.setX(coordonneesLiaison[2].x() - rayon12 * cos(anglePourCentre));
+    centre12.setY(coordonneesLiaison[2].y() - rayon12 * sin(anglePourCentre));
 
     setAngleRad(0, atan2(- centre03.y(), centre03.x()) + PI / 2.0);
 
-    setAngleRad(1, atan2(- centre12.y() + coordonneesLiaison[1]->y(),
-                         centre12.x() - coordonneesLiaison[1]->x()) + PI / 2.0);
+    setAngleRad(1, atan2(- centre12.y() + coordonneesLiaison[1].y(),
+                         centre12.x() - coordonneesLiaison[1].x()) + PI / 2.0);
 
-    setAngleRad(2, atan2(- centre12.y() + coordonneesLiaison[2]->y(),
-                         centre12.x() - coordonneesLiaison[2]->x()) - PI / 2.0);
+    setAngleRad(2, atan2(- centre12.y() + coordonneesLiaison[2].y(),
+                         centre12.x() - coordonneesLiaison[2].x()) - PI / 2.0);
 
-    setAngleRad(3, atan2(- centre03.y() + coordonneesLiaison[3]->y(),
-                         centre03.x() - coordonneesLiaison[3]->x()) - PI / 2.0);
+    setAngleRad(3, atan2(- centre03.y() + coordonneesLiaison[3].y(),
+                         centre03.x() - coordonneesLiaison[3].x()) - PI / 2.0);
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -333,12 +207,6 @@ void VoieTraverseeJonction::correctionPosition(qreal deltaX, qreal deltaY, Voie
 }
 
 
-void VoieTraverseeJonction::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
-{
-    //TODO
-}
-
-
 QRectF VoieTraverseeJonction::boundingRect() const
 {
     return QRectF(QPointF(-200.0, -200.0),
@@ -362,14 +230,14 @@ void VoieTraverseeJonction::paint(QPainter *painter, const QStyleOptionGraphicsI
                          static_cast<int>((getAngleDeg(3) + 270.0) *16),
                          static_cast<int>(- angle *16));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
-        painter->drawLine(*coordonneesLiaison[2], *coordonneesLiaison[3]);
+        painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
+        painter->drawLine(coordonneesLiaison[2], coordonneesLiaison[3]);
     }
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
-        painter->drawLine(*coordonneesLiaison[2], *coordonneesLiaison[3]);
+        painter->drawLine(coordonneesLiaison[0], coordonneesLiaison[1]);
+        painter->drawLine(coordonneesLiaison[2], coordonneesLiaison[3]);
         painter->setPen(p1);
         painter->drawArc(QRectF(centre12.x() - rayon12, centre12.y() - rayon12, 2.0 * rayon12, 2.0 * rayon12),
                          static_cast<int>((getAngleDeg(1) - 270.0) *16),
@@ -397,10 +265,10 @@ void VoieTraverseeJonction::paint(QPainter *painter, const QStyleOptionGraphicsI
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- coordonneesLiaison[1].y(), - coordonneesLiaison[1].x()) - PI / 2.0;
 
-        rect = QRectF((coordonneesLiaison[1]->x()-coordonneesLiaison[0]->x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
-                      (coordonneesLiaison[1]->y()-coordonneesLiaison[0]->y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
+        rect = QRectF((coordonneesLiaison[1].x()-coordonneesLiaison[0].x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
+                      (coordonneesLiaison[1].y()-coordonneesLiaison[0].y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
                       6.0 * TAILLE_CONTACT,
                       6.0 * TAILLE_CONTACT); //meme constantes que pour les contacts.
 
@@ -418,3 +286,15 @@ void VoieTraverseeJonction::mousePressEvent ( QGraphicsSceneMouseEvent * /*event
     setEtat(1-this->etat);
     update();
 }
+
+void VoieTraverseeJonction::sauverGeometrie(QDataStream &flux) const
+{
+    Voie::sauverGeometrie(flux);
+    flux << centre03 << centre12 << rayon03 << rayon12 << angle << longueur;
+}
+
+void VoieTraverseeJonction::restaurerGeometrie(QDataStream &flux)
+{
+    Voie::restaurerGeometrie(flux);
+    flux >> centre03 >> centre12 >> rayon03 >> rayon12 >> angle >> longueur;
+}
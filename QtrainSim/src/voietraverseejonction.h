@@ -13,12 +13,13 @@ public:
     VoieTraverseeJonction(qreal angle, qreal rayon, qreal longueur);
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int getSortiesExploration(int ordreEntree, int *ordresSortie) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
-    void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
+    int getOrdreSortie(int ordreEntree, int etatVoie) const override;
     void correctionPosition(qreal deltaX, qreal deltaY, Voie *v) override;
-    void correctionPositionLoco(qreal &, qreal &) override;
+    void sauverGeometrie(QDataStream &flux) const override;
+    void restaurerGeometrie(QDataStream &flux) override;
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
     void setNumVoieVariable(int numVoieVariable) override;
@@ -28,7 +29,6 @@ private:
     qreal rayon03, rayon12, angle, longueur;
     QPointF centre03;
     QPointF centre12;
-    qreal lastDistDel;
 };
 
 #endif // VOIETRAVERSEEJONCTION_H
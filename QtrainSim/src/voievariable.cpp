@@ -11,3 +11,13 @@ void VoieVariable::setEtat(int nouvelEtat)
     this->update(boundingRect());
     etatModifie(this);
 }
+
+int VoieVariable::getNumVoieVariable() const
+{
+    return this->numVoieVariable;
+}
+
+int VoieVariable::getEtat() const
+{
+    return this->etat;
+}
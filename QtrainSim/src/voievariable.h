@@ -16,6 +16,24 @@ public:
       * \param numVoieVariable le numéro de la voie variable.
       */
     virtual void setNumVoieVariable(int numVoieVariable) = 0;
+
+    /** retourne le numéro de la voie variable.
+      * \return le numéro de la voie variable.
+      */
+    int getNumVoieVariable() const;
+
+    /** retourne l'état de la voie variable.
+      * \return l'état de la voie (DEVIE ou TOUT_DROIT, -1 à 1 pour l'aiguillage triple).
+      */
+    int getEtat() const;
+
+    /** retourne l'ordre de l'extrémité par laquelle sortira une loco entrée par l'extrémité
+      * spécifiée, pour un état donné de la voie, sans modifier son état actuel.
+      * \param ordreEntree l'ordre de l'extrémité d'entrée.
+      * \param etatVoie l'état de la voie (DEVIE ou TOUT_DROIT).
+      * \return l'ordre de l'extrémité de sortie.
+      */
+    virtual int getOrdreSortie(int ordreEntree, int etatVoie) const = 0;
 signals:
     /** signale que la voie variable a été modifiée.
       * \param v la voie modifiée.
@@ -0,0 +1,16 @@
+# Mesure le coût par pas de la détection des collisions, de 2 à 80 locos.
+# Ce n'est pas un test : make check ne le lance pas.
+
+QT -= gui
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = benchcollisions
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += main.cpp \
+           $$PWD/../../src/collision.cpp
+
+HEADERS += $$PWD/../../src/collision.h
@@ -0,0 +1,115 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "collision.h"
+
+/*
+ * Mesure le coût par pas de detecterChevauchements, la détection des collisions de
+ * SimEngine::detecterCollisions : grille de première passe, puis test exact des
+ * rectangles orientés des paires candidates. Le coût du test de toutes les paires,
+ * sans grille, est donné en comparaison.
+ *
+ * Les locos circulent sur des voies parallèles, à ECART_LOCOS les unes des autres,
+ * dans un sens sur les voies paires et dans l'autre sur les voies impaires : les
+ * locos des voies voisines se croisent sans jamais se toucher.
+ *
+ * Usage : benchcollisions [nombre de pas]
+ */
+
+static const int NB_LOCOS[] = {2, 8, 32, 80};
+
+#define NB_PAS 20000
+
+//! longueur d'une voie, distance entre deux locos d'une voie et entre deux voies.
+#define LONGUEUR_VOIE 2400.0
+#define ECART_LOCOS 160.0
+#define ECART_VOIES 60.0
+
+//! distance parcourue par une loco à chaque pas.
+#define AVANCE_PAS 2.0
+
+/** place les locos au pas donné.
+  */
+static void placerLocos(QVector<RectangleOriente> &rectangles, int pas)
+{
+    int locosParVoie = int(LONGUEUR_VOIE / ECART_LOCOS);
+
+    for(int i = 0; i < rectangles.size(); i++)
+    {
+        int voie = i / locosParVoie;
+        qreal sens = (voie % 2 == 0) ? 1.0 : -1.0;
+        qreal x = fmod((i % locosParVoie) * ECART_LOCOS + sens * pas * AVANCE_PAS + LONGUEUR_VOIE * NB_PAS, LONGUEUR_VOIE);
+
+        RectangleOriente &r = rectangles[i];
+        r.centre = QPointF(x, voie * ECART_VOIES);
+        r.ux = sens;
+        r.uy = 0.0;
+        r.demiLongueur = LONGUEUR_LOCO / 2.0;
+        r.demiLargeur = LARGEUR_LOCO / 2.0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int nbPas = (argc > 1) ? atoi(argv[1]) : NB_PAS;
+    if(nbPas <= 0)
+    {
+        fprintf(stderr, "Usage : %s [nombre de pas]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d pas, budget d'un pas : %.1f ms\n", nbPas, PAS_SIMULATION);
+    printf("locos   grille (us/pas)   grille (us/loco)   paires candidates   toutes paires (us/pas)   part du budget\n");
+
+    for(int n : NB_LOCOS)
+    {
+        QVector<RectangleOriente> rectangles(n);
+        GrilleCollision grille;
+        QVector<QPair<int, int> > paires;
+        QVector<QPair<int, int> > candidates;
+        qint64 nsGrille = 0;
+        qint64 nsToutes = 0;
+        qint64 nbPaires = 0;
+        int collisions = 0;
+        QElapsedTimer chrono;
+
+        for(int pas = 0; pas < nbPas; pas++)
+        {
+            placerLocos(rectangles, pas);
+
+            //détection de SimEngine::detecterCollisions, toutes les locos étant présentes.
+            chrono.start();
+            detecterChevauchements(grille, rectangles, QVector<bool>(), paires);
+            nsGrille += chrono.nsecsElapsed();
+            collisions += paires.size();
+
+            //paires candidates de la première passe, hors mesure : la grille est encore remplie.
+            grille.pairesCandidates(candidates);
+            nbPaires += candidates.size();
+
+            //toutes les paires, sans grille.
+            chrono.start();
+            for(int i = 0; i < n; i++)
+                for(int j = i + 1; j < n; j++)
+                {
+                    if(rectanglesSeChevauchent(rectangles.at(i), rectangles.at(j)))
+                        collisions++;
+                }
+            nsToutes += chrono.nsecsElapsed();
+        }
+
+        //les locos ne se touchent jamais : une collision signale une erreur de détection.
+        if(collisions != 0)
+            fprintf(stderr, "%d locos : %d collisions inattendues\n", n, collisions);
+
+        qreal usGrille = nsGrille / 1000.0 / nbPas;
+        printf("%5d   %15.2f   %16.3f   %17.1f   %22.2f   %13.3f %%\n", n, usGrille, usGrille / n, double(nbPaires) / nbPas,
+               nsToutes / 1000.0 / nbPas, 100.0 * usGrille / (PAS_SIMULATION * 1000.0));
+    }
+
+    return 0;
+}
@@ -0,0 +1,16 @@
+# Vérifie le test de chevauchement des rectangles orientés et la grille de collision.
+
+QT -= gui
+QT += testlib
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+TARGET = tst_collision
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += tst_collision.cpp \
+           $$PWD/../../src/collision.cpp
+
+HEADERS += $$PWD/../../src/collision.h
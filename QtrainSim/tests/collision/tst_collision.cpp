@@ -0,0 +1,129 @@
+#include <math.h>
+
+#include <QtTest>
+
+#include "collision.h"
+
+typedef QPair<int, int> Paire;
+
+/** retourne l'emprise d'une loco centrée en (x, y), orientée de angle degrés.
+  */
+static RectangleOriente loco(qreal x, qreal y, qreal angle)
+{
+    RectangleOriente r;
+    r.centre = QPointF(x, y);
+    r.ux = cos(angle * PI / 180.0);
+    r.uy = sin(angle * PI / 180.0);
+    r.demiLongueur = LONGUEUR_LOCO / 2.0;
+    r.demiLargeur = LARGEUR_LOCO / 2.0;
+    return r;
+}
+
+/**
+  Vérifie rectanglesSeChevauchent (théorème de l'axe séparateur) et la grille de
+  première passe. Les cas sont posés autour d'une loco horizontale centrée à l'origine,
+  de 120 x 30.
+  */
+class TestCollision : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void chevauchement_data();
+    void chevauchement();
+    void grille();
+    void detection();
+};
+
+void TestCollision::chevauchement_data()
+{
+    QTest::addColumn<qreal>("x");
+    QTest::addColumn<qreal>("y");
+    QTest::addColumn<qreal>("angle");
+    QTest::addColumn<bool>("attendu");
+
+    //chevauchements.
+    QTest::newRow("superposees") << 0.0 << 0.0 << 0.0 << true;
+    QTest::newRow("decalees") << 100.0 << 10.0 << 0.0 << true;
+    QTest::newRow("croisees") << 0.0 << 0.0 << 90.0 << true;
+    QTest::newRow("tournee, coin engage") << 60.0 << 40.0 << 45.0 << true;
+
+    //bords en contact : pas de chevauchement.
+    QTest::newRow("bout a bout") << 120.0 << 0.0 << 0.0 << false;
+    QTest::newRow("cote a cote") << 0.0 << 30.0 << 0.0 << false;
+    QTest::newRow("bout contre cote") << 0.0 << 75.0 << 90.0 << false;
+
+    //disjointes, bien que les cercles et les boîtes alignées sur les axes se recouvrent :
+    //seul un axe propre d'un rectangle tourné les sépare.
+    QTest::newRow("tournee, disjointe") << 90.0 << 50.0 << -45.0 << false;
+    QTest::newRow("tournee, pres du coin") << 85.0 << 55.0 << -45.0 << false;
+
+    //éloignées : écartées par les cercles englobants.
+    QTest::newRow("eloignees") << 500.0 << 0.0 << 30.0 << false;
+}
+
+void TestCollision::chevauchement()
+{
+    QFETCH(qreal, x);
+    QFETCH(qreal, y);
+    QFETCH(qreal, angle);
+    QFETCH(bool, attendu);
+
+    RectangleOriente a = loco(0.0, 0.0, 0.0);
+    RectangleOriente b = loco(x, y, angle);
+
+    QCOMPARE(rectanglesSeChevauchent(a, b), attendu);
+    QCOMPARE(rectanglesSeChevauchent(b, a), attendu);
+}
+
+void TestCollision::grille()
+{
+    GrilleCollision grille;
+    QVector<Paire> paires;
+
+    //0 et 1 dans la même cellule, 2 dans une cellule voisine en diagonale, 3 isolée.
+    grille.inserer(0, QPointF(10.0, 10.0));
+    grille.inserer(1, QPointF(60.0, 20.0));
+    grille.inserer(2, QPointF(130.0, 130.0));
+    grille.inserer(3, QPointF(1000.0, -1000.0));
+    grille.pairesCandidates(paires);
+
+    //chaque paire n'apparait qu'une fois, dans un ordre quelconque.
+    QSet<Paire> attendues;
+    attendues << qMakePair(0, 1) << qMakePair(0, 2) << qMakePair(1, 2);
+    QSet<Paire> obtenues;
+    foreach(const Paire &p, paires)
+        obtenues << (p.first < p.second ? p : qMakePair(p.second, p.first));
+    QCOMPARE(paires.size(), attendues.size());
+    QCOMPARE(obtenues, attendues);
+
+    //vidée, la grille ne propose plus aucune paire.
+    grille.vider();
+    grille.pairesCandidates(paires);
+    QVERIFY(paires.isEmpty());
+}
+
+void TestCollision::detection()
+{
+    GrilleCollision grille;
+    QVector<Paire> paires;
+
+    //0 et 1 se chevauchent, 2 est proche de 1 sans la toucher, 3 chevauche 0 mais est absente.
+    QVector<RectangleOriente> rectangles;
+    rectangles << loco(0.0, 0.0, 0.0) << loco(100.0, 10.0, 0.0) << loco(100.0, 50.0, 0.0) << loco(0.0, 0.0, 90.0);
+    QVector<bool> presents;
+    presents << true << true << true << false;
+
+    detecterChevauchements(grille, rectangles, presents, paires);
+    QCOMPARE(paires.size(), 1);
+    QCOMPARE(qMin(paires.at(0).first, paires.at(0).second), 0);
+    QCOMPARE(qMax(paires.at(0).first, paires.at(0).second), 1);
+
+    //sans masque, tous les rectangles participent : 3 chevauche aussi 0.
+    detecterChevauchements(grille, rectangles, QVector<bool>(), paires);
+    QCOMPARE(paires.size(), 2);
+}
+
+QTEST_APPLESS_MAIN(TestCollision)
+
+#include "tst_collision.moc"
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+
+# Smoke test de la simulation sans rendu : le simulateur, lancé avec --sans-rendu
+# --duree, doit avancer puis se terminer seul une fois la durée simulée écoulée.
+#
+# Usage : sansrendu.sh <exécutable du simulateur> [durée simulée en secondes]
+# Exemple : sansrendu.sh ../../code/build/prog2/dist/QtrainSim 5
+
+EXECUTABLE=$1
+DUREE=${2:-5}
+DELAI=120
+
+if [ ! -x "$EXECUTABLE" ]
+then
+    echo "Usage: $0 <QtrainSim executable> [simulated seconds]" >&2
+    exit 1
+fi
+
+timeout $DELAI "$EXECUTABLE" --sans-rendu --duree "$DUREE"
+STATUS=$?
+
+if [ $STATUS -eq 124 ]
+then
+    echo "FAIL: still running after ${DELAI} s for ${DUREE} simulated seconds" >&2
+    exit 1
+fi
+
+if [ $STATUS -ne 0 ]
+then
+    echo "FAIL: exit status $STATUS" >&2
+    exit 1
+fi
+
+echo "PASS: exited after ${DUREE} simulated seconds"
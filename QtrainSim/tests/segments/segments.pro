@@ -0,0 +1,18 @@
+# Compare les segments générés pour chaque maquette de data/Maquettes aux références
+# du répertoire references, produites par l'exploration récursive d'origine.
+
+include(../../QtrainSim.pri)
+
+QT += testlib
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_segments
+
+#le programme de test remplace celui du simulateur.
+SOURCES -= $$clean_path($$PWD/../../src/main.cpp)
+
+SOURCES += tst_segments.cpp
+
+DEFINES += REPERTOIRE_DONNEES=\\\"$$clean_path($$PWD/../../data)\\\" \
+           REPERTOIRE_REFERENCES=\\\"$$PWD/references\\\"
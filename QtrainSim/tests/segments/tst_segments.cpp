@@ -0,0 +1,154 @@
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtTest>
+
+#include "general.h"
+#include "segment.h"
+#include "simengine.h"
+
+//le simulateur attend le programme client et son arrêt d'urgence.
+int cmain()
+{
+    return 0;
+}
+
+void emergency_stop()
+{
+}
+
+/**
+  Vérifie les segments générés pour chaque maquette de data/Maquettes.
+  Chaque maquette est comparée à sa référence (references/<fichier>.segments), produite
+  par l'exploration récursive d'origine : une ligne par segment, ses deux contacts
+  (0 pour un buttoir) puis ses voies dans l'ordre du parcours. La maquette est chargée
+  une première fois depuis son fichier, puis une seconde fois depuis le cache écrit
+  par le premier chargement.
+  */
+class TestSegments : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void segments_data();
+    void segments();
+
+private:
+    /** retourne les segments de la maquette chargée, une ligne par segment, triées.
+      */
+    QStringList decrireSegments();
+
+    /** lit une référence, sans les lignes de commentaire.
+      * \param fichier le fichier de référence.
+      * \return les lignes de la référence, triées.
+      */
+    QStringList lireReference(const QString &fichier);
+
+    SimEngine moteur;
+};
+
+void TestSegments::initTestCase()
+{
+    //le moteur lit la description des voies à côté de l'exécutable.
+    QDir().mkpath(DATADIR);
+    if(!QFile::exists(DATADIR+"/infosVoies.txt"))
+        QVERIFY(QFile::copy(QString(REPERTOIRE_DONNEES)+"/infosVoies.txt", DATADIR+"/infosVoies.txt"));
+}
+
+void TestSegments::segments_data()
+{
+    QTest::addColumn<QString>("maquette");
+
+    QDir repertoire(QString(REPERTOIRE_DONNEES)+"/Maquettes");
+    foreach(const QString &nom, repertoire.entryList(QDir::Files, QDir::Name))
+    {
+        //les fichiers de cache d'un chargement précédent ne sont pas des maquettes.
+        if(!nom.endsWith(EXTENSION_CACHE_MAQUETTE))
+            QTest::newRow(qPrintable(nom)) << nom;
+    }
+}
+
+void TestSegments::segments()
+{
+    QFETCH(QString, maquette);
+
+    QString reference = QString(REPERTOIRE_REFERENCES)+"/"+maquette+".segments";
+    if(!QFile::exists(reference))
+        QSKIP("Pas de référence : la maquette n'a pas pu être chargée par l'exploration d'origine.");
+    QStringList attendus = lireReference(reference);
+
+    //la maquette est copiée, pour que son cache ne soit pas écrit dans les données.
+    QTemporaryDir repertoire;
+    QVERIFY(repertoire.isValid());
+    QString fichier = repertoire.filePath(maquette);
+    QVERIFY(QFile::copy(QString(REPERTOIRE_DONNEES)+"/Maquettes/"+maquette, fichier));
+
+    moteur.chargerMaquette(fichier);
+    QCOMPARE(decrireSegments(), attendus);
+
+    QVERIFY(QFile::exists(fichier + EXTENSION_CACHE_MAQUETTE));
+    moteur.chargerMaquette(fichier);
+    QCOMPARE(decrireSegments(), attendus);
+}
+
+QStringList TestSegments::decrireSegments()
+{
+    //un segment appartient à chacune de ses voies : il n'est décrit qu'une fois.
+    QSet<Segment*> vus;
+    QStringList lignes;
+
+    foreach(Voie* v, moteur.getVoies())
+    {
+        foreach(Segment* s, moteur.getSegmentsDeVoie(v))
+        {
+            if(vus.contains(s))
+                continue;
+            vus.insert(s);
+
+            QStringList ligne;
+            ligne << QString::number(s->getContact1()->getNumContact());
+            ligne << QString::number(s->getContact2() != nullptr ? s->getContact2()->getNumContact() : 0);
+            foreach(Voie* voie, s->getVoies())
+                ligne << QString::number(voie->getIdVoie());
+            lignes << ligne.join(" ");
+        }
+    }
+
+    lignes.sort();
+    return lignes;
+}
+
+QStringList TestSegments::lireReference(const QString &fichier)
+{
+    QStringList lignes;
+    QFile f(fichier);
+    if(!f.open(QIODevice::ReadOnly | QIODevice::Text))
+        return lignes;
+
+    QTextStream lecture(&f);
+    while(!lecture.atEnd())
+    {
+        QString ligne = lecture.readLine().trimmed();
+        if(!ligne.isEmpty() && !ligne.startsWith("#"))
+            lignes << ligne;
+    }
+
+    lignes.sort();
+    return lignes;
+}
+
+int main(int argc, char *argv[])
+{
+    //aucune fenêtre n'est ouverte : pas besoin de serveur d'affichage.
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    TestSegments test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_segments.moc"
@@ -0,0 +1,9 @@
+# Tests de QtrainSim : make check les lance tous.
+# benchcollisions est un benchmark, à lancer à la main, comme sansrendu.sh, le smoke test
+# de la simulation sans rendu, qui prend l'exécutable du simulateur en paramètre.
+
+TEMPLATE = subdirs
+
+SUBDIRS = segments \
+          collision \
+          benchcollisions
@@ -0,0 +1,14 @@
+# Outil de lecture des journaux d'événements écrits par QtrainSim (option --evenements).
+
+QT -= gui
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = lireevenements
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += main.cpp
+
+HEADERS += $$PWD/../../src/journalevenements.h
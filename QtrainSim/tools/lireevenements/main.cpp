@@ -0,0 +1,256 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QDataStream>
+#include <QMap>
+#include <QPair>
+#include <QTextStream>
+
+#include "journalevenements.h"
+
+/**
+  Lit un journal d'événements de QtrainSim et établit, pour chaque exécution, le bilan
+  des locos (contacts franchis, débit), des sections partagées (accès, attentes,
+  occupation), des aiguillages et des incidents.
+
+  Usage : lireevenements [--liste] fichier
+    --liste : affiche aussi chaque événement.
+  */
+
+struct Evenement
+{
+    qint64 instant;
+    quint8 type;
+    qint16 loco;
+    qint16 objet;
+    qint16 valeur;
+};
+
+struct BilanLoco
+{
+    int contacts = 0;
+    int vitesses = 0;
+    int deraillements = 0;
+};
+
+struct BilanSection
+{
+    int demandes = 0;
+    int acces = 0;
+    int attentes = 0;
+    qint64 attenteTotale = 0;
+    qint64 attenteMax = 0;
+    qint64 occupation = 0;
+    //! début de l'attente ou de l'accès en cours, par loco.
+    QMap<int, qint64> debutsAttente;
+    QMap<int, qint64> debutsAcces;
+};
+
+static QTextStream sortie(stdout);
+
+static const char* nomType(quint8 type)
+{
+    switch(type)
+    {
+    case JournalEvenements::DEBUT: return "DEBUT";
+    case JournalEvenements::CONTACT: return "CONTACT";
+    case JournalEvenements::VITESSE: return "VITESSE";
+    case JournalEvenements::AIGUILLAGE: return "AIGUILLAGE";
+    case JournalEvenements::SECTION_DEMANDE: return "SECTION_DEMANDE";
+    case JournalEvenements::SECTION_ATTENTE: return "SECTION_ATTENTE";
+    case JournalEvenements::SECTION_ACCES: return "SECTION_ACCES";
+    case JournalEvenements::SECTION_SORTIE: return "SECTION_SORTIE";
+    case JournalEvenements::COLLISION: return "COLLISION";
+    case JournalEvenements::DERAILLEMENT: return "DERAILLEMENT";
+    }
+    return "?";
+}
+
+static QString ms(qint64 ns)
+{
+    return QString::number(ns / 1e6, 'f', 1);
+}
+
+/** affiche le bilan d'une exécution.
+  */
+static void bilan(int numero, quint32 debut, const QVector<Evenement> &evenements)
+{
+    QMap<int, BilanLoco> locos;
+    QMap<int, BilanSection> sections;
+    QMap<int, int> aiguillages;
+    QStringList incidents;
+    qint64 duree = evenements.isEmpty() ? 0 : evenements.last().instant;
+
+    foreach(const Evenement &e, evenements)
+    {
+        switch(e.type)
+        {
+        case JournalEvenements::CONTACT:
+            locos[e.loco].contacts++;
+            break;
+        case JournalEvenements::VITESSE:
+            locos[e.loco].vitesses++;
+            break;
+        case JournalEvenements::AIGUILLAGE:
+            aiguillages[e.objet]++;
+            break;
+        case JournalEvenements::SECTION_DEMANDE:
+            sections[e.objet].demandes++;
+            break;
+        case JournalEvenements::SECTION_ATTENTE:
+            sections[e.objet].attentes++;
+            sections[e.objet].debutsAttente[e.loco] = e.instant;
+            break;
+        case JournalEvenements::SECTION_ACCES:
+        {
+            BilanSection &s = sections[e.objet];
+            s.acces++;
+            if(s.debutsAttente.contains(e.loco))
+            {
+                qint64 attente = e.instant - s.debutsAttente.take(e.loco);
+                s.attenteTotale += attente;
+                s.attenteMax = qMax(s.attenteMax, attente);
+            }
+            s.debutsAcces[e.loco] = e.instant;
+            break;
+        }
+        case JournalEvenements::SECTION_SORTIE:
+        {
+            BilanSection &s = sections[e.objet];
+            if(s.debutsAcces.contains(e.loco))
+                s.occupation += e.instant - s.debutsAcces.take(e.loco);
+            break;
+        }
+        case JournalEvenements::COLLISION:
+            incidents << QString("%1 ms : collision entre les locos %2 et %3").arg(ms(e.instant)).arg(e.loco).arg(e.objet);
+            break;
+        case JournalEvenements::DERAILLEMENT:
+            locos[e.loco].deraillements++;
+            incidents << QString("%1 ms : déraillement de la loco %2 sur l'aiguillage %3").arg(ms(e.instant)).arg(e.loco).arg(e.objet);
+            break;
+        }
+    }
+
+    //une section encore occupée à la fin de l'exécution l'est jusqu'au dernier événement.
+    QMutableMapIterator<int, BilanSection> i(sections);
+    while(i.hasNext())
+    {
+        i.next();
+        foreach(qint64 d, i.value().debutsAcces)
+            i.value().occupation += duree - d;
+    }
+
+    qreal minutes = duree / 6e10;
+
+    sortie << QString("Exécution %1, débutée le %2, durée %3 s, %4 événements\n")
+              .arg(numero)
+              .arg(QDateTime::fromMSecsSinceEpoch((qint64) debut * 1000).toString(Qt::ISODate))
+              .arg(duree / 1e9, 0, 'f', 1)
+              .arg(evenements.size());
+
+    sortie << "  loco  contacts  contacts/min  vitesses  déraillements\n";
+    QMapIterator<int, BilanLoco> l(locos);
+    while(l.hasNext())
+    {
+        l.next();
+        sortie << QString("  %1  %2  %3  %4  %5\n")
+                  .arg(l.key(), 4).arg(l.value().contacts, 8)
+                  .arg(minutes > 0 ? l.value().contacts / minutes : 0.0, 12, 'f', 1)
+                  .arg(l.value().vitesses, 8).arg(l.value().deraillements, 13);
+    }
+
+    if(!sections.isEmpty())
+    {
+        sortie << "  section  demandes  accès  attentes  attente moy. (ms)  attente max (ms)  occupation\n";
+        QMapIterator<int, BilanSection> s(sections);
+        while(s.hasNext())
+        {
+            s.next();
+            const BilanSection &b = s.value();
+            sortie << QString("  %1  %2  %3  %4  %5  %6  %7 %\n")
+                      .arg(s.key(), 7).arg(b.demandes, 8).arg(b.acces, 5).arg(b.attentes, 8)
+                      .arg(ms(b.attentes > 0 ? b.attenteTotale / b.attentes : 0), 17)
+                      .arg(ms(b.attenteMax), 16)
+                      .arg(duree > 0 ? 100.0 * b.occupation / duree : 0.0, 9, 'f', 1);
+        }
+    }
+
+    if(!aiguillages.isEmpty())
+    {
+        int total = 0;
+        foreach(int n, aiguillages)
+            total += n;
+        sortie << QString("  %1 commandes d'aiguillages sur %2 aiguillages\n").arg(total).arg(aiguillages.size());
+    }
+
+    foreach(const QString &incident, incidents)
+        sortie << "  " << incident << "\n";
+    sortie << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+    bool liste = arguments.removeAll("--liste") > 0;
+    if(arguments.size() != 1)
+    {
+        QTextStream(stderr) << "Usage : lireevenements [--liste] fichier\n";
+        return 1;
+    }
+
+    QFile fichier(arguments.first());
+    if(!fichier.open(QIODevice::ReadOnly))
+    {
+        QTextStream(stderr) << QString("Impossible d'ouvrir \"%1\".\n").arg(fichier.fileName());
+        return 1;
+    }
+
+    QDataStream flux(&fichier);
+    flux.setVersion(QDataStream::Qt_5_0);
+    flux.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magie;
+    quint16 version;
+    flux >> magie >> version;
+    if(magie != JournalEvenements::MAGIE || version != JournalEvenements::VERSION)
+    {
+        QTextStream(stderr) << QString("\"%1\" n'est pas un journal d'événements valide.\n").arg(fichier.fileName());
+        return 1;
+    }
+
+    int numero = 0;
+    quint32 debut = 0;
+    QVector<Evenement> evenements;
+    while(!flux.atEnd())
+    {
+        Evenement e;
+        flux >> e.instant >> e.type >> e.loco >> e.objet >> e.valeur;
+        if(flux.status() != QDataStream::Ok)
+        {
+            QTextStream(stderr) << "Journal tronqué : le dernier événement est ignoré.\n";
+            break;
+        }
+
+        if(liste)
+            sortie << QString("%1 %2 loco %3 objet %4 valeur %5\n")
+                      .arg(e.instant, 14).arg(nomType(e.type), -15).arg(e.loco).arg(e.objet).arg(e.valeur);
+
+        if(e.type == JournalEvenements::DEBUT)
+        {
+            if(numero > 0)
+                bilan(numero, debut, evenements);
+            numero++;
+            debut = ((quint32) (quint16) e.objet << 16) | (quint16) e.valeur;
+            evenements.clear();
+        }
+        else
+            evenements.append(e);
+    }
+    if(numero > 0)
+        bilan(numero, debut, evenements);
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 TEMPLATE = subdirs
 
 SUBDIRS = prog1 \
-          prog2
+          prog2 \
+          prog2bench
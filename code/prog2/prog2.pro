@@ -10,9 +10,18 @@ HEADERS +=  \
     src/locomotive.h \
     src/launchable.h \
     src/locomotivebehavior.h \
-    src/sharedsection.h
+    src/sharedsection.h \
+    src/sectionmanager.h \
+    src/routeplanner.h \
+    src/plannedlocomotivebehavior.h \
+    src/routederivation.h \
+    src/switchpipeline.h
 
 SOURCES +=  \
     src/locomotive.cpp \
     src/cppmain.cpp \
-    src/locomotivebehavior.cpp
+    src/locomotivebehavior.cpp \
+    src/routeplanner.cpp \
+    src/plannedlocomotivebehavior.cpp \
+    src/routederivation.cpp \
+    src/switchpipeline.cpp
@@ -9,6 +9,7 @@
 
 #include "locomotive.h"
 #include "locomotivebehavior.h"
+#include "routederivation.h"
 #include "sharedsectioninterface.h"
 #include "sharedsection.h"
 
@@ -110,17 +111,24 @@ int cmain()
     travelA.push_back({35, {}, false});
 
     // Loco 1
-    std::vector<Section> travelB;
-    travelB.push_back({31, {}, false});
-
-    travelB.push_back({30, {
-        std::make_pair<int, int>(19, TOUT_DROIT),
-        std::make_pair<int, int>(10, TOUT_DROIT),
-    }, true}),
-
-    travelB.push_back({11, {}, false});
-    travelB.push_back({4, {}, false});
-    travelB.push_back({1, {}, false});
+    // Le parcours est déduit par le simulateur des seuls contacts à visiter, contacts
+    // intermédiaires et aiguillages compris ; la section partagée va du contact 30 au 11.
+    std::vector<Section> travelB = deriveTravel({31, 30, 11, 4, 1, 31});
+    if (!travelB.empty()) {
+        markShared(travelB, 30, 11);
+    } else {
+        // Maquette réelle : la topologie n'est pas connue, le parcours est donné explicitement.
+        travelB.push_back({31, {}, false});
+
+        travelB.push_back({30, {
+            std::make_pair<int, int>(19, TOUT_DROIT),
+            std::make_pair<int, int>(10, TOUT_DROIT),
+        }, true});
+
+        travelB.push_back({11, {}, false});
+        travelB.push_back({4, {}, false});
+        travelB.push_back({1, {}, false});
+    }
 
     /***********
      * Message *
@@ -5,6 +5,8 @@
 //                                         //
 
 
+#include <algorithm>
+
 #include "locomotivebehavior.h"
 #include "ctrain_handler.h"
 
@@ -15,21 +17,38 @@ void LocomotiveBehavior::doTravel(iterator begin, iterator end, bool isReverse)
     bool inShared = false;
     bool inRequest = false;
     auto first = begin;
+    long nbSections = end - begin;
+
+    // If the loco goes in reverse mode, the section information (as the rail switches direction)
+    // of a contact is in the next section.
+    auto sectionAt = [&](long position) {
+        return first + (isReverse ? (position + 1) % nbSections : position);
+    };
+
+    // Prepare the switches of the sections following the one of the last contact passed,
+    // as long as the loco holds them: a shared section only once its access is granted.
+    long nextPrepared = 0;
+    auto prepareAhead = [&](long passed) {
+        while (nextPrepared < nbSections && nextPrepared <= passed + SwitchPipeline::LOOK_AHEAD) {
+            bool granted = inShared;
+            for (long p = std::max(passed, 0L); p <= nextPrepared && granted; ++p) {
+                granted = sectionAt(p)->isShared;
+            }
+            auto section = sectionAt(nextPrepared);
+            if ((section->isShared && !granted) || !switchPipeline.prepare(nbSteps + nextPrepared, section->railToSwitch)) {
+                break;
+            }
+            ++nextPrepared;
+        }
+    };
+
+    prepareAhead(-1);
 
     // Go through all sections.
-    while (begin != end) {
+    for (long position = 0; begin != end; ++position) {
         attendre_contact(begin->contact);
         loco.afficherMessage("I passed the contact no. " + QString(std::to_string(begin->contact).c_str()));
-        auto current = begin;
-
-        // If the loco goes in reverse mode, the current section information (as the rail switches direction)
-        // is in the next section.
-        if (isReverse) {
-            current = current + 1;
-            if (current == end) {
-                current = first;
-            }
-        }
+        auto current = sectionAt(position);
 
         if (inShared) {
             // The locomotive is currently in a shared section,
@@ -44,7 +63,9 @@ void LocomotiveBehavior::doTravel(iterator begin, iterator end, bool isReverse)
             // The locomotive enter in the shared section.
             inRequest = false;
             inShared = true;
+            switchPipeline.hold();
             sharedSection->getAccess(loco, locoId);
+            switchPipeline.resume();
         } else {
             // A request is done if the next contact is in a shared section.
             auto nextIt = current + 1;
@@ -56,13 +77,16 @@ void LocomotiveBehavior::doTravel(iterator begin, iterator end, bool isReverse)
             }
         }
 
-        // Change all train switches for needed orientation.
-        for (auto itSwitch = current->railToSwitch.cbegin(); itSwitch != current->railToSwitch.cend(); ++itSwitch) {
-            diriger_aiguillage(itSwitch->first, itSwitch->second, 0);
-        }
+        // The switches of the current section should already be set; the next ones are
+        // prepared now that the reservations are known.
+        switchPipeline.reach(nbSteps + position, current->railToSwitch);
+        nextPrepared = std::max(nextPrepared, position + 1);
+        prepareAhead(position);
 
         ++begin;
     }
+
+    nbSteps += nbSections;
 }
 
 void LocomotiveBehavior::run()
@@ -82,6 +106,7 @@ void LocomotiveBehavior::run()
             doTravel(travel.crbegin(), travel.crend(), true);
         }
         ++nbTurn;
+        loco.afficherMessage(switchPipeline.report());
 
         // Change direction after having made all the turn.
         if (nbTurn >= NB_TURN) {
@@ -10,6 +10,7 @@
 #include "locomotive.h"
 #include "launchable.h"
 #include "sharedsectioninterface.h"
+#include "switchpipeline.h"
 
 /**
  * @brief Represent a section of rail with the first contact,
@@ -35,7 +36,8 @@ public:
      * \param loco la locomotive dont on représente le comportement
      */
     LocomotiveBehavior(Locomotive& loco, std::shared_ptr<SharedSectionInterface> sharedSection, std::vector<Section> travel, LocoId locoId):
-                                                                        loco(loco), sharedSection(sharedSection), travel(travel), locoId(locoId) {
+                                                                        loco(loco), sharedSection(sharedSection), travel(travel), locoId(locoId),
+                                                                        switchPipeline(loco), nbSteps(0) {
     }
 
 protected:
@@ -77,6 +79,16 @@ protected:
      */
     LocoId locoId;
 
+    /**
+     * @brief Sets the switches of the travel ahead of the locomotive.
+     */
+    SwitchPipeline switchPipeline;
+
+    /**
+     * @brief Number of contacts passed in the previous travels, numbering the steps of the pipeline.
+     */
+    long nbSteps;
+
     /**
      * @brief Follow the travel of the train and wait if needed on
      * shared sections.
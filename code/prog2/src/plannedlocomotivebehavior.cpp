@@ -0,0 +1,80 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+
+#include <algorithm>
+
+#include "plannedlocomotivebehavior.h"
+#include "ctrain_handler.h"
+
+PlannedLocomotiveBehavior::PlannedLocomotiveBehavior(Locomotive& loco, std::shared_ptr<RoutePlanner> planner, std::vector<Section> travel):
+    loco(loco), planner(planner), travel(travel), switchPipeline(loco) {
+    std::vector<int> contacts;
+    for (const Section& section : travel) {
+        contacts.push_back(section.contact);
+    }
+    routeId = planner->addRoute(loco, contacts);
+}
+
+int PlannedLocomotiveBehavior::route() const
+{
+    return routeId;
+}
+
+void PlannedLocomotiveBehavior::run()
+{
+    //Initialisation de la locomotive
+    loco.allumerPhares();
+    loco.demarrer();
+    loco.afficherMessage("Ready!");
+
+    planner->start(routeId);
+
+    // Step s of the pipeline is the block of travel[s % n]. The switches of the blocks
+    // following the last contact passed are prepared as soon as they are reserved.
+    long n = travel.size();
+    long nextPrepared = 0;
+    auto prepareAhead = [&](long passed) {
+        while (nextPrepared <= passed + std::min(SwitchPipeline::LOOK_AHEAD, n - 1)
+               && planner->isHeld(routeId, nextPrepared % n)
+               && switchPipeline.prepare(nextPrepared, travel[nextPrepared % n].railToSwitch)) {
+            ++nextPrepared;
+        }
+    };
+
+    prepareAhead(-1);
+
+    for (long step = 0; ; ++step) {
+        size_t i = step % n;
+        attendre_contact(travel[i].contact);
+        loco.afficherMessage("I passed the contact no. " + QString::number(travel[i].contact));
+
+        // The next blocks are reserved before the switches are prepared.
+        switchPipeline.hold();
+        planner->atContact(routeId, i);
+        switchPipeline.resume();
+
+        switchPipeline.reach(step, travel[i].railToSwitch);
+        nextPrepared = std::max(nextPrepared, step + 1);
+        prepareAhead(step);
+
+        if (i == 0) {
+            loco.afficherMessage(switchPipeline.report());
+        }
+    }
+}
+
+void PlannedLocomotiveBehavior::printStartMessage()
+{
+    qDebug() << "[START] Thread de la loco" << loco.numero() << "lancé";
+    loco.afficherMessage("Je suis lancée !");
+}
+
+void PlannedLocomotiveBehavior::printCompletionMessage()
+{
+    qDebug() << "[STOP] Thread de la loco" << loco.numero() << "a terminé correctement";
+    loco.afficherMessage("J'ai terminé");
+}
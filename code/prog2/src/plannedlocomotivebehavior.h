@@ -0,0 +1,80 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#ifndef PLANNEDLOCOMOTIVEBEHAVIOR_H
+#define PLANNEDLOCOMOTIVEBEHAVIOR_H
+
+#include "locomotive.h"
+#include "launchable.h"
+#include "locomotivebehavior.h"
+#include "routeplanner.h"
+#include "switchpipeline.h"
+
+/**
+ * @brief La classe PlannedLocomotiveBehavior représente le comportement d'une locomotive
+ * dont les voies sont réservées par un RoutePlanner plutôt que par une section partagée.
+ * Le champ isShared des sections du parcours est ignoré : le planificateur détermine
+ * lui-même les blocs en conflit.
+ */
+class PlannedLocomotiveBehavior : public Launchable
+{
+public:
+    /*!
+     * \brief PlannedLocomotiveBehavior Constructeur de la classe
+     * \param loco la locomotive dont on représente le comportement
+     * \param planner le planificateur réservant les voies
+     * \param travel le parcours de la locomotive, qui démarre avant le premier contact
+     */
+    PlannedLocomotiveBehavior(Locomotive& loco, std::shared_ptr<RoutePlanner> planner, std::vector<Section> travel);
+
+    /*!
+     * \brief route Numéro de la route de la locomotive dans le planificateur
+     */
+    int route() const;
+
+protected:
+    /*!
+     * \brief run Fonction lancée par le thread, représente le comportement de la locomotive
+     */
+    void run() override;
+
+    /*!
+     * \brief printStartMessage Message affiché lors du démarrage du thread
+     */
+    void printStartMessage() override;
+
+    /*!
+     * \brief printCompletionMessage Message affiché lorsque le thread a terminé
+     */
+    void printCompletionMessage() override;
+
+    /**
+     * @brief loco La locomotive dont on représente le comportement
+     */
+    Locomotive& loco;
+
+    /**
+     * @brief planner Le planificateur réservant les voies
+     */
+    std::shared_ptr<RoutePlanner> planner;
+
+    /**
+     * @brief All section of rail where the train go through, forming a complete lap.
+     */
+    std::vector<Section> travel;
+
+    /**
+     * @brief The route of the locomotive in the planner.
+     */
+    int routeId;
+
+    /**
+     * @brief Sets the switches of the reserved blocks ahead of the locomotive.
+     */
+    SwitchPipeline switchPipeline;
+};
+
+#endif // PLANNEDLOCOMOTIVEBEHAVIOR_H
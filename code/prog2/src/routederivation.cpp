@@ -0,0 +1,59 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+
+#include <algorithm>
+
+#include "routederivation.h"
+#include "ctrain_handler.h"
+
+std::vector<Section> deriveTravel(const std::vector<int>& steps) {
+    std::vector<Section> travel;
+
+    int route = calculer_itineraire(steps.data(), steps.size());
+    if (route < 0) {
+        return travel;
+    }
+
+    // The sizes are returned even when the buffers are too small: ask twice if needed.
+    std::vector<int> contacts(steps.size());
+    int nbContacts = contacts_itineraire(route, contacts.data(), contacts.size());
+    if (nbContacts > (int) contacts.size()) {
+        contacts.resize(nbContacts);
+        contacts_itineraire(route, contacts.data(), contacts.size());
+    }
+
+    for (int i = 0; i < nbContacts; ++i) {
+        std::vector<int> switches(8);
+        std::vector<int> directions(8);
+        int nbSwitches = aiguillages_itineraire(route, i, switches.data(), directions.data(), switches.size());
+        if (nbSwitches > (int) switches.size()) {
+            switches.resize(nbSwitches);
+            directions.resize(nbSwitches);
+            aiguillages_itineraire(route, i, switches.data(), directions.data(), switches.size());
+        }
+
+        Section section{contacts[i], {}, false};
+        for (int s = 0; s < nbSwitches; ++s) {
+            section.railToSwitch.push_back(std::make_pair(switches[s], directions[s]));
+        }
+        travel.push_back(section);
+    }
+
+    return travel;
+}
+
+void markShared(std::vector<Section>& travel, int from, int to) {
+    auto begin = std::find_if(travel.begin(), travel.end(), [from](const Section& s) { return s.contact == from; });
+    if (begin == travel.end()) {
+        return;
+    }
+
+    // The travel is cyclic: the shared part may wrap around its end.
+    for (size_t i = begin - travel.begin(), n = 0; n < travel.size() && travel[i].contact != to; i = (i + 1) % travel.size(), ++n) {
+        travel[i].isShared = true;
+    }
+}
@@ -0,0 +1,36 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#ifndef ROUTEDERIVATION_H
+#define ROUTEDERIVATION_H
+
+#include <vector>
+
+#include "locomotivebehavior.h"
+
+/**
+ * @brief deriveTravel Construit le parcours d'une locomotive d'après les seuls contacts
+ * par lesquels il doit passer. Le simulateur cherche le chemin sur le graphe des voies
+ * (calculer_itineraire) et donne les contacts intermédiaires ainsi que la direction des
+ * aiguillages à traverser ; le résultat est mis en cache par le simulateur.
+ * @param steps Les contacts à visiter, dans l'ordre. Le dernier doit être égal au premier
+ * pour obtenir un parcours cyclique, utilisable par LocomotiveBehavior.
+ * @return Les sections du parcours, non partagées, ou un parcours vide si l'itinéraire
+ * n'existe pas ou si la topologie n'est pas connue (maquette réelle) ; la raison est
+ * affichée par le simulateur.
+ */
+std::vector<Section> deriveTravel(const std::vector<int>& steps);
+
+/**
+ * @brief markShared Marque comme partagées les sections d'un parcours dérivé, de celle du
+ * contact from jusqu'à celle du contact to exclue, contacts intermédiaires compris.
+ * @param travel Le parcours, tel que retourné par deriveTravel.
+ * @param from Le contact d'entrée dans la section partagée.
+ * @param to Le premier contact après la section partagée.
+ */
+void markShared(std::vector<Section>& travel, int from, int to);
+
+#endif // ROUTEDERIVATION_H
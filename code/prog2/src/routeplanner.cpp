@@ -0,0 +1,291 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+
+#include "routeplanner.h"
+#include "ctrain_handler.h"
+
+RoutePlanner::RoutePlanner(): mutex(1), startTime(std::chrono::steady_clock::now()) {
+}
+
+int RoutePlanner::addRoute(Locomotive& loco, const std::vector<int>& contacts) {
+    routes.push_back({&loco, contacts, {}, {}, -1});
+    wakeups.push_back(std::make_unique<PcoSemaphore>(0));
+    return routes.size() - 1;
+}
+
+std::set<int> RoutePlanner::blockTracks(int contactA, int contactB) {
+    std::vector<int> tracks(32);
+    int nbTracks = voies_segment(contactA, contactB, tracks.data(), tracks.size());
+
+    if (nbTracks < 0) {
+        // Unknown topology: the contacts (as negative ids) stand for the tracks,
+        // so that only blocks sharing a contact conflict.
+        return {-contactA, -contactB};
+    }
+
+    if (nbTracks > (int) tracks.size()) {
+        tracks.resize(nbTracks);
+        voies_segment(contactA, contactB, tracks.data(), tracks.size());
+    }
+    return std::set<int>(tracks.begin(), tracks.begin() + nbTracks);
+}
+
+bool RoutePlanner::plan() {
+    mutex.acquire();
+
+    // Cut each route into blocks.
+    std::vector<std::set<int>> routeTracks(routes.size());
+    for (size_t r = 0; r < routes.size(); ++r) {
+        Route& route = routes[r];
+        size_t n = route.contacts.size();
+        if (n < 2) {
+            mutex.release();
+            afficher_message(qPrintable(QString("The route of engine no. %1 needs at least two contacts.").arg(route.loco->numero())));
+            return false;
+        }
+
+        route.blocks.clear();
+        route.held.assign(n, false);
+        for (size_t i = 0; i < n; ++i) {
+            route.blocks.push_back({blockTracks(route.contacts[i], route.contacts[(i + 1) % n]), false});
+            routeTracks[r].insert(route.blocks.back().tracks.begin(), route.blocks.back().tracks.end());
+        }
+    }
+
+    // A block is private if no other route uses any of its tracks.
+    for (size_t r = 0; r < routes.size(); ++r) {
+        Route& route = routes[r];
+        bool hasPrivate = false;
+
+        for (Block& block : route.blocks) {
+            block.isPrivate = true;
+            for (size_t q = 0; q < routes.size() && block.isPrivate; ++q) {
+                if (q == r) {
+                    continue;
+                }
+                for (int track : block.tracks) {
+                    if (routeTracks[q].count(track)) {
+                        block.isPrivate = false;
+                        break;
+                    }
+                }
+            }
+            hasPrivate = hasPrivate || block.isPrivate;
+        }
+
+        if (!hasPrivate) {
+            mutex.release();
+            afficher_message(qPrintable(QString("The route of engine no. %1 has no private block to wait in.").arg(route.loco->numero())));
+            return false;
+        }
+    }
+
+    // Each loco starts between the last and the first contact of its route.
+    for (size_t r = 0; r < routes.size(); ++r) {
+        std::vector<size_t> blocks = reservation(routes[r], routes[r].blocks.size() - 1);
+        std::set<int> tracks;
+        for (size_t b : blocks) {
+            tracks.insert(routes[r].blocks[b].tracks.begin(), routes[r].blocks[b].tracks.end());
+        }
+
+        if (!isFree(r, tracks)) {
+            mutex.release();
+            afficher_message(qPrintable(QString("The engine no. %1 starts on tracks reserved by another engine.").arg(routes[r].loco->numero())));
+            return false;
+        }
+        take(r, blocks);
+    }
+
+    startTime = std::chrono::steady_clock::now();
+    mutex.release();
+    return true;
+}
+
+std::vector<size_t> RoutePlanner::reservation(const Route& r, size_t first) const {
+    std::vector<size_t> blocks;
+    size_t n = r.blocks.size();
+    size_t b = first;
+
+    // The zone, then the private block that ends it.
+    while (!r.blocks[b].isPrivate) {
+        blocks.push_back(b);
+        b = (b + 1) % n;
+    }
+    blocks.push_back(b);
+    return blocks;
+}
+
+void RoutePlanner::start(int route) {
+    if (!routes[route].held[0]) {
+        reserve(route, reservation(routes[route], 0));
+    }
+}
+
+void RoutePlanner::atContact(int route, size_t index) {
+    Route& r = routes[route];
+    size_t n = r.blocks.size();
+
+    mutex.acquire();
+
+    // The loco has left the previous block.
+    size_t previous = (index + n - 1) % n;
+    if (r.held[previous]) {
+        release(route, previous);
+        wakeWaiters();
+    }
+
+    bool lapDone = (index == 0 && ++r.laps > 0);
+    long total = 0;
+    for (const Route& other : routes) {
+        total += other.laps > 0 ? other.laps : 0;
+    }
+
+    mutex.release();
+
+    if (lapDone) {
+        double minutes = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() / 60.0;
+        afficher_message(qPrintable(QString("The engine no. %1 completed lap %2 (%3 engine-laps per minute).")
+                                    .arg(r.loco->numero())
+                                    .arg(r.laps)
+                                    .arg(minutes > 0.0 ? total / minutes : 0.0, 0, 'f', 1)));
+    }
+
+    // The block after the current one must be reserved before the loco reaches it.
+    size_t next = (index + 1) % n;
+    if (!r.held[next]) {
+        reserve(route, reservation(r, next));
+    }
+}
+
+bool RoutePlanner::isHeld(int route, size_t block) {
+    mutex.acquire();
+    bool held = routes[route].held[block];
+    mutex.release();
+    return held;
+}
+
+void RoutePlanner::reserve(int route, const std::vector<size_t>& blocks) {
+    Route& r = routes[route];
+    std::set<int> tracks;
+    for (size_t b : blocks) {
+        tracks.insert(r.blocks[b].tracks.begin(), r.blocks[b].tracks.end());
+    }
+
+    mutex.acquire();
+
+    // Earlier waiters wanting one of these tracks are served first.
+    bool overtakes = false;
+    for (const Waiter& w : waiters) {
+        for (int track : w.tracks) {
+            if (tracks.count(track)) {
+                overtakes = true;
+                break;
+            }
+        }
+    }
+
+    if (!overtakes && isFree(route, tracks)) {
+        take(route, blocks);
+        mutex.release();
+        return;
+    }
+
+    waiters.push_back({route, blocks, tracks});
+    PcoSemaphore* wakeup = wakeups[route].get();
+    mutex.release();
+
+    r.loco->afficherMessage("Waiting for the next blocks.");
+    r.loco->arreter();
+    // The reservation is granted by wakeWaiters before the wakeup.
+    wakeup->acquire();
+    r.loco->demarrer();
+}
+
+void RoutePlanner::release(int route, size_t block) {
+    Route& r = routes[route];
+    r.held[block] = false;
+
+    for (int track : r.blocks[block].tracks) {
+        auto owner = owners.find(track);
+        if (owner != owners.end() && --owner->second.second == 0) {
+            owners.erase(owner);
+        }
+    }
+}
+
+bool RoutePlanner::isFree(int route, const std::set<int>& tracks) const {
+    for (int track : tracks) {
+        auto owner = owners.find(track);
+        if (owner != owners.end() && owner->second.first != route) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RoutePlanner::take(int route, const std::vector<size_t>& blocks) {
+    Route& r = routes[route];
+
+    for (size_t b : blocks) {
+        if (r.held[b]) {
+            continue;
+        }
+        r.held[b] = true;
+        for (int track : r.blocks[b].tracks) {
+            auto owner = owners.find(track);
+            if (owner == owners.end()) {
+                owners[track] = std::make_pair(route, 1);
+            } else {
+                owner->second.second++;
+            }
+        }
+    }
+}
+
+void RoutePlanner::wakeWaiters() {
+    std::set<int> wantedEarlier;
+
+    for (auto w = waiters.begin(); w != waiters.end();) {
+        bool overtakes = false;
+        for (int track : w->tracks) {
+            if (wantedEarlier.count(track)) {
+                overtakes = true;
+                break;
+            }
+        }
+
+        if (!overtakes && isFree(w->route, w->tracks)) {
+            take(w->route, w->blocks);
+            wakeups[w->route]->release();
+            w = waiters.erase(w);
+        } else {
+            wantedEarlier.insert(w->tracks.begin(), w->tracks.end());
+            ++w;
+        }
+    }
+}
+
+QString RoutePlanner::report() {
+    mutex.acquire();
+
+    double minutes = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() / 60.0;
+    long total = 0;
+    QString text;
+
+    for (const Route& r : routes) {
+        long laps = r.laps > 0 ? r.laps : 0;
+        total += laps;
+        text += QString("Engine no. %1: %2 laps\n").arg(r.loco->numero()).arg(laps);
+    }
+    text += QString("%1 engine-laps in %2 min, %3 engine-laps per minute.")
+            .arg(total)
+            .arg(minutes, 0, 'f', 1)
+            .arg(minutes > 0.0 ? total / minutes : 0.0, 0, 'f', 1);
+
+    mutex.release();
+    return text;
+}
@@ -0,0 +1,183 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#ifndef ROUTEPLANNER_H
+#define ROUTEPLANNER_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QString>
+
+#include <pcosynchro/pcosemaphore.h>
+
+#include "locomotive.h"
+
+/**
+ * @brief La classe RoutePlanner réserve les voies de N locomotives parcourant chacune
+ * une route, donnée par la suite cyclique des contacts franchis.
+ *
+ * Chaque route est découpée en blocs, un bloc étant le segment entre deux contacts
+ * successifs ; les voies de chaque bloc sont demandées au simulateur (voies_segment).
+ * Un bloc est privé s'il ne partage aucune voie avec les blocs des autres routes ;
+ * les blocs partagés consécutifs forment une zone.
+ *
+ * Avant d'entrer dans une zone, la locomotive réserve atomiquement tous les blocs de la
+ * zone et le bloc privé qui la suit, et les libère un à un en les quittant. Elle n'attend
+ * donc jamais que depuis un bloc privé, sans détenir de voie convoitée par une autre :
+ * aucune attente circulaire, donc aucun interblocage, quel que soit le nombre de locos.
+ * Les demandes en attente sont servies dans l'ordre de leur arrivée.
+ */
+class RoutePlanner
+{
+public:
+    RoutePlanner();
+
+    /**
+     * @brief addRoute Ajoute une locomotive et sa route.
+     * @param loco La locomotive
+     * @param contacts Les contacts de la route, dans l'ordre de parcours. La locomotive
+     * démarre entre le dernier et le premier contact.
+     * @return Le numéro de la route
+     */
+    int addRoute(Locomotive& loco, const std::vector<int>& contacts);
+
+    /**
+     * @brief plan Calcule les blocs, les zones de chaque route et réserve les blocs sur
+     * lesquels les locomotives démarrent. A appeler une fois toutes les routes ajoutées,
+     * avant le lancement des threads.
+     * @return false si une route n'a aucun bloc privé ou si deux locomotives démarrent
+     * sur des voies communes ; la raison est affichée.
+     */
+    bool plan();
+
+    /**
+     * @brief start Réserve les blocs précédant le premier contact de la route.
+     * Méthode à appeler par le thread de la locomotive avant son départ.
+     * @param route Le numéro de la route
+     */
+    void start(int route);
+
+    /**
+     * @brief atContact Méthode à appeler lorsque la locomotive franchit le contact
+     * d'indice index de sa route : libère le bloc quitté et réserve si nécessaire les
+     * blocs suivants. Arrête la locomotive et met son thread en attente tant que la
+     * réservation n'est pas possible.
+     * @param route Le numéro de la route
+     * @param index L'indice du contact franchi dans la route
+     */
+    void atContact(int route, size_t index);
+
+    /**
+     * @brief isHeld Indique si une route détient un bloc : la locomotive peut alors
+     * préparer les aiguillages de ce bloc.
+     * @param route Le numéro de la route
+     * @param block L'indice du bloc, c'est-à-dire de son contact de départ dans la route
+     */
+    bool isHeld(int route, size_t block);
+
+    /**
+     * @brief report Retourne le débit de la simulation : tours effectués par chaque
+     * locomotive et tours-locomotives par minute depuis le calcul du plan.
+     */
+    QString report();
+
+private:
+    /**
+     * @brief A block of a route: the tracks between two successive contacts.
+     */
+    struct Block {
+        std::set<int> tracks;
+        bool isPrivate;
+    };
+
+    /**
+     * @brief A locomotive, its route and the blocks it currently holds.
+     */
+    struct Route {
+        Locomotive* loco;
+        std::vector<int> contacts;
+        std::vector<Block> blocks;
+        std::vector<bool> held;
+        //! laps completed, -1 before the first pass of the first contact.
+        long laps;
+    };
+
+    /**
+     * @brief A reservation waiting for its tracks to be free.
+     */
+    struct Waiter {
+        int route;
+        std::vector<size_t> blocks;
+        std::set<int> tracks;
+    };
+
+    PcoSemaphore mutex;
+
+    std::vector<Route> routes;
+
+    /**
+     * For each reserved track, the route holding it and the number of its held blocks using it.
+     */
+    std::map<int, std::pair<int, int>> owners;
+
+    /**
+     * Pending reservations, in arrival order.
+     */
+    std::vector<Waiter> waiters;
+
+    /**
+     * One semaphore per route, on which its thread waits for a reservation.
+     */
+    std::vector<std::unique_ptr<PcoSemaphore>> wakeups;
+
+    std::chrono::steady_clock::time_point startTime;
+
+    /**
+     * @brief blockTracks Ask the simulator for the tracks between two contacts.
+     * Without known topology, the contacts themselves stand for the tracks.
+     */
+    static std::set<int> blockTracks(int contactA, int contactB);
+
+    /**
+     * @brief reservation Blocks to reserve before entering block first: the zone starting
+     * at first and the private block that follows it, or first alone if it is private.
+     */
+    std::vector<size_t> reservation(const Route& r, size_t first) const;
+
+    /**
+     * @brief reserve Reserve atomically the given blocks, waiting if another route holds
+     * one of their tracks. The locomotive is stopped while waiting.
+     */
+    void reserve(int route, const std::vector<size_t>& blocks);
+
+    /**
+     * @brief release Release one block. The mutex must be held.
+     */
+    void release(int route, size_t block);
+
+    /**
+     * @brief isFree Determine if a route can take all the given tracks. The mutex must be held.
+     */
+    bool isFree(int route, const std::set<int>& tracks) const;
+
+    /**
+     * @brief take Mark the tracks of the given blocks as held. The mutex must be held.
+     */
+    void take(int route, const std::vector<size_t>& blocks);
+
+    /**
+     * @brief wakeWaiters Grant pending reservations that can now be served, in arrival
+     * order; a waiter is never overtaken by a later one wanting one of its tracks.
+     * The mutex must be held.
+     */
+    void wakeWaiters();
+};
+
+#endif // ROUTEPLANNER_H
@@ -0,0 +1,280 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#ifndef SECTIONMANAGER_H
+#define SECTIONMANAGER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+
+#include <pcosynchro/pcosemaphore.h>
+
+#include "locomotive.h"
+#include "ctrain_handler.h"
+#include "sharedsectioninterface.h"
+
+/**
+ * @brief La classe SectionManager gère l'accès de N locomotives à M sections partagées,
+ * avec le même protocole que SharedSectionInterface : request deux contacts avant la
+ * section, getAccess un contact avant, leave à la sortie.
+ * Chaque section tient la file des locomotives l'ayant demandée ; la section libérée
+ * est attribuée à la tête de file, dans l'ordre des demandes (FIFO) ou selon la priorité
+ * des locomotives (Locomotive::priority, puis ordre des demandes).
+ * Les locomotives sont identifiées par leur numéro.
+ */
+class SectionManager
+{
+public:
+    using EntryPoint = SharedSectionInterface::EntryPoint;
+
+    /**
+     * @brief An enum to represent the order in which waiting locomotives get a section
+     */
+    enum class Policy {
+        FIFO,
+        PRIORITY
+    };
+
+    /**
+     * @brief SectionManager Constructeur du gestionnaire de sections.
+     * @param nbSections Le nombre de sections partagées gérées, numérotées de 0 à nbSections - 1
+     * @param policy L'ordre d'attribution des sections aux locomotives en attente. Avec
+     * Policy::PRIORITY, Locomotive::priority doit être fixée avant le lancement des threads.
+     */
+    SectionManager(int nbSections, Policy policy = Policy::FIFO): mutex(1), sections(nbSections), policy(policy), nextTicket(0) {
+    }
+
+    /**
+     * @brief request Méthode a appeler pour indiquer que la locomotive désire accéder à une
+     * section partagée (deux contacts avant la section partagée).
+     * @param loco La locomotive qui désire accéder
+     * @param section Le numéro de la section
+     * @param entryPoint Le point d'entree de la locomotive qui fait l'appel
+     */
+    void request(Locomotive& loco, int section, EntryPoint entryPoint) {
+        mutex.acquire();
+
+        // Enqueue the request, unless the loco already holds one for this section.
+        SectionState& state = sections.at(section);
+        if (findRequest(state, loco.numero()) == state.requests.end()) {
+            state.requests.push_back({loco.numero(), loco.priority, nextTicket++, false});
+        }
+
+        mutex.release();
+
+        journaliser_section(loco.numero(), section, SECTION_DEMANDE, entryPoint == EntryPoint::EA ? 0 : 1);
+        afficher_message(qPrintable(QString("The engine no. %1 requested the shared section %2 from entry %3.")
+                                    .arg(loco.numero())
+                                    .arg(section)
+                                    .arg(entryPoint == EntryPoint::EA ? "A" : "B")
+        ));
+    }
+
+    /**
+     * @brief getAccess Méthode à appeler pour accéder à une section partagée, arrête la
+     * locomotive et met son thread en attente si la section est occupée ou si une locomotive
+     * la précède dans la file. Le thread est reveillé et la locomotive redémarrée lorsque la
+     * section lui est attribuée. (méthode à appeler un contact avant la section partagée).
+     * @param loco La locomotive qui essaie accéder à la section partagée
+     * @param section Le numéro de la section
+     */
+    void getAccess(Locomotive& loco, int section) {
+        mutex.acquire();
+
+        SectionState& state = sections.at(section);
+
+        // A loco calling getAccess without request is queued now.
+        if (findRequest(state, loco.numero()) == state.requests.end()) {
+            state.requests.push_back({loco.numero(), loco.priority, nextTicket++, false});
+        }
+
+        if (!state.occupied && head(state)->locoId == loco.numero()) {
+            // The section is free and this loco is the next one to get it.
+            state.requests.erase(head(state));
+            state.occupied = true;
+            state.occupant = loco.numero();
+            mutex.release();
+
+            loco.afficherMessage("I can access the section.");
+        } else {
+            // The loco waits until the section is handed over to it by leave.
+            findRequest(state, loco.numero())->isWaiting = true;
+            PcoSemaphore& wakeup = wakeupOf(loco.numero());
+            mutex.release();
+
+            journaliser_section(loco.numero(), section, SECTION_ATTENTE, 0);
+            loco.afficherMessage("I can't access the section.");
+            loco.arreter();
+            wakeup.acquire();
+            loco.demarrer();
+        }
+
+        journaliser_section(loco.numero(), section, SECTION_ACCES, 0);
+        afficher_message(qPrintable(QString("The engine no. %1 accesses the shared section %2.").arg(loco.numero()).arg(section)));
+    }
+
+    /**
+     * @brief leave Méthode à appeler pour indiquer que la locomotive est sortie d'une section
+     * partagée. La section est attribuée à la tête de file si celle-ci attend déjà ; sinon elle
+     * reste libre jusqu'à son getAccess. Un leave d'une locomotive qui n'occupe pas la section
+     * est ignoré.
+     * @param loco La locomotive qui quitte la section partagée
+     * @param section Le numéro de la section
+     */
+    void leave(Locomotive& loco, int section) {
+        mutex.acquire();
+
+        SectionState& state = sections.at(section);
+
+        // Only the occupant may free the section: another loco would hand it over while
+        // the occupant is still inside.
+        if (!state.occupied || state.occupant != loco.numero()) {
+            mutex.release();
+
+            loco.afficherMessage(QString("I do not occupy the section %1, leave ignored.").arg(section));
+            return;
+        }
+
+        state.occupied = false;
+        state.occupant = -1;
+
+        if (!state.requests.empty()) {
+            auto next = head(state);
+            if (next->isWaiting) {
+                // Hand the section over to the waiting loco.
+                state.occupied = true;
+                state.occupant = next->locoId;
+                PcoSemaphore& wakeup = wakeupOf(next->locoId);
+                state.requests.erase(next);
+                wakeup.release();
+            }
+        }
+
+        mutex.release();
+
+        journaliser_section(loco.numero(), section, SECTION_SORTIE, 0);
+        afficher_message(qPrintable(QString("The engine no. %1 leaves the shared section %2.").arg(loco.numero()).arg(section)));
+    }
+
+private:
+    /**
+     * @brief A request of a locomotive for a section.
+     */
+    struct Request {
+        int locoId;
+        int priority;
+        unsigned long ticket;
+        bool isWaiting;
+    };
+
+    /**
+     * @brief State of one shared section and its queue of requests.
+     */
+    struct SectionState {
+        bool occupied = false;
+        int occupant = -1;
+        std::vector<Request> requests;
+    };
+
+    /**
+     * Semaphore protecting the state of all sections.
+     */
+    PcoSemaphore mutex;
+
+    /**
+     * One semaphore per locomotive, on which its thread waits for a section.
+     */
+    std::map<int, std::unique_ptr<PcoSemaphore>> wakeups;
+
+    std::vector<SectionState> sections;
+
+    Policy policy;
+
+    /**
+     * Order of the requests, shared by all sections.
+     */
+    unsigned long nextTicket;
+
+    /**
+     * @brief findRequest Find the request of a locomotive in the queue of a section.
+     * @return The request, or requests.end() if the loco has none.
+     */
+    std::vector<Request>::iterator findRequest(SectionState& state, int locoId) {
+        for (auto it = state.requests.begin(); it != state.requests.end(); ++it) {
+            if (it->locoId == locoId) {
+                return it;
+            }
+        }
+        return state.requests.end();
+    }
+
+    /**
+     * @brief head Determine the request that will get the section next.
+     * The queue must not be empty.
+     */
+    std::vector<Request>::iterator head(SectionState& state) {
+        auto best = state.requests.begin();
+        for (auto it = best + 1; it != state.requests.end(); ++it) {
+            if (policy == Policy::PRIORITY && it->priority != best->priority) {
+                if (it->priority > best->priority) {
+                    best = it;
+                }
+            } else if (it->ticket < best->ticket) {
+                best = it;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief wakeupOf Return the semaphore of a locomotive, created on its first wait.
+     * Must be called with the mutex held.
+     */
+    PcoSemaphore& wakeupOf(int locoId) {
+        std::unique_ptr<PcoSemaphore>& wakeup = wakeups[locoId];
+        if (!wakeup) {
+            wakeup = std::make_unique<PcoSemaphore>(0);
+        }
+        return *wakeup;
+    }
+};
+
+/**
+ * @brief La classe ManagedSharedSection présente une section d'un SectionManager sous
+ * l'interface SharedSectionInterface, afin d'être utilisée par LocomotiveBehavior.
+ */
+class ManagedSharedSection final : public SharedSectionInterface
+{
+public:
+    /**
+     * @brief ManagedSharedSection Constructeur de la classe.
+     * @param manager Le gestionnaire de sections
+     * @param section Le numéro de la section représentée
+     */
+    ManagedSharedSection(std::shared_ptr<SectionManager> manager, int section): manager(manager), section(section) {
+    }
+
+    void request(Locomotive& loco, LocoId, EntryPoint entryPoint) override {
+        manager->request(loco, section, entryPoint);
+    }
+
+    void getAccess(Locomotive& loco, LocoId) override {
+        manager->getAccess(loco, section);
+    }
+
+    void leave(Locomotive& loco, LocoId) override {
+        manager->leave(loco, section);
+    }
+
+private:
+    std::shared_ptr<SectionManager> manager;
+    int section;
+};
+
+#endif // SECTIONMANAGER_H
@@ -26,9 +26,10 @@ public:
     /**
      * @brief SharedSection Constructeur de la classe qui représente la section partagée.
      * Initialisez vos éventuels attributs ici, sémaphores etc.
+     * @param id Le numéro de la section dans le journal des événements
      */
-    SharedSection(): blocking(0), mutex(1), locoAEntry(EntryPoint::EA), locoBEntry(EntryPoint::EA),
-        locoARequest(false), locoBRequest(false), occupied(false), isWaiting(false) {
+    SharedSection(int id = 0): blocking(0), mutex(1), locoAEntry(EntryPoint::EA), locoBEntry(EntryPoint::EA),
+        locoARequest(false), locoBRequest(false), occupied(false), isWaiting(false), id(id) {
     }
 
     /**
@@ -55,6 +56,7 @@ public:
 
         mutex.release();
 
+        journaliser_section(loco.numero(), id, SECTION_DEMANDE, entryPoint == EntryPoint::EA ? 0 : 1);
         afficher_message(qPrintable(QString("The engine no. %1 with id %2 requested the shared section from entry %3.")
                                     .arg(loco.numero())
                                     .arg(locoId == LocoId::LA ? "A" : "B")
@@ -80,6 +82,7 @@ public:
             isWaiting = true;
             mutex.release();
 
+            journaliser_section(loco.numero(), id, SECTION_ATTENTE, 0);
             loco.afficherMessage("I can't access the section.");
             loco.arreter();
             blocking.acquire();
@@ -104,6 +107,7 @@ public:
 
         mutex.release();
 
+        journaliser_section(loco.numero(), id, SECTION_ACCES, 0);
         afficher_message(qPrintable(QString("The engine no. %1 with id %2 accesses the shared section.").arg(loco.numero()).arg(locoId == LocoId::LA ? "A" : "B")));
     }
 
@@ -127,6 +131,7 @@ public:
             mutex.release();
         }
 
+        journaliser_section(loco.numero(), id, SECTION_SORTIE, 0);
         afficher_message(qPrintable(QString("The engine no. %1 with id %2 leaves the shared section.").arg(loco.numero()).arg(locoId == LocoId::LA ? "A" : "B")));
     }
 
@@ -151,6 +156,11 @@ private:
      */
     bool occupied, isWaiting;
 
+    /**
+     * Number of the section in the event log.
+     */
+    int id;
+
 
     /**
      * @brief canAccess Determine if the given locomotive can access
@@ -0,0 +1,143 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+
+#include "switchpipeline.h"
+#include "ctrain_handler.h"
+
+SwitchPipeline::SwitchPipeline(Locomotive& loco): loco(loco), mutex(1), pending(0), nextBatch(0), doneBatch(0), slowedUntil(0),
+                                                  normalSpeed(0), held(false), nbSent(0), nbCoalesced(0), nbReached(0), nbLate(0) {
+    thread = std::make_unique<PcoThread>(&SwitchPipeline::run, this);
+}
+
+SwitchPipeline::~SwitchPipeline() {
+    // The thread stops when it finds the queue empty.
+    pending.release();
+    thread->join();
+}
+
+bool SwitchPipeline::prepare(long step, const Switches& switches) {
+    // A switch must not move under a step the loco has not left yet.
+    for (const auto& prepared : window) {
+        for (const auto& earlier : prepared.second.switches) {
+            for (const auto& later : switches) {
+                if (earlier.first == later.first && earlier.second != later.second) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    window[step] = {submit(switches), switches};
+    return true;
+}
+
+bool SwitchPipeline::reach(long step, const Switches& switches) {
+    // The previous steps have been left.
+    window.erase(window.begin(), window.lower_bound(step));
+
+    auto prepared = window.find(step);
+    if (prepared == window.end()) {
+        prepared = window.insert({step, {submit(switches), switches}}).first;
+    }
+    unsigned long id = prepared->second.id;
+
+    mutex.acquire();
+    ++nbReached;
+    bool inTime = doneBatch >= id;
+    if (!inTime) {
+        ++nbLate;
+        if (slowedUntil == 0) {
+            normalSpeed = loco.vitesse();
+            mettre_vitesse_progressive(loco.numero(), (normalSpeed + 1) / 2);
+        }
+        slowedUntil = id;
+    }
+    mutex.release();
+
+    if (!inTime) {
+        loco.afficherMessage("The switches are late, slowing down.");
+    }
+    return inTime;
+}
+
+void SwitchPipeline::hold() {
+    mutex.acquire();
+    held = true;
+    mutex.release();
+}
+
+void SwitchPipeline::resume() {
+    mutex.acquire();
+    held = false;
+    if (slowedUntil != 0 && doneBatch < slowedUntil) {
+        // The loco may have been restarted at full speed meanwhile.
+        mettre_vitesse_progressive(loco.numero(), (normalSpeed + 1) / 2);
+    }
+    restoreSpeed();
+    mutex.release();
+}
+
+QString SwitchPipeline::report() {
+    mutex.acquire();
+    QString text = QString("Switches: %1 commands sent, %2 avoided, late at %3 of %4 contacts.")
+            .arg(nbSent).arg(nbCoalesced).arg(nbLate).arg(nbReached);
+    mutex.release();
+    return text;
+}
+
+unsigned long SwitchPipeline::submit(const Switches& switches) {
+    mutex.acquire();
+    unsigned long id = ++nextBatch;
+    queue.push_back({id, switches});
+    mutex.release();
+
+    pending.release();
+    return id;
+}
+
+void SwitchPipeline::restoreSpeed() {
+    if (slowedUntil != 0 && !held && doneBatch >= slowedUntil) {
+        mettre_vitesse_progressive(loco.numero(), normalSpeed);
+        slowedUntil = 0;
+    }
+}
+
+void SwitchPipeline::run() {
+    while (true) {
+        pending.acquire();
+
+        mutex.acquire();
+        if (queue.empty()) {
+            mutex.release();
+            break;
+        }
+        Batch batch = queue.front();
+        queue.pop_front();
+        mutex.release();
+
+        unsigned long sent = 0;
+        unsigned long coalesced = 0;
+        for (const auto& command : batch.switches) {
+            // The command is always issued: the simulator skips it when it applies it if the
+            // switch is already set. The lookup only estimates the commands avoided, against
+            // the applied state: a command queued but not applied yet is counted as sent again.
+            if (etat_aiguillage(command.first, nullptr) == command.second) {
+                ++coalesced;
+            } else {
+                ++sent;
+            }
+            diriger_aiguillage(command.first, command.second, 0);
+        }
+
+        mutex.acquire();
+        doneBatch = batch.id;
+        nbSent += sent;
+        nbCoalesced += coalesced;
+        restoreSpeed();
+        mutex.release();
+    }
+}
@@ -0,0 +1,164 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#ifndef SWITCHPIPELINE_H
+#define SWITCHPIPELINE_H
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QString>
+
+#include <pcosynchro/pcosemaphore.h>
+#include <pcosynchro/pcothread.h>
+
+#include "locomotive.h"
+
+/**
+ * @brief La classe SwitchPipeline dirige les aiguillages du parcours d'une locomotive
+ * depuis un thread dédié, afin que le thread de la locomotive ne soit jamais bloqué par
+ * diriger_aiguillage.
+ *
+ * Le parcours est découpé en étapes numérotées, l'étape k commençant au franchissement de
+ * son contact. Dès que l'étape k est atteinte (et sa réservation obtenue), le thread de la
+ * locomotive prépare les aiguillages des étapes k + 1 et k + 2 (prepare) ; il vérifie au
+ * franchissement de chaque contact que ceux de l'étape ont été dirigés (reach). S'ils sont
+ * en retard, la locomotive est ralentie jusqu'à ce qu'ils le soient.
+ *
+ * Chaque commande est transmise par diriger_aiguillage ; le simulateur ne l'exécute pas si
+ * l'aiguillage est déjà dans la direction demandée lorsqu'il l'applique. Le pipeline estime
+ * le nombre de commandes évitées d'après etat_aiguillage, qui ne reflète que les commandes
+ * déjà appliquées.
+ */
+class SwitchPipeline
+{
+public:
+    using Switches = std::vector<std::pair<int, int>>;
+
+    /**
+     * @brief Number of steps whose switches are prepared ahead of the current one.
+     */
+    static const long LOOK_AHEAD = 2;
+
+    /**
+     * @brief SwitchPipeline Constructeur du pipeline, lance son thread.
+     * @param loco La locomotive dont le parcours est préparé
+     */
+    SwitchPipeline(Locomotive& loco);
+
+    /**
+     * @brief ~SwitchPipeline Termine les commandes en cours et arrête le thread.
+     */
+    ~SwitchPipeline();
+
+    /**
+     * @brief prepare Prépare les aiguillages d'une étape à venir. Les étapes doivent être
+     * préparées dans l'ordre.
+     * @param step Le numéro de l'étape
+     * @param switches Les aiguillages et leur direction
+     * @return false, sans rien préparer, si un aiguillage doit prendre une autre direction
+     * pour une étape précédente que la locomotive n'a pas encore quittée
+     */
+    bool prepare(long step, const Switches& switches);
+
+    /**
+     * @brief reach Méthode à appeler lorsque la locomotive franchit le contact de l'étape.
+     * Ne bloque jamais : si les aiguillages de l'étape ne sont pas encore dirigés, la
+     * locomotive est ralentie et retrouve sa vitesse dès qu'ils le sont.
+     * @param step Le numéro de l'étape
+     * @param switches Les aiguillages de l'étape, envoyés maintenant s'ils n'ont pas été préparés
+     * @return true si les aiguillages étaient dirigés à temps
+     */
+    bool reach(long step, const Switches& switches);
+
+    /**
+     * @brief hold Méthode à appeler avant une opération pouvant arrêter la locomotive :
+     * le pipeline ne lui rend plus sa vitesse jusqu'à l'appel de resume.
+     */
+    void hold();
+
+    /**
+     * @brief resume Fin de l'opération pouvant arrêter la locomotive. Si elle a été ralentie
+     * et que les aiguillages sont dirigés, sa vitesse lui est rendue.
+     */
+    void resume();
+
+    /**
+     * @brief report Retourne les statistiques du pipeline : commandes envoyées, commandes
+     * évitées et nombre d'étapes atteintes avant que leurs aiguillages soient dirigés.
+     * Les commandes envoyées et évitées sont des estimations (voir la description de la classe).
+     */
+    QString report();
+
+private:
+    /**
+     * @brief A batch of switch commands, for one step.
+     */
+    struct Batch {
+        unsigned long id;
+        Switches switches;
+    };
+
+    Locomotive& loco;
+
+    PcoSemaphore mutex;
+
+    /**
+     * Released once per batch queued, and once more to stop the thread.
+     */
+    PcoSemaphore pending;
+
+    std::deque<Batch> queue;
+
+    /**
+     * Batches prepared for the steps not yet left by the loco, by step. Only used by the loco thread.
+     */
+    std::map<long, Batch> window;
+
+    unsigned long nextBatch;
+
+    /**
+     * All batches up to this one have been carried out.
+     */
+    unsigned long doneBatch;
+
+    /**
+     * The loco runs slowly until this batch is carried out, 0 if it runs normally.
+     */
+    unsigned long slowedUntil;
+
+    int normalSpeed;
+
+    bool held;
+
+    unsigned long nbSent;
+    unsigned long nbCoalesced;
+    unsigned long nbReached;
+    unsigned long nbLate;
+
+    std::unique_ptr<PcoThread> thread;
+
+    /**
+     * @brief submit Queue a batch for the thread.
+     * @return The id of the batch
+     */
+    unsigned long submit(const Switches& switches);
+
+    /**
+     * @brief restoreSpeed Give the loco back its speed if it was slowed down and its
+     * switches are now set. The mutex must be held.
+     */
+    void restoreSpeed();
+
+    /**
+     * @brief run Function of the thread: carries out the batches in order.
+     */
+    void run();
+};
+
+#endif // SWITCHPIPELINE_H
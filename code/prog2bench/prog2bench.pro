@@ -0,0 +1,37 @@
+#message("Building the prog2 benchmark")
+
+# Headless benchmark of the prog2 reservation classes: the simulator is replaced by
+# src/benchtrack.cpp, so only QtCore and pcosynchro are needed.
+QT -= gui
+QT += core
+
+TARGET = prog2bench
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+LIBS += -lpcosynchro
+
+INCLUDEPATH += \
+    ../prog2/src \
+    ../../QtrainSim/src
+
+HEADERS +=  \
+    ../prog2/src/locomotive.h \
+    ../prog2/src/launchable.h \
+    ../prog2/src/sharedsectioninterface.h \
+    ../prog2/src/locomotivebehavior.h \
+    ../prog2/src/sectionmanager.h \
+    ../prog2/src/routeplanner.h \
+    ../prog2/src/plannedlocomotivebehavior.h \
+    ../prog2/src/switchpipeline.h \
+    src/benchtrack.h
+
+SOURCES +=  \
+    ../prog2/src/locomotive.cpp \
+    ../prog2/src/locomotivebehavior.cpp \
+    ../prog2/src/routeplanner.cpp \
+    ../prog2/src/plannedlocomotivebehavior.cpp \
+    ../prog2/src/switchpipeline.cpp \
+    src/benchtrack.cpp \
+    src/benchmain.cpp
@@ -0,0 +1,170 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+#include "benchtrack.h"
+#include "locomotive.h"
+#include "locomotivebehavior.h"
+#include "plannedlocomotivebehavior.h"
+#include "routeplanner.h"
+#include "sectionmanager.h"
+
+// Usage : prog2bench [scénario [nombre de locos [durée en secondes]]]
+// Scénarios : sections (SectionManager) ou planner (RoutePlanner).
+// Sans nombre de locos, le scénario est mesuré pour 2, 8 et 32 locos, chacune dans un
+// processus séparé : les threads des locos ne s'arrêtent jamais.
+
+static const int NB_LOCOS[] = {2, 8, 32};
+
+static const int DEFAULT_DURATION = 10;
+
+//! Nombre de locos par section partagée, à partir de 8 locos.
+static const int LOCOS_PER_SECTION = 4;
+
+/**
+ * @brief Affiche le débit mesuré pendant duration secondes : contacts franchis et
+ * tours-locomotives par minute.
+ */
+static void printThroughput(const char* scenario, int nbLocos, int nbSections, int lapLength, int duration, unsigned long long contacts)
+{
+    double minutes = duration / 60.0;
+    double laps = double(contacts) / lapLength;
+
+    printf("%-9s %3d locos %3d sections : %8llu contacts, %8.1f engine-laps per minute\n",
+           scenario, nbLocos, nbSections, contacts, laps / minutes);
+    fflush(stdout);
+}
+
+/**
+ * @brief Scénario sections : chaque loco parcourt en boucle trois blocs privés et deux blocs
+ * d'une section partagée d'un SectionManager. Les 2 premières locos se partagent une
+ * section, puis chaque section est partagée par LOCOS_PER_SECTION locos.
+ */
+static void runSections(int nbLocos, int duration)
+{
+    int nbSections = std::max(1, nbLocos / LOCOS_PER_SECTION);
+    auto manager = std::make_shared<SectionManager>(nbSections);
+
+    // Contacts 1 to 2 * nbSections belong to the sections, the others are private.
+    std::vector<std::unique_ptr<Locomotive>> locos;
+    std::vector<std::unique_ptr<Launchable>> behaviors;
+    int lapLength = 0;
+    for (int i = 0; i < nbLocos; ++i) {
+        int section = i % nbSections;
+        int privateContact = 100 + 3 * i;
+
+        std::vector<Section> travel = {
+            {privateContact, {}, false},
+            {privateContact + 1, {}, false},
+            {1 + 2 * section, {}, true},
+            {2 + 2 * section, {}, true},
+            {privateContact + 2, {}, false},
+        };
+        lapLength = travel.size();
+
+        locos.push_back(std::make_unique<Locomotive>(i, 10));
+        behaviors.push_back(std::make_unique<LocomotiveBehavior>(*locos.back(), std::make_shared<ManagedSharedSection>(manager, section),
+                                                                 travel, SharedSectionInterface::LocoId::LA));
+    }
+
+    unsigned long long before = bench_contacts();
+    for (auto& behavior : behaviors) {
+        behavior->startThread();
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(duration));
+
+    printThroughput("sections", nbLocos, nbSections, lapLength, duration, bench_contacts() - before);
+
+    // The loco threads never end: leave without joining them.
+    std::_Exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Scénario planner : mêmes parcours que le scénario sections, mais les voies sont
+ * réservées par un RoutePlanner, qui en déduit lui-même les blocs partagés. Le débit est
+ * celui de RoutePlanner::report.
+ */
+static void runPlanner(int nbLocos, int duration)
+{
+    int nbSections = std::max(1, nbLocos / LOCOS_PER_SECTION);
+    auto planner = std::make_shared<RoutePlanner>();
+
+    std::vector<std::unique_ptr<Locomotive>> locos;
+    std::vector<std::unique_ptr<Launchable>> behaviors;
+    for (int i = 0; i < nbLocos; ++i) {
+        int section = i % nbSections;
+        int privateContact = 100 + 3 * i;
+
+        std::vector<Section> travel = {
+            {privateContact, {}, false},
+            {privateContact + 1, {}, false},
+            {1 + 2 * section, {}, false},
+            {2 + 2 * section, {}, false},
+            {privateContact + 2, {}, false},
+        };
+
+        locos.push_back(std::make_unique<Locomotive>(i, 10));
+        behaviors.push_back(std::make_unique<PlannedLocomotiveBehavior>(*locos.back(), planner, travel));
+    }
+
+    if (!planner->plan()) {
+        fprintf(stderr, "planner: no plan for %d locos\n", nbLocos);
+        std::_Exit(EXIT_FAILURE);
+    }
+
+    for (auto& behavior : behaviors) {
+        behavior->startThread();
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(duration));
+
+    printf("planner   %3d locos %3d sections :\n%s\n", nbLocos, nbSections, qPrintable(planner->report()));
+    fflush(stdout);
+
+    // The loco threads never end: leave without joining them.
+    std::_Exit(EXIT_SUCCESS);
+}
+
+int main(int argc, char* argv[])
+{
+    QString scenario = argc > 1 ? argv[1] : "sections";
+    int duration = argc > 3 ? atoi(argv[3]) : DEFAULT_DURATION;
+
+    if ((scenario != "sections" && scenario != "planner") || duration <= 0) {
+        fprintf(stderr, "Usage: %s [sections|planner [locos [seconds]]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (argc > 2) {
+        int nbLocos = atoi(argv[2]);
+        if (nbLocos <= 0) {
+            fprintf(stderr, "Usage: %s [sections|planner [locos [seconds]]]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (scenario == "sections") {
+            runSections(nbLocos, duration);
+        } else {
+            runPlanner(nbLocos, duration);
+        }
+    }
+
+    // One process per number of locos.
+    for (int nbLocos : NB_LOCOS) {
+        QProcess::execute(argv[0], QStringList() << scenario << QString::number(nbLocos) << QString::number(duration));
+    }
+
+    return EXIT_SUCCESS;
+}
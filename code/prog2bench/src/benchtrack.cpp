@@ -0,0 +1,74 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "ctrain_handler.h"
+#include "benchtrack.h"
+
+static std::atomic<unsigned long long> nbContacts(0);
+
+unsigned long long bench_contacts()
+{
+    return nbContacts.load();
+}
+
+void attendre_contact(int)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(BLOCK_TIME_MS));
+    ++nbContacts;
+}
+
+int voies_segment(int, int, int*, int)
+{
+    return -1;
+}
+
+void diriger_aiguillage(int, int, int)
+{
+}
+
+int etat_aiguillage(int, unsigned long long *version)
+{
+    if (version != nullptr) {
+        *version = 0;
+    }
+    return DIRECTION_INCONNUE;
+}
+
+void journaliser_section(int, int, int, int)
+{
+}
+
+void arreter_loco(int)
+{
+}
+
+void mettre_vitesse_progressive(int, int)
+{
+}
+
+void mettre_fonction_loco(int, char)
+{
+}
+
+void inverser_sens_loco(int)
+{
+}
+
+void assigner_loco(int, int, int, int)
+{
+}
+
+void afficher_message(const char*)
+{
+}
+
+void afficher_message_loco(int, const char*)
+{
+}
@@ -0,0 +1,29 @@
+//    ___  _________    ___  ___  ___   __ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  | / / //
+//  / ___/ /__/ /_/ / / __// // / __/ / /  //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+#ifndef BENCHTRACK_H
+#define BENCHTRACK_H
+
+/**
+ * Maquette virtuelle du benchmark : benchtrack.cpp implémente les fonctions de
+ * ctrain_handler.h utilisées par les classes de prog2, sans simulateur.
+ *
+ * Une locomotive met BLOCK_TIME_MS à parcourir le bloc précédant chaque contact :
+ * attendre_contact dort ce temps puis compte le contact franchi. Les aiguillages, les
+ * vitesses et les messages sont ignorés, et la topologie est inconnue (voies_segment
+ * échoue) : seuls les contacts communs à plusieurs parcours les font se croiser.
+ */
+
+//! Temps de parcours d'un bloc, en millisecondes.
+#define BLOCK_TIME_MS 5
+
+/**
+ * @brief bench_contacts Retourne le nombre de contacts franchis par toutes les locomotives
+ * depuis le lancement du programme.
+ */
+unsigned long long bench_contacts();
+
+#endif // BENCHTRACK_H
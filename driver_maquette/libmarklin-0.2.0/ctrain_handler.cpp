@@ -37,21 +37,80 @@
  *                    - Cette fonction permet d'activer les bobines qui bougent
  *                      les aiguillages. Le paramètre temps_alim indique le
  *                      temps qu'il faut à la bobine pour bouger l'aiguillage.
+ *                      La dernière direction commandée de chaque aiguillage
+ *                      est mémorisée : une commande vers cette direction
+ *                      n'est pas transmise, ce qui épargne les paquets USB et
+ *                      l'attente de temps_alim des commandes répétées à
+ *                      chaque tour.
+ *
+ *                    int etat_aiguillage(int no_aiguillage,
+ *                                        unsigned long long *version);
+ *                    - Retourne la dernière direction commandée, et le nombre
+ *                      de ses changements. Elle est inconnue à la mise en
+ *                      service : la première commande est toujours transmise.
  *
  *                    Ces fonctions permettent de lire les contacts :
- *                    void* lire_contacts(void *arg);
+ *                    void contacts_lus(const uint8_t *etats, void *arg);
  *                    void attendre_contact(int no_contact);
- *                    - La première fonction lit périodiquement la valeur des
- *                      contacts grâce à la commande bas niveau read_contact.
- *                      Cette commande permet de lire l'états de tous les
- *                      contacts.
+ *                    - La première fonction reçoit l'état de tous les
+ *                      contacts, lu en continu par l'acquisition asynchrone
+ *                      de libredsusb. Elle détecte les fronts montants et
+ *                      réveille uniquement les threads attendant l'un des
+ *                      contacts activés. La seconde attend la prochaine
+ *                      activation (front montant) du contact.
+ *
+ *                    unsigned long long sequence_contact(int no_contact);
+ *                    unsigned long long attendre_contact_apres(int no_contact,
+ *                                           unsigned long long sequence);
+ *                    unsigned long long attendre_contact_loco(int no_contact,
+ *                                           int no_loco,
+ *                                           unsigned long long sequence);
+ *                    - Chaque front montant d'un contact incrémente son numéro
+ *                      de séquence. Ces fonctions attendent une activation
+ *                      postérieure à une séquence donnée. La loco ayant activé
+ *                      un contact n'étant pas connue, attendre_contact_loco
+ *                      accepte toute activation.
+ *
+ *                    int attendre_contacts(const int *liste, int n,
+ *                                          int timeout_ms, int *which);
+ *                    - Attend la prochaine activation de l'un des contacts de
+ *                      la liste, sur la même condition que les autres
+ *                      attentes, avec un délai maximal optionnel.
+ *                      Une liste vide ou nulle retourne 0 sans attendre.
+ *
+ *                    int voies_segment(int contact_a, int contact_b,
+ *                                      int *voies, int taille);
+ *                    - La topologie de la maquette réelle n'étant pas connue
+ *                      du pilote, retourne toujours -1.
+ *
+ *                    int calculer_itineraire(const int *etapes, int n);
+ *                    int contacts_itineraire(int itineraire, int *contacts,
+ *                                            int taille);
+ *                    int aiguillages_itineraire(int itineraire, int indice,
+ *                                               int *aiguillages,
+ *                                               int *directions, int taille);
+ *                    - Pour la même raison, retournent toujours -1.
+ *
+ *                    void afficher_statistiques_contacts(void);
+ *                    - Affiche, pour chaque contact, les latences entre le
+ *                      front montant (réception par contacts_lus) et le retour
+ *                      du thread qui l'attendait. Elles sont enregistrées sans
+ *                      verrou dans un histogramme par contact et écrites dans
+ *                      le fichier MAQTRAIN_FICHIER_LATENCES par
+ *                      mettre_maquette_hors_service().
+ *
+ *                    void journaliser_section(int no_loco, int no_section,
+ *                                             int evenement, int entree);
+ *                    - Le journal des événements est propre au simulateur :
+ *                      cette fonction ne fait rien.
  *
  *                    Ces fonctions gèrent l'initialisation / la fin du
  *                    programme :
  *                    void init_maquette(void);
  *                    - Cette fonction doit être appelée au début du programme
  *                      client. Elle s'occupe d'initialiser la communication
- *                      USB avec la maquette. Cette fonction se termine par
+ *                      USB avec la maquette, qui reste ouverte jusqu'à
+ *                      mettre_maquette_hors_service(). Cette fonction se termine par
  *                      l'exécution de la commande "GO" qui donne le feu
  *                      vert aux les locos.
  *
@@ -87,6 +146,10 @@
 #include "string.h"
 #include "pthread.h"
 #include "unistd.h"
+#include "time.h"
+#include "errno.h"
+
+#include <atomic>
 
 #define MAQTRAIN_VENDOR_ID 0xee08
 #define MAQTRAIN_PRODUCT_ID 0x0540
@@ -101,11 +164,14 @@
 #define MAQTRAIN_VITESSE_MIN 1
 #define MAQTRAIN_VITESSE_MAX 14
 
-#define MAQTRAIN_RAFRAICHISSEMENT_CONTACTS 300
-
 #define MAQTRAIN_PREMIERE_ADRESSE_CONTACTS 1
 #define MAQTRAIN_DERNIERE_ADRESSE_CONTACTS MAQTRAIN_NB_SENSORS
 
+/* Classes de l'histogramme des latences : < 1 us, puis [2^(k-1), 2^k[ us,
+   la dernière classe recevant tout ce qui dépasse */
+#define MAQTRAIN_NB_CLASSES_LATENCES 24
+#define MAQTRAIN_FICHIER_LATENCES "latences_contacts.json"
+
 #define MAQTRAIN_TEST_AIGUILLAGES_INPUT(no_aiguillage) \
 if(no_aiguillage < MAQTRAIN_PREMIERE_ADRESSE_AIGUILLAGES || \
    no_aiguillage > MAQTRAIN_DERNIERE_ADRESSE_AIGUILLAGES) \
@@ -129,53 +195,259 @@ if(vitesse_future < MAQTRAIN_VITESSE_MIN || \
 static int maquette_en_service = 0;
 
 static uint8_t contacts[MAQTRAIN_NB_SENSORS];
+static unsigned long long sequences[MAQTRAIN_NB_SENSORS];
 
-static pthread_t lecteur_contact;
 static pthread_mutex_t mutex_contact = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t condition_contact  = PTHREAD_COND_INITIALIZER;
 
 static int vitesse_locos[MAQTRAIN_NB_LOCOS];
 
 /*
- * Thread qui à la charge de rafraichir l'état des contacts (actif/inactif).
- * Les contacts sont activés lorsqu'un locomotive passe dessus.
- *
- * Le taux de rafraichissement est définie par : MAQTRAIN_RAFRAICHISSEMENT_CONTACTS.
- * en usec.
- *
- * Le Thread est lancé par la fonction init_maquette() et terminé par la fonction
- * mettre_maquette_hors_service().
- *
- * La fonction qui lit les contacts est attendre_contact(no_contact).
- *
+ * Direction commandée de chaque aiguillage, plus un (0 si elle est inconnue), et
+ * nombre de ses changements. Le mutex est tenu pendant la commande : deux commandes
+ * simultanées d'un même aiguillage sont transmises dans l'ordre de la table.
+ */
+static int directions_aiguillages[MAQTRAIN_DERNIERE_ADRESSE_AIGUILLAGES + 1];
+static unsigned long long versions_aiguillages[MAQTRAIN_DERNIERE_ADRESSE_AIGUILLAGES + 1];
+
+static pthread_mutex_t mutex_aiguillages = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Latences de réveil d'un contact. Les compteurs sont atomiques : ils sont mis
+ * à jour sans verrou et peuvent être lus à tout moment.
+ */
+typedef struct {
+    std::atomic<unsigned long long> classes[MAQTRAIN_NB_CLASSES_LATENCES];
+    std::atomic<unsigned long long> reveils;     /* réveils après blocage */
+    std::atomic<unsigned long long> immediats;   /* attentes satisfaites sans bloquer */
+    std::atomic<unsigned long long> somme_ns;
+    std::atomic<unsigned long long> max_ns;
+} latences_t;
+
+static latences_t latences[MAQTRAIN_NB_SENSORS];
+
+/*
+ * Thread en attente de l'activation d'un ou plusieurs contacts.
+ * Chaque thread dispose de sa propre condition : seuls les threads dont l'un
+ * des contacts a été activé sont réveillés.
+ */
+typedef struct attente {
+    const int *liste;                                /* contacts surveillés */
+    int n;                                           /* nombre de contacts surveillés */
+    unsigned long long apres[MAQTRAIN_NB_SENSORS];   /* séquence à dépasser, par contact */
+    int active;                                      /* contact activé, 0 tant qu'aucun */
+    unsigned long long instant_activation;           /* instant du front ayant satisfait l'attente */
+    pthread_cond_t condition;
+    struct attente *suivante;
+} attente_t;
+
+static attente_t *attentes = NULL;
+
+/*
+ * Retourne l'instant présent en nanosecondes, selon l'horloge monotone.
  */
-void* lire_contacts(void* /* arg */) {
+static unsigned long long maintenant_ns(void) {
 
-    uint8_t cache[MAQTRAIN_NB_SENSORS];
-    memset(cache, 0, sizeof(uint8_t) * MAQTRAIN_NB_SENSORS);
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ULL + (unsigned long long)t.tv_nsec;
+}
 
-    while(maquette_en_service) {
+/*
+ * Enregistre la latence de réveil d'un thread attendant le contact donné.
+ */
+static void enregistrer_latence(int no_contact, unsigned long long latence_ns) {
 
-        pthread_mutex_lock(&mutex_contact);
+    latences_t *l = &latences[no_contact-1];
 
-        memcpy (cache, contacts, sizeof(uint8_t)*MAQTRAIN_NB_SENSORS);
+    /* Classe : nombre de bits de la latence en microsecondes */
+    unsigned long long us = latence_ns / 1000;
+    int classe = 0;
+    while(us != 0 && classe < MAQTRAIN_NB_CLASSES_LATENCES - 1) {
+        us >>= 1;
+        classe++;
+    }
+
+    l->classes[classe].fetch_add(1, std::memory_order_relaxed);
+    l->reveils.fetch_add(1, std::memory_order_relaxed);
+    l->somme_ns.fetch_add(latence_ns, std::memory_order_relaxed);
+
+    unsigned long long max = l->max_ns.load(std::memory_order_relaxed);
+    while(latence_ns > max &&
+          !l->max_ns.compare_exchange_weak(max, latence_ns, std::memory_order_relaxed))
+        ;
+}
+
+/*
+ * Retourne la borne supérieure en microsecondes de la classe contenant le
+ * quantile q des latences du contact, -1 si elle n'est pas bornée.
+ */
+static long long quantile_latence_us(const latences_t *l, double q) {
+
+    unsigned long long valeurs[MAQTRAIN_NB_CLASSES_LATENCES];
+    unsigned long long total = 0;
+
+    for(int k = 0; k < MAQTRAIN_NB_CLASSES_LATENCES; k++) {
+        valeurs[k] = l->classes[k].load(std::memory_order_relaxed);
+        total += valeurs[k];
+    }
 
-        if(maqtrain_read_sensors(contacts) < 0) {
-            pthread_exit(NULL);
+    unsigned long long cumul = 0;
+    for(int k = 0; k < MAQTRAIN_NB_CLASSES_LATENCES - 1; k++) {
+        cumul += valeurs[k];
+        if(total != 0 && valeurs[k] != 0 && cumul >= q * total)
+            return 1LL << k;
+    }
+    return (total == 0) ? 0 : -1;
+}
+
+/*
+ * Ecrit les latences de réveil de tous les contacts attendus au format JSON,
+ * identique à celui du simulateur.
+ */
+static void ecrire_latences(const char *nom_fichier) {
+
+    FILE *f = fopen(nom_fichier, "w");
+    if(f == NULL) {
+        fprintf(stderr, "Impossible d'écrire le fichier %s\n", nom_fichier);
+        return;
+    }
+
+    fprintf(f, "{\n    \"source\": \"maquette\",\n    \"bornes_classes_us\": [");
+    for(int k = 0; k < MAQTRAIN_NB_CLASSES_LATENCES; k++)
+        fprintf(f, "%s%lld", k ? ", " : "", (k < MAQTRAIN_NB_CLASSES_LATENCES - 1) ? (1LL << k) : -1LL);
+    fprintf(f, "],\n    \"contacts\": [");
+
+    int premier = 1;
+    for(int i = 0; i < MAQTRAIN_NB_SENSORS; i++) {
+        const latences_t *l = &latences[i];
+        unsigned long long reveils = l->reveils.load(std::memory_order_relaxed);
+        unsigned long long immediats = l->immediats.load(std::memory_order_relaxed);
+        if(reveils == 0 && immediats == 0)
+            continue;
+
+        fprintf(f, "%s\n        {\"contact\": %d, \"reveils\": %llu, \"immediats\": %llu, "
+                   "\"moyenne_ns\": %llu, \"max_ns\": %llu, \"classes\": [",
+                premier ? "" : ",", i + 1, reveils, immediats,
+                reveils ? l->somme_ns.load(std::memory_order_relaxed) / reveils : 0ULL,
+                l->max_ns.load(std::memory_order_relaxed));
+        for(int k = 0; k < MAQTRAIN_NB_CLASSES_LATENCES; k++)
+            fprintf(f, "%s%llu", k ? ", " : "", l->classes[k].load(std::memory_order_relaxed));
+        fprintf(f, "]}");
+        premier = 0;
+    }
+
+    fprintf(f, "\n    ]\n}\n");
+    fclose(f);
+}
+
+/*
+ * Retourne le premier contact surveillé par l'attente dont la séquence a
+ * dépassé la séquence de départ, 0 s'il n'y en a pas.
+ * Doit être appelée avec mutex_contact verrouillé.
+ */
+static int evaluer_attente(const attente_t *a) {
+
+    for(int i = 0; i < a->n; i++) {
+        if(sequences[a->liste[i]-1] > a->apres[a->liste[i]-1])
+            return a->liste[i];
+    }
+    return 0;
+}
+
+/*
+ * Bloque jusqu'à ce que l'attente soit satisfaite ou que le délai expire
+ * (timeout_ms négatif : attente illimitée).
+ * Doit être appelée avec mutex_contact verrouillé.
+ * Retourne le contact activé, 0 si le délai a expiré.
+ */
+static int bloquer(attente_t *a, int timeout_ms) {
+
+    struct timespec echeance;
+
+    a->active = evaluer_attente(a);
+    if(a->active != 0)
+        latences[a->active-1].immediats.fetch_add(1, std::memory_order_relaxed);
+    if(a->active != 0 || timeout_ms == 0)
+        return a->active;
+
+    a->instant_activation = 0;
+
+    if(timeout_ms > 0) {
+        clock_gettime(CLOCK_REALTIME, &echeance);
+        echeance.tv_sec += timeout_ms / 1000;
+        echeance.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if(echeance.tv_nsec >= 1000000000L) {
+            echeance.tv_sec++;
+            echeance.tv_nsec -= 1000000000L;
         }
+    }
 
-        /* Une locomotive a activé un contact */
-        if(memcmp (contacts, cache, sizeof(uint8_t)*MAQTRAIN_NB_SENSORS) != 0) {
-            pthread_cond_broadcast(&condition_contact);
+    pthread_cond_init(&a->condition, NULL);
+    a->suivante = attentes;
+    attentes = a;
+
+    while(a->active == 0) {
+        if(timeout_ms < 0) {
+            pthread_cond_wait(&a->condition, &mutex_contact);
+        }
+        else if(pthread_cond_timedwait(&a->condition, &mutex_contact, &echeance) == ETIMEDOUT) {
+            a->active = evaluer_attente(a);
+            break;
         }
+    }
+
+    attente_t **p = &attentes;
+    while(*p != a)
+        p = &(*p)->suivante;
+    *p = a->suivante;
+    pthread_cond_destroy(&a->condition);
+
+    if(a->active != 0 && a->instant_activation != 0)
+        enregistrer_latence(a->active, maintenant_ns() - a->instant_activation);
+
+    return a->active;
+}
 
-        pthread_mutex_unlock(&mutex_contact);
+/*
+ * Reçoit l'état de tous les contacts, lu par l'acquisition asynchrone de
+ * libredsusb (appelée depuis son thread de boucle d'événements).
+ *
+ * Chaque front montant d'un contact incrémente sa séquence. Seuls les
+ * threads attendant l'un des contacts activés sont réveillés.
+ *
+ * L'acquisition est lancée par la fonction init_maquette() et arrêtée par la
+ * fonction mettre_maquette_hors_service().
+ */
+static void contacts_lus(const uint8_t *etats, void* /* arg */) {
 
-        usleep(MAQTRAIN_RAFRAICHISSEMENT_CONTACTS);
+    int front = 0;
+
+    /* Instant d'activation, relevé avant le mutex : son attente fait partie de la latence */
+    unsigned long long instant = maintenant_ns();
+
+    pthread_mutex_lock(&mutex_contact);
+
+    for(int i = 0; i < MAQTRAIN_NB_SENSORS; i++) {
+        if(contacts[i] == 0 && etats[i] == 1) {
+            sequences[i]++;
+            front = 1;
+        }
+        contacts[i] = etats[i];
     }
 
-    // avoid warning on non-void return
-    pthread_exit(NULL);
+    if(front) {
+        for(attente_t *a = attentes; a != NULL; a = a->suivante) {
+            if(a->active != 0)
+                continue;
+            a->active = evaluer_attente(a);
+            if(a->active != 0) {
+                a->instant_activation = instant;
+                pthread_cond_signal(&a->condition);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_contact);
 }
 
 void init_maquette(void) {
@@ -184,17 +456,27 @@ void init_maquette(void) {
 
         usb_set_device(MAQTRAIN_VENDOR_ID, MAQTRAIN_PRODUCT_ID);
 
-        maquette_en_service = 1;
-
-        if (pthread_mutex_init(&mutex_contact, NULL) != 0) {
+        /* Ouvre la maquette une fois pour toute la session */
+        if (usb_session_open() < 0) {
             return;
         }
 
+        maquette_en_service = 1;
+
         memset(contacts, 0, sizeof(uint8_t) * MAQTRAIN_NB_SENSORS);
+        memset(sequences, 0, sizeof(unsigned long long) * MAQTRAIN_NB_SENSORS);
         memset(vitesse_locos, 0, sizeof(int) * MAQTRAIN_NB_LOCOS);
 
-        /* Initialise le thread de lecture des contacts */
-        if (pthread_create(&lecteur_contact, NULL, &lire_contacts, NULL) < 0) {
+        /* La position des aiguillages n'est pas connue à la mise en service */
+        pthread_mutex_lock(&mutex_aiguillages);
+        memset(directions_aiguillages, 0, sizeof(directions_aiguillages));
+        pthread_mutex_unlock(&mutex_aiguillages);
+
+        /* Lance l'acquisition asynchrone des contacts */
+        if (maqtrain_sensors_start(&contacts_lus, NULL) < 0) {
+            /* Sans contacts, la maquette n'est pas utilisable : referme la session */
+            maquette_en_service = 0;
+            usb_session_close();
             return;
         }
 
@@ -214,10 +496,11 @@ void mettre_maquette_hors_service(void) {
         uint8_t data = 0x61;
         maqtrain_send_command(0, data);
 
-        pthread_join(lecteur_contact, NULL);
-        pthread_mutex_destroy(&mutex_contact);
+        maqtrain_sensors_stop();
+
+        usb_session_close();
 
-        //ev. close MaqTrain connection if needed (not the case yet)
+        ecrire_latences(MAQTRAIN_FICHIER_LATENCES);
     }
 }
 
@@ -238,6 +521,14 @@ void diriger_aiguillage(int no_aiguillage, int direction, int temps_alim) {
     if(temps_alim < 0)
         return;
 
+    pthread_mutex_lock(&mutex_aiguillages);
+
+    /* L'aiguillage est déjà dans la direction demandée */
+    if(directions_aiguillages[no_aiguillage] == direction + 1) {
+        pthread_mutex_unlock(&mutex_aiguillages);
+        return;
+    }
+
     /* Commande qui active la bobine qui bouge l'aiguillage */
     uint8_t data = 0x20;
     data |= (1 << !direction);
@@ -249,19 +540,153 @@ void diriger_aiguillage(int no_aiguillage, int direction, int temps_alim) {
     /* Commande d'arrêt de la bobine qui bouge l'aiguillage */
     data = 0x20;
     maqtrain_send_command(0, data);
+
+    directions_aiguillages[no_aiguillage] = direction + 1;
+    versions_aiguillages[no_aiguillage]++;
+
+    pthread_mutex_unlock(&mutex_aiguillages);
+}
+
+int etat_aiguillage(int no_aiguillage, unsigned long long *version) {
+
+    if(no_aiguillage < MAQTRAIN_PREMIERE_ADRESSE_AIGUILLAGES ||
+       no_aiguillage > MAQTRAIN_DERNIERE_ADRESSE_AIGUILLAGES) {
+        if(version != NULL)
+            *version = 0;
+        return DIRECTION_INCONNUE;
+    }
+
+    pthread_mutex_lock(&mutex_aiguillages);
+    int direction = directions_aiguillages[no_aiguillage] - 1;
+    if(version != NULL)
+        *version = versions_aiguillages[no_aiguillage];
+    pthread_mutex_unlock(&mutex_aiguillages);
+
+    return direction < 0 ? DIRECTION_INCONNUE : direction;
 }
 
 void attendre_contact(int no_contact) {
 
     MAQTRAIN_TEST_CONTACTS_INPUT(no_contact)
 
+    attendre_contact_apres(no_contact, sequence_contact(no_contact));
+}
+
+unsigned long long sequence_contact(int no_contact) {
+
+    if(no_contact < MAQTRAIN_PREMIERE_ADRESSE_CONTACTS ||
+       no_contact > MAQTRAIN_DERNIERE_ADRESSE_CONTACTS)
+        return 0;
+
+    pthread_mutex_lock(&mutex_contact);
+    unsigned long long sequence = sequences[no_contact-1];
+    pthread_mutex_unlock(&mutex_contact);
+
+    return sequence;
+}
+
+unsigned long long attendre_contact_apres(int no_contact, unsigned long long sequence) {
+
+    if(no_contact < MAQTRAIN_PREMIERE_ADRESSE_CONTACTS ||
+       no_contact > MAQTRAIN_DERNIERE_ADRESSE_CONTACTS)
+        return sequence;
+
+    attente_t a;
+    a.liste = &no_contact;
+    a.n = 1;
+    a.apres[no_contact-1] = sequence;
+
     pthread_mutex_lock(&mutex_contact);
+    bloquer(&a, -1);
+    sequence = sequences[no_contact-1];
+    pthread_mutex_unlock(&mutex_contact);
+
+    return sequence;
+}
+
+unsigned long long attendre_contact_loco(int no_contact, int /* no_loco */, unsigned long long sequence) {
+
+    /* La maquette ne permet pas d'identifier la loco passant sur un contact */
+    return attendre_contact_apres(no_contact, sequence);
+}
+
+int attendre_contacts(const int *liste, int n, int timeout_ms, int *which) {
+
+    /* Sans contact surveille, l'attente ne pourrait jamais etre satisfaite */
+    if(liste == NULL || n <= 0)
+        return 0;
 
-    while(contacts[no_contact-1] != 1) {
-        pthread_cond_wait(&condition_contact, &mutex_contact);
+    for(int i = 0; i < n; i++) {
+        if(liste[i] < MAQTRAIN_PREMIERE_ADRESSE_CONTACTS ||
+           liste[i] > MAQTRAIN_DERNIERE_ADRESSE_CONTACTS)
+            return 0;
     }
 
+    attente_t a;
+    a.liste = liste;
+    a.n = n;
+
+    pthread_mutex_lock(&mutex_contact);
+
+    /* Les séquences de départ sont relevées sous le mutex */
+    memcpy(a.apres, sequences, sizeof(unsigned long long) * MAQTRAIN_NB_SENSORS);
+
+    int active = bloquer(&a, timeout_ms);
+
     pthread_mutex_unlock(&mutex_contact);
+
+    if(active != 0 && which != NULL)
+        *which = active;
+
+    return active != 0;
+}
+
+int voies_segment(int /*contact_a*/, int /*contact_b*/, int * /*voies*/, int /*taille*/) {
+
+    return -1;
+}
+
+int calculer_itineraire(const int * /*etapes*/, int /*n*/) {
+
+    return -1;
+}
+
+int contacts_itineraire(int /*itineraire*/, int * /*contacts*/, int /*taille*/) {
+
+    return -1;
+}
+
+int aiguillages_itineraire(int /*itineraire*/, int /*indice*/, int * /*aiguillages*/, int * /*directions*/, int /*taille*/) {
+
+    return -1;
+}
+
+void afficher_statistiques_contacts(void) {
+
+    printf("Latences de réveil des contacts (us) :\n"
+           "contact  réveils  immédiats  moyenne  p50  p99  max\n");
+
+    int vide = 1;
+    for(int i = 0; i < MAQTRAIN_NB_SENSORS; i++) {
+        const latences_t *l = &latences[i];
+        unsigned long long reveils = l->reveils.load(std::memory_order_relaxed);
+        unsigned long long immediats = l->immediats.load(std::memory_order_relaxed);
+        if(reveils == 0 && immediats == 0)
+            continue;
+        vide = 0;
+
+        printf("%7d  %7llu  %9llu  %7llu  %3lld  %3lld  %llu\n",
+               i + 1, reveils, immediats,
+               reveils ? l->somme_ns.load(std::memory_order_relaxed) / reveils / 1000 : 0ULL,
+               quantile_latence_us(l, 0.5), quantile_latence_us(l, 0.99),
+               l->max_ns.load(std::memory_order_relaxed) / 1000);
+    }
+
+    if(vide)
+        printf("(aucune attente de contact)\n");
+}
+
+void journaliser_section(int /*no_loco*/, int /*no_section*/, int /*evenement*/, int /*entree*/) {
 }
 
 void arreter_loco(int no_loco) {
@@ -310,11 +735,14 @@ void inverser_sens_loco(int no_loco) {
 
     MAQTRAIN_TEST_ADRESSES_LOCOS_INPUT(no_loco)
 
-    /* Commande qui inverse le sens de la loco */
-    uint8_t data = 15;
-    maqtrain_send_command((uint8_t)no_loco, 0);
-    maqtrain_send_command((uint8_t)no_loco, data);
-    maqtrain_send_command((uint8_t)no_loco, vitesse_locos[no_loco-1]);
+    /* Arrêt, inversion du sens (commande 15) puis reprise de la vitesse,
+       envoyés en un seul transfert */
+    maqtrain_command_t commandes[3] = {
+        { (uint8_t)no_loco, 0 },
+        { (uint8_t)no_loco, 15 },
+        { (uint8_t)no_loco, (uint8_t)vitesse_locos[no_loco-1] }
+    };
+    maqtrain_send_commands(commandes, 3);
 }
 
 void mettre_vitesse_loco(int no_loco, int vitesse) {
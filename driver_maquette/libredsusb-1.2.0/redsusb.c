@@ -19,12 +19,15 @@
  * 1.2		RMA		18.04.2016			Extended driver to MaqTrain 2.0
  *-----------------------------------------------------------------------------*/
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdarg.h>
 #include <sys/types.h>
+#include <time.h>
 #include "pthread.h"
 
 #include <libusb.h>
@@ -51,6 +54,15 @@
 
 #define ConfigBuffSize 257
 
+/* MaqTrain requests */
+#define MAQTRAIN_CMD_READ_SENSORS 0x018A
+
+/* Sensor acquisition: event loop wake-up period (in milliseconds) */
+#define SENSORS_EVENT_PERIOD 100
+
+/* Sensor acquisition: default delay between two sensors read requests (in milliseconds) */
+#define SENSORS_POLL_INTERVAL 5
+
 /* Configuration des FPGAs */
 #define InitConfig			0x00
 #define Config				0x01
@@ -64,8 +76,49 @@ int usbdev_product_id = 0;
 
 pthread_mutex_t mutex_usb = PTHREAD_MUTEX_INITIALIZER;
 
+/* Handle kept open for the whole session (NULL if no session is open) */
+libusb_device_handle *session_device = NULL;
+
+/**
+ * @brief MaqTrain packet structure
+ */
+struct maqtrain_packet_t {
+    uint16_t cmd;
+    uint8_t data[6];
+};
+
+/*
+ * Loopback stand-in device: no USB access at all, sensor states are set by
+ * maqtrain_loopback_set_sensor() and commands are only traced.
+ */
+int loopback = 0;
+uint8_t loopback_sensors[MAQTRAIN_NB_SENSORS];
+int loopback_response_pending = 0;
+pthread_mutex_t mutex_loopback = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t condition_loopback = PTHREAD_COND_INITIALIZER;
+int loopback_changed = 0;
+
+/* Asynchronous sensor acquisition */
+pthread_t sensors_thread;
+int sensors_started = 0;
+volatile int sensors_running = 0;
+volatile int sensors_in_flight = 0;
+unsigned int sensors_poll_interval = SENSORS_POLL_INTERVAL;
+int sensors_poll_pending = 0;
+struct timespec sensors_next_poll;
+maqtrain_sensors_callback_t sensors_callback = NULL;
+void *sensors_user_data = NULL;
+struct libusb_transfer *sensors_request = NULL;
+struct libusb_transfer *sensors_response = NULL;
+struct maqtrain_packet_t sensors_request_packet;
+struct maqtrain_packet_t sensors_response_packet;
+
 __attribute__((constructor)) void init(void) {
 	verbose_print("INFO: USB communication library loaded!\n");
+
+	const char *env = getenv("REDSUSB_LOOPBACK");
+	if (env != NULL && env[0] != '\0' && env[0] != '0')
+		usb_set_loopback(1);
 }
 
 /**
@@ -171,6 +224,8 @@ int usb_open(libusb_device_handle **device) {
 				printf("other\n");
 				break;
 			}
+			libusb_close(*device);
+			*device = NULL;
 			goto err;
 		}
 
@@ -183,7 +238,10 @@ int usb_open(libusb_device_handle **device) {
 	}
 
 	err:
-        libusb_exit(NULL); //FIXME: segfault if called twice
+		if (cnt >= 0)
+			libusb_free_device_list(list, 1);
+		libusb_exit(ctx);
+		ctx = NULL;
 		return -1;
 }
 
@@ -198,61 +256,203 @@ int usb_close(libusb_device_handle *device) {
 	return 0;
 }
 
-int usb_write(unsigned char *buffer, size_t bufferSize) {
+/**
+ * @brief Open the session if needed. Must be called with \p mutex_usb held.
+ * @return 0 if the session is open, -1 otherwise
+ */
+static int session_ensure_open(void) {
+	if (loopback || session_device != NULL)
+		return 0;
+
+	return usb_open(&session_device) < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Close the session. Must be called with \p mutex_usb held.
+ */
+static void session_close_locked(void) {
+	if (session_device == NULL)
+		return;
+
+	usb_close(session_device);
+	session_device = NULL;
+}
+
+/**
+ * @brief Drop the session after a fatal transfer error, so that the next
+ * transfer reopens the device. Must be called with \p mutex_usb held.
+ */
+static void session_check_error(int status) {
+	/* in-flight asynchronous transfers still use the handle */
+	if (sensors_running)
+		return;
+
+	if (status == LIBUSB_ERROR_NO_DEVICE || status == LIBUSB_ERROR_IO || status == LIBUSB_ERROR_PIPE)
+		session_close_locked();
+}
+
+/**
+ * @brief Fill a sensors read response from the loopback sensor states.
+ */
+static void loopback_fill_sensors(struct maqtrain_packet_t *resp) {
+	memset(resp, 0, sizeof(*resp));
+	resp->cmd = MAQTRAIN_CMD_READ_SENSORS;
+
+	pthread_mutex_lock(&mutex_loopback);
+	for (size_t i=0; i<MAQTRAIN_NB_SENSORS; i++) {
+		if (loopback_sensors[i])
+			resp->data[i / 8] |= (1 << (i % 8));
+	}
+	pthread_mutex_unlock(&mutex_loopback);
+}
+
+/**
+ * @brief Loopback write: sensors read requests are remembered, commands traced.
+ */
+static int loopback_write(unsigned char *buffer, size_t bufferSize) {
+	for (size_t i=0; i + sizeof(struct maqtrain_packet_t) <= bufferSize; i += sizeof(struct maqtrain_packet_t)) {
+		struct maqtrain_packet_t req;
+		memcpy(&req, buffer + i, sizeof(req));
+		if (req.cmd == MAQTRAIN_CMD_READ_SENSORS)
+			loopback_response_pending = 1;
+		else
+			verbose_print("INFO: loopback command 0x%04x addr=%d data=0x%02x\n", req.cmd, req.data[2], req.data[0]);
+	}
+	return 0;
+}
+
+/**
+ * @brief Loopback read: answers the pending sensors read request.
+ */
+static int loopback_read(UCHAR *buffer, size_t bufferSize) {
+	struct maqtrain_packet_t resp;
+
+	if (!loopback_response_pending || bufferSize < sizeof(resp))
+		return -1;
+
+	loopback_response_pending = 0;
+	loopback_fill_sensors(&resp);
+	memcpy(buffer, &resp, sizeof(resp));
+	return 0;
+}
+
+/**
+ * @brief Bulk write on the session handle. Must be called with \p mutex_usb held.
+ */
+static int usb_write_locked(unsigned char *buffer, size_t bufferSize) {
 
-	libusb_device_handle *device = NULL;
 	int transfered = 0;
 	int status = -1;
 
-	pthread_mutex_lock(&mutex_usb);
-	
 	verbose_print("------------------ WRITE --------------------\n");
 
-	if(usb_open(&device) < 0)
+	if (loopback)
+		return loopback_write(buffer, bufferSize);
+
+	if (session_ensure_open() < 0)
 		return -1;
 
-	if ((status = libusb_bulk_transfer(device, USB_ENDPOINT_WRITE_ADDRESS,
+	if ((status = libusb_bulk_transfer(session_device, USB_ENDPOINT_WRITE_ADDRESS,
 			buffer, bufferSize, &transfered, USB_TIMEOUT)) != 0
-			|| transfered != bufferSize) {
+			|| transfered != (int) bufferSize) {
 		verbose_print("ERROR: unable to write to USB device\n");
+		session_check_error(status);
+		return -1;
 	}
 
-    verbose_print("INFO: %d/%d bytes sent:\n", transfered, (int ) bufferSize);
-    verbose_print_array(buffer, bufferSize);
-
-	usb_close(device);
-	
-	pthread_mutex_unlock(&mutex_usb);
+	verbose_print("INFO: %d/%d bytes sent:\n", transfered, (int ) bufferSize);
+	verbose_print_array(buffer, bufferSize);
 
 	return 0;
 }
 
-int usb_read(UCHAR *buffer, size_t bufferSize) {
+/**
+ * @brief Bulk read on the session handle. Must be called with \p mutex_usb held.
+ */
+static int usb_read_locked(UCHAR *buffer, size_t bufferSize) {
 
-	libusb_device_handle *device = NULL;
 	int transfered = 0;
 	int status = -1;
 
-	pthread_mutex_lock(&mutex_usb);
-
 	verbose_print("------------------ READ --------------------\n");
 
-	if(usb_open(&device) < 0)
+	if (loopback)
+		return loopback_read(buffer, bufferSize);
+
+	if (session_ensure_open() < 0)
 		return -1;
 
-	if ((status = libusb_bulk_transfer(device, USB_ENDPOINT_READ_ADDRESS,
-            buffer, bufferSize, &transfered, USB_TIMEOUT)) != 0) {
+	if ((status = libusb_bulk_transfer(session_device, USB_ENDPOINT_READ_ADDRESS,
+			buffer, bufferSize, &transfered, USB_TIMEOUT)) != 0) {
 		verbose_print("ERROR: unable to read from USB device, error %d\n", status);
+		session_check_error(status);
+		return -1;
 	}
 
-    verbose_print("INFO: %d bytes received:\n", transfered);
-    verbose_print_array(buffer, bufferSize);
+	verbose_print("INFO: %d bytes received:\n", transfered);
+	verbose_print_array(buffer, bufferSize);
 
-	usb_close(device);
-	
+	return 0;
+}
+
+int usb_set_loopback(int enable) {
+	verbose_print("INFO: loopback device %s\n", enable ? "enabled" : "disabled");
+	loopback = enable;
+	return 0;
+}
+
+int usb_session_open(void) {
+	int status;
+
+	pthread_mutex_lock(&mutex_usb);
+	status = session_ensure_open();
 	pthread_mutex_unlock(&mutex_usb);
 
-    return 0;
+	return status;
+}
+
+void usb_session_close(void) {
+	maqtrain_sensors_stop();
+
+	pthread_mutex_lock(&mutex_usb);
+	session_close_locked();
+	pthread_mutex_unlock(&mutex_usb);
+}
+
+int usb_write(unsigned char *buffer, size_t bufferSize) {
+	int status;
+
+	pthread_mutex_lock(&mutex_usb);
+	status = usb_write_locked(buffer, bufferSize);
+	pthread_mutex_unlock(&mutex_usb);
+
+	return status;
+}
+
+int usb_read(UCHAR *buffer, size_t bufferSize) {
+	int status;
+
+	pthread_mutex_lock(&mutex_usb);
+	status = usb_read_locked(buffer, bufferSize);
+	pthread_mutex_unlock(&mutex_usb);
+
+	return status;
+}
+
+/**
+ * @brief Send a request and read its response without releasing the bus,
+ * so that no other thread can steal the response.
+ */
+static int usb_transaction(UCHAR *request, size_t requestSize, UCHAR *response, size_t responseSize) {
+	int status;
+
+	pthread_mutex_lock(&mutex_usb);
+	status = usb_write_locked(request, requestSize);
+	if (status == 0)
+		status = usb_read_locked(response, responseSize);
+	pthread_mutex_unlock(&mutex_usb);
+
+	return status;
 }
 
 void usb_write_value(int address, int value) {
@@ -272,8 +472,7 @@ UCHAR usb_read_value(int address) {
 	buf[3] = address;
 
     // send request and get 1-byte response
-    usb_write(buf, sizeof(buf));
-    usb_read(buf, 1);
+    usb_transaction(buf, sizeof(buf), buf, 1);
 
     return buf[0];
 }
@@ -283,8 +482,7 @@ char usb_read_version(void) {
 	buf[0] = 0xFF;
 
     // send request and get 1-byte response
-    usb_write(buf, sizeof(buf));
-    usb_read(buf, 1);
+    usb_transaction(buf, sizeof(buf), buf, 1);
 
     return buf[0];
 }
@@ -296,8 +494,7 @@ char usb_read_fpga_version(void) {
 	buf[3] = 0x00;
 
     // send request and get 1-byte response
-    usb_write(buf, sizeof(buf));
-    usb_read(buf, 1);
+    usb_transaction(buf, sizeof(buf), buf, 1);
 
     return buf[0];
 }
@@ -309,8 +506,7 @@ char usb_read_fpga_nb_pin(void) {
 	buf[3] = 0x01;
 
     // send request and get 1-byte response
-    usb_write(buf, sizeof(buf));
-    usb_read(buf, 1);
+    usb_transaction(buf, sizeof(buf), buf, 1);
 
     return buf[0];
 }
@@ -320,52 +516,323 @@ char usb_read_fpga_nb_pin(void) {
  */
 
 /**
- * @brief MaqTrain packet structure
+ * @brief Decode the sensors states of a sensors read response.
  */
-struct maqtrain_packet_t {
-    uint16_t cmd;
-    uint8_t data[6];
-};
+static void maqtrain_decode_sensors(const struct maqtrain_packet_t *resp, uint8_t *sensors) {
+    // for each byte MSB to LSB
+    for (size_t i=0; i<sizeof(resp->data); i++) {
+        // for each bit LSB to MSB
+        for (size_t j=0; j<8; j++) {
+            sensors[i*8 + j] = testbit(resp->data[i], j);
+        }
+    }
+}
 
 int maqtrain_read_sensors(uint8_t *sensors) {
 
     // forge and send sensors read request
     struct maqtrain_packet_t req = { 
-        .cmd = 0x018A,
+        .cmd = MAQTRAIN_CMD_READ_SENSORS,
         .data = {0},
     };
-    if (usb_write((UCHAR *) &req, sizeof(req)) < 0)
-        return -1;
-
-    // read the response
+    // send the request and read the response in a single bus transaction
     struct maqtrain_packet_t resp;
-    if (usb_read((UCHAR *) &resp, sizeof(resp)) < 0)
+    if (usb_transaction((UCHAR *) &req, sizeof(req), (UCHAR *) &resp, sizeof(resp)) < 0)
         return -1;
 
     // check that we indeed received the response to our request
     if (req.cmd != resp.cmd)
         return -1;
 
-    // for each byte MSB to LSB
-    for (size_t i=0; i<sizeof(resp.data); i++) {
-        // for each bit LSB to MSB
-        for (size_t j=0; j<8; j++) {
-            sensors[i*8 + j] = testbit(resp.data[i], j);
-        }
-    }
+    maqtrain_decode_sensors(&resp, sensors);
 
     return 0;
 }
 
+/**
+ * @brief Forge the packet of a Marklin console command.
+ */
+static void maqtrain_forge_command(struct maqtrain_packet_t *req, uint8_t addr, uint8_t data) {
+    memset(req, 0, sizeof(*req));
+    req->cmd = addr ? 0x0026 : 0x0016; // no address = general command
+    req->data[0] = data;
+    req->data[2] = addr;
+}
+
 int maqtrain_send_command(uint8_t addr, uint8_t data) {
 
-    struct maqtrain_packet_t req = {
-        .cmd = addr ? 0x0026 : 0x0016, // no address = general command
-        .data = {data, 0x00, addr, 0x00, 0x00, 0x00},
-    };
+    struct maqtrain_packet_t req;
+    maqtrain_forge_command(&req, addr, data);
 
     if (usb_write((UCHAR *) &req, sizeof(req)) < 0)
         return -1;
 
     return 0;
 }
+
+int maqtrain_send_commands(const maqtrain_command_t *commands, size_t count) {
+
+    struct maqtrain_packet_t req[BUF_SIZE / sizeof(struct maqtrain_packet_t)];
+    size_t done = 0;
+
+    // packets are concatenated, at most BUF_SIZE bytes per bulk transfer
+    while (done < count) {
+        size_t n = count - done;
+        if (n > ARRAYSIZE(req))
+            n = ARRAYSIZE(req);
+
+        for (size_t i=0; i<n; i++)
+            maqtrain_forge_command(&req[i], commands[done + i].addr, commands[done + i].data);
+
+        if (usb_write((UCHAR *) req, n * sizeof(req[0])) < 0)
+            return -1;
+
+        done += n;
+    }
+
+    return 0;
+}
+
+int maqtrain_loopback_set_sensor(int sensor, int value) {
+
+    if (!loopback || sensor < 1 || sensor > MAQTRAIN_NB_SENSORS)
+        return -1;
+
+    pthread_mutex_lock(&mutex_loopback);
+    if (loopback_sensors[sensor - 1] != (value != 0)) {
+        loopback_sensors[sensor - 1] = (value != 0);
+        loopback_changed = 1;
+        pthread_cond_broadcast(&condition_loopback);
+    }
+    pthread_mutex_unlock(&mutex_loopback);
+
+    return 0;
+}
+
+/*
+ * Asynchronous sensor acquisition.
+ *
+ * A sensors read request and its response are chained as two asynchronous
+ * bulk transfers: the completion of the request submits the response, whose
+ * completion decodes the sensors, calls the user callback and schedules the
+ * next request, submitted by the event loop once the poll interval has
+ * elapsed. A dedicated thread runs the libusb event loop. The user callback
+ * therefore runs on that thread, as soon as the response arrives.
+ */
+
+static void LIBUSB_CALL sensors_request_done(struct libusb_transfer *transfer);
+static void LIBUSB_CALL sensors_response_done(struct libusb_transfer *transfer);
+
+/**
+ * @brief Submit the next sensors read request, unless the acquisition is stopping.
+ */
+static void sensors_submit_request(void) {
+    if (!sensors_running) {
+        sensors_in_flight = 0;
+        return;
+    }
+
+    if (libusb_submit_transfer(sensors_request) != 0) {
+        printf("ERROR: unable to submit sensors read request\n");
+        sensors_in_flight = 0;
+        sensors_running = 0;
+    }
+}
+
+/**
+ * @brief Schedule the next sensors read request after the poll interval.
+ *
+ * Only called from the event loop thread, as are the fields it sets.
+ */
+static void sensors_schedule_request(void) {
+    if (!sensors_running || sensors_poll_interval == 0) {
+        sensors_submit_request();
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sensors_next_poll);
+    sensors_next_poll.tv_sec += sensors_poll_interval / 1000;
+    sensors_next_poll.tv_nsec += (long) (sensors_poll_interval % 1000) * 1000000L;
+    if (sensors_next_poll.tv_nsec >= 1000000000L) {
+        sensors_next_poll.tv_sec++;
+        sensors_next_poll.tv_nsec -= 1000000000L;
+    }
+    sensors_poll_pending = 1;
+}
+
+static void LIBUSB_CALL sensors_request_done(struct libusb_transfer *transfer) {
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED || !sensors_running) {
+        if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE)
+            sensors_running = 0;
+        sensors_schedule_request();
+        return;
+    }
+
+    if (libusb_submit_transfer(sensors_response) != 0)
+        sensors_schedule_request();
+}
+
+static void LIBUSB_CALL sensors_response_done(struct libusb_transfer *transfer) {
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED
+            && transfer->actual_length == (int) sizeof(sensors_response_packet)
+            && sensors_response_packet.cmd == MAQTRAIN_CMD_READ_SENSORS) {
+        uint8_t sensors[MAQTRAIN_NB_SENSORS];
+        maqtrain_decode_sensors(&sensors_response_packet, sensors);
+        sensors_callback(sensors, sensors_user_data);
+    } else if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
+        printf("ERROR: USB device lost, sensor acquisition stopped\n");
+        sensors_running = 0;
+    }
+
+    sensors_schedule_request();
+}
+
+/**
+ * @brief Event loop of the asynchronous acquisition.
+ */
+static void *sensors_loop(void *arg) {
+    (void) arg;
+
+    sensors_in_flight = 1;
+    sensors_poll_pending = 0;
+    sensors_submit_request();
+
+    while (sensors_running || sensors_in_flight) {
+        struct timeval tv = { 0, SENSORS_EVENT_PERIOD * 1000 };
+
+        if (sensors_poll_pending) {
+            struct timespec now;
+            long remaining_us;
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            remaining_us = (sensors_next_poll.tv_sec - now.tv_sec) * 1000000L
+                    + (sensors_next_poll.tv_nsec - now.tv_nsec) / 1000L;
+
+            /* the next request is due (or the acquisition stops): submit it */
+            if (remaining_us <= 0 || !sensors_running) {
+                sensors_poll_pending = 0;
+                sensors_submit_request();
+                continue;
+            }
+            if (remaining_us < tv.tv_usec)
+                tv.tv_usec = remaining_us;
+        }
+
+        libusb_handle_events_timeout_completed(ctx, &tv, NULL);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Acquisition loop of the loopback device: wakes up on each sensor change.
+ */
+static void *sensors_loop_loopback(void *arg) {
+    (void) arg;
+
+    uint8_t sensors[MAQTRAIN_NB_SENSORS];
+    struct maqtrain_packet_t resp;
+
+    loopback_fill_sensors(&resp);
+    maqtrain_decode_sensors(&resp, sensors);
+    sensors_callback(sensors, sensors_user_data);
+
+    while (sensors_running) {
+        pthread_mutex_lock(&mutex_loopback);
+        while (sensors_running && !loopback_changed)
+            pthread_cond_wait(&condition_loopback, &mutex_loopback);
+        loopback_changed = 0;
+        pthread_mutex_unlock(&mutex_loopback);
+
+        if (!sensors_running)
+            break;
+
+        loopback_fill_sensors(&resp);
+        maqtrain_decode_sensors(&resp, sensors);
+        sensors_callback(sensors, sensors_user_data);
+    }
+
+    return NULL;
+}
+
+void maqtrain_sensors_set_interval(unsigned int interval_ms) {
+    sensors_poll_interval = interval_ms;
+}
+
+int maqtrain_sensors_start(maqtrain_sensors_callback_t callback, void *user_data) {
+
+    if (callback == NULL || sensors_started)
+        return -1;
+
+    sensors_callback = callback;
+    sensors_user_data = user_data;
+
+    if (loopback) {
+        sensors_running = 1;
+        if (pthread_create(&sensors_thread, NULL, &sensors_loop_loopback, NULL) != 0) {
+            sensors_running = 0;
+            return -1;
+        }
+        sensors_started = 1;
+        return 0;
+    }
+
+    if (usb_session_open() < 0)
+        return -1;
+
+    sensors_request = libusb_alloc_transfer(0);
+    sensors_response = libusb_alloc_transfer(0);
+    if (sensors_request == NULL || sensors_response == NULL)
+        goto err;
+
+    memset(&sensors_request_packet, 0, sizeof(sensors_request_packet));
+    sensors_request_packet.cmd = MAQTRAIN_CMD_READ_SENSORS;
+
+    libusb_fill_bulk_transfer(sensors_request, session_device, USB_ENDPOINT_WRITE_ADDRESS,
+            (UCHAR *) &sensors_request_packet, sizeof(sensors_request_packet),
+            sensors_request_done, NULL, USB_TIMEOUT);
+    libusb_fill_bulk_transfer(sensors_response, session_device, USB_ENDPOINT_READ_ADDRESS,
+            (UCHAR *) &sensors_response_packet, sizeof(sensors_response_packet),
+            sensors_response_done, NULL, USB_TIMEOUT);
+
+    sensors_running = 1;
+    if (pthread_create(&sensors_thread, NULL, &sensors_loop, NULL) != 0) {
+        sensors_running = 0;
+        goto err;
+    }
+
+    sensors_started = 1;
+    return 0;
+
+err:
+    libusb_free_transfer(sensors_request);
+    libusb_free_transfer(sensors_response);
+    sensors_request = sensors_response = NULL;
+    return -1;
+}
+
+void maqtrain_sensors_stop(void) {
+
+    if (!sensors_started)
+        return;
+
+    if (loopback) {
+        pthread_mutex_lock(&mutex_loopback);
+        sensors_running = 0;
+        pthread_cond_broadcast(&condition_loopback);
+        pthread_mutex_unlock(&mutex_loopback);
+    } else {
+        sensors_running = 0;
+
+        /* the transfer in flight completes as cancelled, and is not resubmitted */
+        libusb_cancel_transfer(sensors_request);
+        libusb_cancel_transfer(sensors_response);
+    }
+
+    pthread_join(sensors_thread, NULL);
+    sensors_started = 0;
+
+    libusb_free_transfer(sensors_request);
+    libusb_free_transfer(sensors_response);
+    sensors_request = sensors_response = NULL;
+}
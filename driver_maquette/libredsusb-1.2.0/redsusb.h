@@ -36,6 +36,39 @@ extern "C"{
  */
 int usb_set_device(int vendor_id, int product_id);
 
+/**
+ * @brief Replace the USB device by a loopback stand-in device.
+ *
+ * No USB access is made: commands are only traced (with VERBOSE) and sensor
+ * states are those set by maqtrain_loopback_set_sensor(). Must be called
+ * before any transfer. The loopback device is also enabled when the
+ * REDSUSB_LOOPBACK environment variable is set to a non-zero value.
+ *
+ * @param enable 1 to use the loopback device, 0 to use the real one
+ * @return Always 0
+ */
+int usb_set_loopback(int enable);
+
+/**
+ * @brief Open the USB device and keep it open for the whole session.
+ *
+ * Calling this function is optional: the first transfer opens the session
+ * if needed. The device is enumerated and claimed only once, and then
+ * reused by every transfer until usb_session_close() is called. After a
+ * fatal transfer error (device unplugged, I/O error) the session is
+ * dropped and reopened by the next transfer.
+ *
+ * @return 0 if success, -1 if the device could not be opened
+ */
+int usb_session_open(void);
+
+/**
+ * @brief Release the USB device opened by the session.
+ *
+ * @return void
+ */
+void usb_session_close(void);
+
 /**
  * @brief Write a value to the USB device
  *
@@ -76,6 +109,78 @@ int maqtrain_read_sensors(uint8_t *sensors);
  */
 int maqtrain_send_command(uint8_t addr, uint8_t data);
 
+/**
+ * @brief A Marklin console command (see maqtrain_send_command()).
+ */
+typedef struct {
+    uint8_t addr;
+    uint8_t data;
+} maqtrain_command_t;
+
+/**
+ * @brief Send several commands to the Marklin console in a single bulk transfer. (thread-safe)
+ *
+ * @param commands the commands to send, in order
+ * @param count the number of commands
+ * @return 0 if success, -1 if communication error
+ *
+ * Batches larger than BUF_SIZE bytes are split into several transfers.
+ */
+int maqtrain_send_commands(const maqtrain_command_t *commands, size_t count);
+
+/**
+ * @brief Callback receiving the sensors states read by the asynchronous acquisition.
+ *
+ * @param sensors the state of each sensor, array of size `MAQTRAIN_NB_SENSORS`
+ * @param user_data the pointer given to maqtrain_sensors_start()
+ */
+typedef void (*maqtrain_sensors_callback_t)(const uint8_t *sensors, void *user_data);
+
+/**
+ * @brief Start the asynchronous sensor acquisition.
+ *
+ * Sensors read requests are chained as asynchronous bulk transfers, driven
+ * by a dedicated libusb event loop thread: \p callback is called from that
+ * thread with each new sensors read. The next request is sent once the poll
+ * interval set by maqtrain_sensors_set_interval() has elapsed. Only one
+ * acquisition can run at a time. While it runs, maqtrain_read_sensors() and
+ * usb_read_value() must not be used, since they read the same endpoint.
+ *
+ * @param callback the function receiving the sensors states
+ * @param user_data a pointer passed back to \p callback
+ * @return 0 if success, -1 if the acquisition could not be started
+ */
+int maqtrain_sensors_start(maqtrain_sensors_callback_t callback, void *user_data);
+
+/**
+ * @brief Set the delay between two sensors read requests of the asynchronous acquisition.
+ *
+ * The delay runs from the end of a read to the next request, so that the
+ * acquisition does not keep the bus busy. 0 sends the next request as soon
+ * as the previous response arrives. Default: 5 ms. Can be called while the
+ * acquisition runs: the new delay applies from the next request.
+ *
+ * @param interval_ms the delay, in milliseconds
+ * @return void
+ */
+void maqtrain_sensors_set_interval(unsigned int interval_ms);
+
+/**
+ * @brief Stop the asynchronous sensor acquisition and wait for its thread.
+ *
+ * @return void
+ */
+void maqtrain_sensors_stop(void);
+
+/**
+ * @brief Set a sensor state of the loopback device (see usb_set_loopback()).
+ *
+ * @param sensor the sensor number, from 1 to `MAQTRAIN_NB_SENSORS`
+ * @param value the new sensor state (0 or 1)
+ * @return 0 if success, -1 if the loopback device is not in use or the sensor is invalid
+ */
+int maqtrain_loopback_set_sensor(int sensor, int value);
+
 #ifdef __cplusplus
 }
 #endif